@@ -97,6 +97,59 @@ public:
     LevelMeterPtr getLevelMeter (int channel, bool input);
     int getNumChannels (bool input) const noexcept;
 
+    //==========================================================================
+    /** A snapshot of audio callback timing. Load is the time spent rendering a
+        block divided by the block's real-time budget, so 1.0 is fully loaded.
+     */
+    struct Statistics
+    {
+        double load = 0.0;             ///< Load of the most recent callback.
+        double averageLoad = 0.0;      ///< Load averaged over about one second.
+        double peakLoad = 0.0;         ///< Highest load since the last reset.
+        int64 numCallbacks = 0;        ///< Callbacks since the last reset.
+        int numXruns = 0;              ///< Overruns since the last reset.
+        int64 numPageFaults = 0;       ///< Audio thread page faults since the last reset.
+        Array<double> xrunTimes;       ///< Millisecond counter times of recent xruns.
+        Array<int> histogram;          ///< Callback counts in 5% load bins, last bin is >= 200%.
+        double histogramResolution = 0.05;
+    };
+
+    /** Returns the current callback statistics. Safe to call from any thread. */
+    Statistics getStatistics() const;
+
+    /** Clears the callback statistics. */
+    void resetStatistics();
+
+    /** Sets the average load which, when exceeded, writes a warning to the log.
+        New xruns are also logged while the alarm is enabled. Pass 0 to disable.
+     */
+    void setLoadAlarmThreshold (double threshold);
+
+    /** Returns the load alarm threshold, or 0 if disabled. */
+    double getLoadAlarmThreshold() const;
+
+    //==========================================================================
+    /** Sync quality of the incoming MIDI clock. */
+    struct ClockMeasurement {
+        bool measuring = false;       ///< True while a measurement is running.
+        bool locked = false;          ///< True if locked to an incoming clock.
+        int64 numTicks = 0;           ///< Ticks measured.
+        double tempo = 0.0;           ///< Long term tempo of the incoming clock.
+        double referenceTempo = 0.0;  ///< Tempo drift is measured against, 0 if none.
+        double driftPpm = 0.0;        ///< Deviation from the reference tempo in parts per million.
+        double jitterRms = 0.0;       ///< RMS tick jitter in milliseconds.
+        double jitterPeak = 0.0;      ///< Largest tick jitter in milliseconds.
+    };
+
+    /** Start or stop measuring the incoming MIDI clock. Starting clears the
+        previous results. Drift is measured against referenceTempo if it is
+        greater than zero.
+     */
+    void setClockMeasurement (bool shouldMeasure, double referenceTempo = 0.0);
+
+    /** Returns the current MIDI clock measurement. Safe to call from any thread. */
+    ClockMeasurement getClockMeasurement() const;
+
 private:
     class Private;
     std::unique_ptr<Private> priv;
@@ -59,6 +59,11 @@ public:
             midi = juce::MidiMessage::noteOn (1, getEventId(), (uint8) 64);
         } else if (isControllerEvent()) {
             midi = juce::MidiMessage::controllerEvent (1, getEventId(), 64);
+        } else if (isController14Event()) {
+            midi = juce::MidiMessage::controllerEvent (1, getEventId() & 31, 64);
+        } else if (isNrpnEvent()) {
+            // the NRPN parameter select MSB
+            midi = juce::MidiMessage::controllerEvent (1, 99, (getEventId() >> 7) & 127);
         }
 
         return midi;
@@ -66,6 +71,10 @@ public:
 
     bool isNoteEvent() const { return getProperty ("eventType").toString() == "note"; }
     bool isControllerEvent() const { return getProperty ("eventType").toString() == "controller"; }
+    /** 14-bit CC, the event ID is the MSB controller 0-31. */
+    bool isController14Event() const { return getProperty ("eventType").toString() == "controller14"; }
+    /** NRPN, the event ID is the parameter number 0-16383. */
+    bool isNrpnEvent() const { return getProperty ("eventType").toString() == "nrpn"; }
     int getEventId() const { return (int) getProperty ("eventId", 0); }
 
     bool isMomentary() const { return (bool) getProperty ("momentary", false); }
@@ -36,6 +36,7 @@ extern "C" {
 #define EL_NODE_ID_MIDI_MONITOR          "element.midiMonitor"
 #define EL_NODE_ID_MIDI_PROGRAM_MAP      "element.programChangeMap"
 #define EL_NODE_ID_MIDI_ROUTER           "element.midiRouter"
+#define EL_NODE_ID_MODULATION_MATRIX     "element.modulationMatrix"
 #define EL_NODE_ID_MIDI_SEQUENCER        "element.midiSequencer"
 #define EL_NODE_ID_OSC_RECEIVER          "element.oscReceiver"
 #define EL_NODE_ID_OSC_SENDER            "element.oscSender"
@@ -70,6 +71,7 @@ extern "C" {
 #define EL_NODE_UID_ALLPASS_FILTER        1025
 #define EL_NODE_UID_VOLUME                1026
 #define EL_NODE_UID_MCU                   1027
+#define EL_NODE_UID_MODULATION_MATRIX     1028
 
 #ifdef __cplusplus
 }
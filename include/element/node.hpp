@@ -135,6 +135,12 @@ public:
     /** Returns this Node's UUID */
     Uuid getUuid() const { return Uuid (getUuidString()); }
 
+    /** Returns the directory files saved with this node's state go in.
+        It is named after the node's UUID, inside the session's state
+        directory.
+     */
+    File getStateDirectory() const;
+
     //=========================================================================
     /** Returns true if this node is probably a graph */
     bool isGraph() const { return isProbablyGraphNode (objectData); }
@@ -1,6 +1,8 @@
 // Copyright 2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include <atomic>
+
 #include <boost/signals2.hpp>
 
 #include <element/juce/core.hpp>
@@ -263,19 +265,64 @@ public:
     */
     void removeListener (Listener* listener);
 
+    //==============================================================================
+    /** Receives parameter changes on the message thread.
+
+        Changes are coalesced: however often the value changes between two
+        dispatches, the listener is called once with the value current at
+        dispatch time.  Changing a parameter that has only async listeners
+        never locks, so UIs and models should listen this way.
+    */
+    class AsyncListener {
+    public:
+        /** Destructor. */
+        virtual ~AsyncListener() = default;
+
+        /** Called on the message thread after the parameter changed. */
+        virtual void parameterValueChanged (Parameter& parameter, float value) = 0;
+    };
+
+    /** Registers an async listener. Message thread only.
+
+        @see removeAsyncListener
+    */
+    void addAsyncListener (AsyncListener* newListener);
+
+    /** Removes an async listener. Message thread only.
+
+        @see addAsyncListener
+    */
+    void removeAsyncListener (AsyncListener* listener);
+
     //==============================================================================
     /** @internal */
     void sendValueChangedMessageToListeners (float newValue);
     /** @internal */
     void sendGestureChangedMessageToListeners (bool touched);
 
+protected:
+    /** Called before the listeners when the value changes, on the thread
+        that changed it and without locking. Lets a subclass forward changes
+        to what it wraps.
+     */
+    virtual void handleValueChanged (float newValue) { juce::ignoreUnused (newValue); }
+
+    /** Called before the listeners when a gesture starts or ends. */
+    virtual void handleGestureChanged (bool touched) { juce::ignoreUnused (touched); }
+
 private:
     friend class Processor;
+    friend class ParameterChangeBus;
+    void sendAsyncValueChanged();
 
     //==============================================================================
     int parameterIndex = -1;
     juce::CriticalSection listenerLock;
     juce::Array<Listener*> listeners;
+    std::atomic<int> numListeners { 0 };
+    juce::Array<AsyncListener*> asyncListeners;
+    std::atomic<bool> hasAsyncListeners { false };
+    std::atomic<bool> asyncChangePending { false };
     mutable juce::StringArray valueStrings;
 
 #if JUCE_DEBUG
@@ -374,8 +421,7 @@ public:
 
 //==============================================================================
 class ParameterObserver : private PortObserver,
-                          private Parameter::Listener,
-                          private juce::Timer {
+                          private Parameter::AsyncListener {
 public:
     ParameterObserver() = default;
     ParameterObserver (ParameterPtr param)
@@ -386,9 +432,8 @@ public:
 
     ~ParameterObserver() override
     {
-        stopTimer();
         if (parameter != nullptr) {
-            parameter->removeListener (this);
+            parameter->removeAsyncListener (this);
             parameter = nullptr;
         }
     }
@@ -398,14 +443,11 @@ public:
         if (parameter == param)
             return;
         if (parameter) {
-            parameter->removeListener (this);
+            parameter->removeAsyncListener (this);
         }
         parameter = param;
         if (parameter != nullptr) {
-            parameter->addListener (this);
-            startTimer (100);
-        } else {
-            stopTimer();
+            parameter->addAsyncListener (this);
         }
     }
 
@@ -421,27 +463,13 @@ protected:
 
 private:
     //==============================================================================
-    void controlValueChanged (int, float) override
+    void parameterValueChanged (Parameter&, float) override
     {
-        parameterValueHasChanged = 1;
-    }
-
-    void controlTouched (int, bool) override {}
-
-    //==============================================================================
-    void timerCallback() override
-    {
-        if (parameterValueHasChanged.compareAndSetBool (0, 1)) {
-            handleNewParameterValue();
-            sigValueChanged();
-            startTimerHz (50);
-        } else {
-            startTimer (juce::jmin (250, getTimerInterval() + 10));
-        }
+        handleNewParameterValue();
+        sigValueChanged();
     }
 
     ParameterPtr parameter;
-    juce::Atomic<int> parameterValueHasChanged { 0 };
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterObserver)
 };
 
@@ -89,6 +89,12 @@ public:
     virtual void releaseResources() = 0;
 
     virtual bool wantsMidiPipe() const { return false; }
+
+    /** Return true if render() only reads its MIDI buffers. The graph then
+        lets this node read MIDI shared with other nodes instead of giving
+        it a copy.
+     */
+    virtual bool isMidiReadOnly() const { return false; }
     virtual void render (AudioSampleBuffer&, MidiPipe&, AudioSampleBuffer&) {}
     virtual void renderBypassed (AudioSampleBuffer&, MidiPipe&, AudioSampleBuffer&);
 
@@ -188,6 +194,12 @@ public:
     /** Suspend processing */
     void suspendProcessing (const bool);
 
+    /** Bypass from a sample offset in the block about to render. Realtime
+        safe, for the audio thread before the graph renders.  Listeners are
+        told by the next notifyScheduledChanges().
+     */
+    void setSuspendedAt (bool shouldBeSuspended, int frame) noexcept;
+
     /** Get latency audio samples */
     int getLatencySamples() const;
 
@@ -352,6 +364,17 @@ public:
     //=========================================================================
     void setMuted (bool muted);
     bool isMuted() const { return mute.get() == 1; }
+
+    /** Mute from a sample offset in the block about to render. Realtime
+        safe, for the audio thread before the graph renders.  Listeners are
+        told by the next notifyScheduledChanges().
+     */
+    void setMutedAt (bool shouldBeMuted, int frame) noexcept;
+
+    /** Notify listeners of changes made by setSuspendedAt() and setMutedAt().
+        Message thread only.
+     */
+    void notifyScheduledChanges();
     void setMuteInput (bool shouldMuteInput) { muteInput.set (shouldMuteInput ? 1 : 0); }
     bool isMutingInputs() const { return muteInput.get() == 1; }
 
@@ -359,6 +382,15 @@ public:
     virtual void getState (MemoryBlock&) = 0;
     virtual void setState (const void*, int sizeInBytes) = 0;
 
+    /** Set the directory files saved with this instance's state go in.
+        Set by the Node before saving or restoring, processors which don't
+        write files ignore it.
+     */
+    void setStateDirectory (const File& directory) { stateDirectory = directory; }
+
+    /** Returns the directory files saved with the state go in. */
+    const File& getStateDirectory() const noexcept { return stateDirectory; }
+
     //=========================================================================
     void setOversamplingFactor (int osFactor);
     int getOversamplingFactor();
@@ -444,10 +476,16 @@ private:
     Atomic<int> mute { 0 };
     Atomic<int> muteInput { 0 };
 
+    // offsets of changes from setSuspendedAt() and setMutedAt(), read by the
+    // render op, and whether listeners still need to know
+    Atomic<int> bypassFrame { -1 }, muteFrame { -1 };
+    Atomic<int> bypassScheduled { 0 }, muteScheduled { 0 };
+
     double sampleRate = 0.0;
     int blockSize = 0;
     int latencySamples = 0;
     String name;
+    File stateDirectory;
 
     ParameterArray parameters, parametersOut;
 
@@ -67,6 +67,14 @@ public:
     void saveGraphState();
     void restoreGraphState();
 
+    /** Set the directory nodes keep files saved with their state in, one
+        sub-directory per node.  It isn't saved with the session.
+     */
+    void setStateDirectory (const File& directory);
+
+    /** Returns the directory for a session file's node state files. */
+    static File getStateDirectoryFor (const File& sessionFile);
+
     inline int getNumControllers() const { return getControllersValueTree().getNumChildren(); }
 
     inline ValueTree getControllerValueTree (const int i) const
@@ -46,6 +46,9 @@ public:
     static const char* updateChannelKey;
     static const char* updateKeyTypeKey;
     static const char* updateKeyKey;
+    static const char* threadPriorityPrefix;
+    static const char* threadAffinityPrefix;
+    static const char* realtimeMemoryKey;
 
     std::unique_ptr<juce::XmlElement> getLastGraph() const;
     void setLastGraph (const juce::ValueTree& data);
@@ -119,6 +122,26 @@ public:
     juce::String getClockSource() const;
     void setClockSource (const juce::String&);
 
+    /** Returns the realtime priority for a class of engine thread. Zero
+        means normal scheduling.
+
+        @param threadClass  One of audio, worker, disk or network.
+     */
+    int getThreadPriority (const juce::String& threadClass) const;
+    void setThreadPriority (const juce::String& threadClass, int priority);
+
+    /** Returns the CPUs a class of engine thread may run on, e.g. "2-3".
+        An empty string means any CPU.
+     */
+    juce::String getThreadAffinity (const juce::String& threadClass) const;
+    void setThreadAffinity (const juce::String& threadClass, const juce::String& cpus);
+
+    /** Returns true if the engine should lock its memory and prefault render
+        buffers so the audio thread doesn't page fault.
+     */
+    bool isRealtimeMemoryEnabled() const;
+    void setRealtimeMemoryEnabled (bool enabled);
+
     /** Returns the update Key type to use when checking. */
     juce::String getUpdateKeyType() const;
 
@@ -166,11 +166,13 @@ static const juce::Identifier keyStart = "keyStart";
 static const juce::Identifier keyEnd = "keyEnd";
 
 static const juce::Identifier velocityCurveMode = "velocityCurveMode";
+static const juce::Identifier controlSmoothing = "controlSmoothing";
 static const juce::Identifier workspace = "workspace";
 
 static const juce::Identifier externalSync = "externalSync";
 
 static const juce::Identifier updater = "updater";
+static const juce::Identifier stateDirectory = "stateDirectory";
 static const juce::Identifier code = "code";
 static const juce::Identifier source = "source";
 static const juce::Identifier scripts = "scripts";
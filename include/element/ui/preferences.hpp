@@ -9,6 +9,7 @@
 #define EL_AUDIO_SETTINGS_NAME        "Audio"
 #define EL_MIDI_SETTINGS_NAME         "MIDI"
 #define EL_OSC_SETTINGS_NAME          "OSC"
+#define EL_THREADS_SETTINGS_NAME      "Threads"
 #define EL_PLUGINS_PREFERENCE_NAME    "Plugins"
 #define EL_REPOSITORY_PREFERENCE_NAME "Updates"
 
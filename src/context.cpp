@@ -12,6 +12,7 @@
 #include "engine/internalformat.hpp"
 #include "engine/mappingengine.hpp"
 #include "engine/midiengine.hpp"
+#include "engine/parameterchangebus.hpp"
 #include "session/presetmanager.hpp"
 
 #include "appinfo.hpp"
@@ -33,6 +34,7 @@ public:
     Context& owner;
     RunMode mode;
 
+    std::unique_ptr<ParameterChangeBus::Owner> parameterChanges;
     std::unique_ptr<Services> services;
 
     AudioEnginePtr engine;
@@ -53,6 +55,8 @@ private:
 
     void init()
     {
+        // shared with other contexts in the process, e.g. plugin instances
+        parameterChanges = std::make_unique<ParameterChangeBus::Owner>();
         log.reset (new Log());
 
         devices.reset (new DeviceManager());
@@ -86,6 +90,7 @@ private:
         presets = nullptr;
         lua = nullptr;
         log = nullptr;
+        parameterChanges = nullptr;
     }
 };
 
@@ -56,6 +56,18 @@ public:
         e2 += c * e;
     }
 
+    /** Update the DLL with the next timestamp when the coming period is
+        scale times the nominal period, e.g. for variable audio blocks.
+     */
+    inline void update (double time, double scale)
+    {
+        const double e = time - t1;
+
+        t0 = t1;
+        t1 += b * e + e2 * scale;
+        e2 += c * e;
+    }
+
     /** Set the dll's parameters. Bandwidth / Frequency */
     inline void setParams (double newBandwidth, double newFrequency)
     {
@@ -64,6 +76,24 @@ public:
         resetLPF();
     }
 
+    /** Return the filtered time of the current period (t0) */
+    inline double currentTime() const
+    {
+        return t0;
+    }
+
+    /** Return the predicted time of the next period (t1) */
+    inline double nextTime() const
+    {
+        return t1;
+    }
+
+    /** Return the filtered period (e2) */
+    inline double period() const
+    {
+        return e2;
+    }
+
     /**  Return the difference in filtered time (t1 - t0) */
     inline double timeDiff()
     {
@@ -0,0 +1,97 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+/// The audio engine.
+// Access to the running engine's callback statistics.
+// @classmod el.AudioEngine
+// @pragma nostrip
+
+#include <element/element.h>
+#include <element/audioengine.hpp>
+
+#include "sol_helpers.hpp"
+
+// clang-format off
+EL_PLUGIN_EXPORT
+int luaopen_el_AudioEngine (lua_State* L)
+{
+    using namespace element;
+
+    sol::state_view lua (L);
+    auto M = lua.create_table();
+    M.new_usertype<AudioEngine> ("AudioEngine", sol::no_constructor,
+        sol::meta_function::to_string, [](AudioEngine& self) { return lua::to_string (self, "AudioEngine"); },
+
+        /// Returns callback statistics.
+        // The table has the fields `load`, `average`, `peak`, `callbacks`,
+        // `xruns`, `pagefaults` (audio thread), `xruntimes` (array of
+        // millisecond times) and `histogram` (array of callback counts in
+        // 5% load bins).
+        // @function AudioEngine:statistics
+        // @treturn table Statistics table.
+        "statistics", [] (AudioEngine& self, sol::this_state L) {
+            const auto stats = self.getStatistics();
+            sol::state_view view (L);
+            auto tbl = view.create_table();
+            tbl["load"]      = stats.load;
+            tbl["average"]   = stats.averageLoad;
+            tbl["peak"]      = stats.peakLoad;
+            tbl["callbacks"] = stats.numCallbacks;
+            tbl["xruns"]     = stats.numXruns;
+            tbl["pagefaults"] = stats.numPageFaults;
+
+            auto times = view.create_table();
+            for (int i = 0; i < stats.xrunTimes.size(); ++i)
+                times[i + 1] = stats.xrunTimes.getUnchecked (i);
+            tbl["xruntimes"] = times;
+
+            auto hist = view.create_table();
+            for (int i = 0; i < stats.histogram.size(); ++i)
+                hist[i + 1] = stats.histogram.getUnchecked (i);
+            tbl["histogram"] = hist;
+            return tbl;
+        },
+
+        /// Clear callback statistics.
+        // @function AudioEngine:resetStatistics
+        "resetStatistics", &AudioEngine::resetStatistics,
+
+        /// Start or stop measuring the incoming MIDI clock.
+        // @function AudioEngine:measureclock
+        // @bool measure True to start a new measurement, false to stop.
+        // @number[opt] tempo Reference tempo for drift.
+        "measureclock", [] (AudioEngine& self, bool measure, sol::optional<double> tempo) {
+            self.setClockMeasurement (measure, tempo.value_or (0.0));
+        },
+
+        /// Returns the MIDI clock measurement.
+        // The table has the fields `measuring`, `locked`, `ticks`, `tempo`,
+        // `reference`, `drift` (ppm), `jitter` (RMS ms) and `jitterpeak` (ms).
+        // @function AudioEngine:clock
+        // @treturn table Measurement table.
+        "clock", [] (AudioEngine& self, sol::this_state L) {
+            const auto clock = self.getClockMeasurement();
+            sol::state_view view (L);
+            auto tbl = view.create_table();
+            tbl["measuring"]  = clock.measuring;
+            tbl["locked"]     = clock.locked;
+            tbl["ticks"]      = clock.numTicks;
+            tbl["tempo"]      = clock.tempo;
+            tbl["reference"]  = clock.referenceTempo;
+            tbl["drift"]      = clock.driftPpm;
+            tbl["jitter"]     = clock.jitterRms;
+            tbl["jitterpeak"] = clock.jitterPeak;
+            return tbl;
+        },
+
+        /// Average load which triggers a log warning, 0 when disabled.
+        // @tfield number AudioEngine.loadalarm
+        // @within Attributes
+        "loadalarm", sol::property (&AudioEngine::getLoadAlarmThreshold,
+                                    &AudioEngine::setLoadAlarmThreshold)
+    );
+
+    sol::stack::push (L, element::lua::removeAndClear (M, "AudioEngine"));
+    return 1;
+}
+// clang-format on
@@ -3,12 +3,16 @@
 
 #include <element/audioengine.hpp>
 #include "engine/internalformat.hpp"
+#include "engine/mappingengine.hpp"
 #include "engine/midiclock.hpp"
 #include "engine/midichannelmap.hpp"
+#include "engine/enginestats.hpp"
 #include "engine/midiengine.hpp"
 #include "engine/miditranspose.hpp"
 #include <element/transport.hpp>
 #include "engine/rootgraph.hpp"
+#include "engine/rtmemory.hpp"
+#include "engine/threadscheduler.hpp"
 #include <element/context.hpp>
 #include <element/settings.hpp>
 #include "tempo.hpp"
@@ -59,6 +63,16 @@ struct RootGraphRender : public AsyncUpdater
         audioOut.setSize (audioTemp.getNumChannels(), audioTemp.getNumSamples());
     }
 
+    void prefaultBuffers()
+    {
+        RealtimeMemory::prefault (audioTemp);
+        RealtimeMemory::prefault (audioOut);
+        midiOut.ensureSize (MidiEventBuffer::getMidiBufferSize());
+        midiTemp.ensureSize (MidiEventBuffer::getMidiBufferSize());
+        for (auto* graph : graphs)
+            graph->prefaultRenderMemory();
+    }
+
     void releaseBuffers()
     {
         numInputChans = numOutputChans = 0;
@@ -328,9 +342,9 @@ public:
         tempoValue.removeListener (this);
         externalClockValue.removeListener (this);
 
+        // graphs can outlive a stopped device while still prepared
         if (isPrepared)
         {
-            jassertfalse;
             releaseResources();
             isPrepared = false;
         }
@@ -339,6 +353,38 @@ public:
     void timerCallback() override
     {
         midiIOMonitor->notify();
+        if (++alarmTicks >= 90)
+        {
+            alarmTicks = 0;
+            checkAlarms();
+        }
+    }
+
+    void checkAlarms()
+    {
+        const auto threshold = loadAlarmThreshold.get();
+        const auto xruns = stats.getNumXruns();
+        if (threshold <= 0.0)
+        {
+            lastAlarmXruns = xruns;
+            return;
+        }
+
+        if (xruns > lastAlarmXruns)
+        {
+            String msg ("[element] audio engine: ");
+            msg << (xruns - lastAlarmXruns) << " xrun(s), " << xruns << " total";
+            Logger::writeToLog (msg);
+        }
+        lastAlarmXruns = xruns;
+
+        const auto avg = (double) stats.getAverageLoad();
+        if (avg > threshold)
+        {
+            String msg ("[element] audio engine: average load ");
+            msg << String (avg * 100.0, 1) << "% exceeds " << String (threshold * 100.0, 1) << "%";
+            Logger::writeToLog (msg);
+        }
     }
 
     RootGraph* getCurrentGraph() const { return graphs.getCurrentGraph(); }
@@ -376,6 +422,13 @@ public:
                                            const AudioIODeviceCallbackContext& context) override
     {
         jassert (sampleRate > 0 && blockSize > 0);
+        ThreadScheduler::updateCurrentThread (ThreadScheduler::Audio, scheduleGeneration);
+        if (stackNeedsPrefault)
+        {
+            stackNeedsPrefault = false;
+            RealtimeMemory::prefaultStack();
+        }
+        stats.begin();
         int totalNumChans = 0;
         ScopedNoDenormals denormals;
 
@@ -422,6 +475,8 @@ public:
 
         const bool wasPlaying = transport.isPlaying();
         AudioSampleBuffer buffer (channels, totalNumChans, numSamples);
+        engine.world.midi().renderInputQueues (incomingMidi, numSamples);
+        engine.world.mapping().processEvents (engine.world.midi());
         processCurrentGraph (buffer, incomingMidi);
 
         {
@@ -465,6 +520,9 @@ public:
         for (int c = 0; c < numOutputChannels; ++c)
             outMeters.getObjectPointerUnchecked (c)->updateLevel (outputChannelData, c, numSamples);
         incomingMidi.clear();
+        stats.end (numSamples, sampleRate);
+        if ((++pageFaultTicks % pageFaultInterval) == 0)
+            stats.updatePageFaults (RealtimeMemory::getThreadPageFaults());
     }
 
     void processCurrentGraph (AudioBuffer<float>& buffer, MidiBuffer& midi)
@@ -474,7 +532,7 @@ public:
         // element::traceMidi (midi);
 
         const ScopedLock sl (lock);
-        const bool shouldProcess = shouldBeLocked.get() == 0;
+        const bool shouldProcess = shouldBeLocked.get() == 0 && graphsReady.get() == 1;
         const bool wasPlaying = transport.isPlaying();
         transport.preProcess (numSamples);
 
@@ -530,63 +588,122 @@ public:
         const int newBlockSize = device->getCurrentBufferSizeSamples();
         const int numChansIn = device->getActiveInputChannels().countNumberOfSetBits();
         const int numChansOut = device->getActiveOutputChannels().countNumberOfSetBits();
-        audioAboutToStart (newSampleRate, newBlockSize, numChansIn, numChansOut);
+        // JACK calls back with its period size, every time
+        const int newFixedBlockSize = device->getTypeName() == "JACK" ? newBlockSize : 0;
+        audioAboutToStart (newSampleRate, newBlockSize, numChansIn, numChansOut, newFixedBlockSize);
     }
 
-    void audioAboutToStart (const double newSampleRate, const int newBlockSize, const int numChansIn, const int numChansOut)
+    void audioAboutToStart (const double newSampleRate, const int newBlockSize, const int numChansIn, const int numChansOut, const int newFixedBlockSize = 0)
     {
-        const ScopedLock sl (lock);
+        bool needsPrepare = false;
 
-        sampleRate = newSampleRate;
-        blockSize = newBlockSize;
-        numInputChans = numChansIn;
-        numOutputChans = numChansOut;
+        {
+            const ScopedLock sl (lock);
+
+            // graphs stay prepared for the largest block size the device has
+            // used at the current rate, so smaller blocks only need the
+            // engine's own state updated.
+            needsPrepare = ! isPrepared
+                           || newSampleRate != sampleRate
+                           || newBlockSize > preparedBlockSize
+                           || newFixedBlockSize != fixedBlockSize;
+
+            sampleRate = newSampleRate;
+            blockSize = newBlockSize;
+            fixedBlockSize = newFixedBlockSize;
+            numInputChans = numChansIn;
+            numOutputChans = numChansOut;
+
+            midiClock.reset (sampleRate, blockSize);
+            messageCollector.reset (sampleRate);
+            engine.world.midi().prepareInputQueues (sampleRate, blockSize);
+            incomingMidi.ensureSize (MidiEventBuffer::getMidiBufferSize());
+            keyboardState.addListener (&messageCollector);
+            channels.calloc ((size_t) jmax (numChansIn, numChansOut) + 2);
+
+            if (needsPrepare)
+            {
+                // the graphs leave the render path, which outputs silence
+                // until they are prepared and swapped back in below.
+                graphsReady.set (0);
+                preparedBlockSize = blockSize;
+            }
 
-        midiClock.reset (sampleRate, blockSize);
-        messageCollector.reset (sampleRate);
-        keyboardState.addListener (&messageCollector);
-        channels.calloc ((size_t) jmax (numChansIn, numChansOut) + 2);
+            // nodes prepared from now on see the device's own block size
+            for (int i = 0; i < graphs.size(); ++i)
+                graphs.getGraph (i)->setNominalBlockSize (blockSize);
 
-        graphs.prepareBuffers (numInputChans, numOutputChans, blockSize);
+            graphs.prepareBuffers (numInputChans, numOutputChans, preparedBlockSize);
+            tempBuffer.setSize (jmax (1, numInputChans), preparedBlockSize);
 
-        while (inMeters.size() < numInputChans)
-            inMeters.add (new AudioEngine::LevelMeter());
-        while (outMeters.size() < numOutputChans)
-            outMeters.add (new AudioEngine::LevelMeter());
+            while (inMeters.size() < numInputChans)
+                inMeters.add (new AudioEngine::LevelMeter());
+            while (outMeters.size() < numOutputChans)
+                outMeters.add (new AudioEngine::LevelMeter());
 
-        if (isPrepared)
+            // the device may run its callback on a different thread
+            stats.restartPageFaults();
+            stats.restartTiming();
+            pageFaultTicks = 0;
+        }
+
+        if (needsPrepare)
         {
-            isPrepared = false;
-            releaseResources();
+            // prepared outside the engine lock, so a running render
+            // callback never waits on plugins loading or allocating.
+            if (isPrepared)
+            {
+                isPrepared = false;
+                releaseResources();
+            }
+
+            prepareToPlay (sampleRate, preparedBlockSize);
+            isPrepared = true;
         }
 
-        prepareToPlay (sampleRate, blockSize);
-        isPrepared = true;
+        if (realtimeMemory.load())
+        {
+            RealtimeMemory::prefault (tempBuffer);
+            incomingMidi.ensureSize (MidiEventBuffer::getMidiBufferSize());
+            graphs.prefaultBuffers();
+            stackNeedsPrefault = true;
+        }
+
+        graphsReady.set (1);
     }
 
     void audioDeviceStopped() override
     {
-        audioStopped();
+        // keep the graphs prepared, the device is most likely being
+        // restarted with a new buffer size.
+        audioStopped (false);
     }
 
-    void audioStopped()
+    void audioStopped (bool releaseGraphs = true)
     {
         const ScopedLock sl (lock);
         keyboardState.removeListener (&messageCollector);
+        stats.restartTiming();
+        if (! releaseGraphs && isPrepared)
+            return;
+
+        graphsReady.set (0);
         if (isPrepared)
             releaseResources();
         isPrepared = false;
         sampleRate = 0.0;
         blockSize = 0;
+        preparedBlockSize = 0;
         tempBuffer.setSize (1, 1);
         graphs.releaseBuffers();
     }
 
     void handleIncomingMidiMessage (MidiInput*, const MidiMessage& message) override
     {
+        // device messages reach the graph through MidiEngine's input queues,
+        // this only handles monitoring and clock sync.
         if (! message.isActiveSense() && ! message.isMidiClock())
             midiIOMonitor->received();
-        messageCollector.addMessageToQueue (message);
         const bool clockWanted = processMidiClock.get() > 0 && sessionWantsExternalClock.get() > 0;
         if (clockWanted && message.isMidiClock())
         {
@@ -611,7 +728,12 @@ public:
     {
         jassert (graph);
         if (isPrepared)
-            prepareGraph (graph, sampleRate, blockSize);
+        {
+            prepareGraph (graph, sampleRate, preparedBlockSize);
+            // not rendering yet, so safe to touch from this thread
+            if (realtimeMemory.load())
+                graph->prefaultRenderMemory();
+        }
         ScopedLock sl (lock);
         if (graphs.addGraph (graph))
         {
@@ -713,6 +835,14 @@ private:
     double sampleRate = 44100.0;
     int blockSize = 1024;
     bool isPrepared = false;
+
+    // Block size the graphs were prepared with, the largest the device has
+    // used at the current rate.  Smaller blocks don't re-prepare.
+    int preparedBlockSize = 0;
+    // 1 once the graphs are prepared for the current device settings,
+    // the render path outputs silence while it is 0.
+    Atomic<int> graphsReady { 0 };
+    int fixedBlockSize = 0; ///< block size the device always uses, 0 if it varies
     Atomic<int> currentGraph;
 
     int numInputChans, numOutputChans;
@@ -745,9 +875,24 @@ private:
 
     ReferenceCountedArray<AudioEngine::LevelMeter> inMeters, outMeters;
 
+    EngineStats stats;
+    Atomic<double> loadAlarmThreshold { 0.0 };
+    int alarmTicks = 0;
+    int lastAlarmXruns = 0;
+    int scheduleGeneration = -1;
+
+    // Lock and prefault memory used by the audio thread.
+    std::atomic<bool> realtimeMemory { false };
+    bool stackNeedsPrefault = false;
+    // Page faults are read from the audio thread every this many callbacks.
+    static constexpr int pageFaultInterval = 64;
+    int pageFaultTicks = 0;
+
     void prepareGraph (RootGraph* graph, double sampleRate, int estimatedBlockSize)
     {
-        graph->setRenderDetails (sampleRate, blockSize);
+        graph->setRenderDetails (sampleRate, estimatedBlockSize);
+        graph->setFixedBlockSize (fixedBlockSize);
+        graph->setNominalBlockSize (blockSize);
         graph->setPlayHead (&transport);
         graph->prepareToRender (sampleRate, estimatedBlockSize);
     }
@@ -826,6 +971,19 @@ void AudioEngine::applySettings (Settings& settings)
     priv->generateMidiClock.set (settings.generateMidiClock() ? 1 : 0);
     priv->sendMidiClockToInput.set (settings.sendMidiClockToInput() ? 1 : 0);
     priv->midiOutLatency.set (settings.getMidiOutLatency());
+    // a plugin host owns its threads
+    if (getRunMode() == RunMode::Standalone)
+    {
+        ThreadScheduler::applySettings (settings);
+
+        // buffers are prefaulted on the next device start, even if locking failed
+        const bool rtMemory = settings.isRealtimeMemoryEnabled();
+        if (rtMemory)
+            RealtimeMemory::lockAll();
+        else
+            RealtimeMemory::unlockAll();
+        priv->realtimeMemory = rtMemory;
+    }
 }
 
 bool AudioEngine::removeGraph (RootGraph* graph)
@@ -849,8 +1007,7 @@ void AudioEngine::addMidiMessage (const MidiMessage msg, bool handleOnDeviceQueu
         return;
     if (handleOnDeviceQueue)
         priv->handleIncomingMidiMessage (nullptr, msg);
-    else
-        priv->messageCollector.addMessageToQueue (msg);
+    priv->messageCollector.addMessageToQueue (msg);
 }
 
 void AudioEngine::setActiveGraph (const int index)
@@ -925,9 +1082,15 @@ void AudioEngine::processExternalBuffers (AudioBuffer<float>& buffer, MidiBuffer
 {
     if (priv)
     {
+        priv->stats.begin();
         if (getRunMode() == RunMode::Plugin)
             world.midi().processMidiBuffer (midi, buffer.getNumSamples(), priv->sampleRate);
+        // device nodes read their hubs per block, the host's MIDI comes in the buffer
+        world.midi().beginBlock (buffer.getNumSamples());
+        world.mapping().processEvents (world.midi());
         priv->processCurrentGraph (buffer, midi);
+        // hosts may render offline or pause between blocks, so only load counts
+        priv->stats.end (buffer.getNumSamples(), priv->sampleRate, false);
     }
 }
 
@@ -1007,6 +1170,67 @@ int AudioEngine::getNumChannels (bool input) const noexcept
     return input ? priv->numInputChans : priv->numOutputChans;
 }
 
+AudioEngine::Statistics AudioEngine::getStatistics() const
+{
+    Statistics result;
+    if (priv == nullptr)
+        return result;
+
+    const auto& stats = priv->stats;
+    result.load = stats.getLoad();
+    result.averageLoad = stats.getAverageLoad();
+    result.peakLoad = stats.getPeakLoad();
+    result.numCallbacks = stats.getNumCallbacks();
+    result.numXruns = stats.getNumXruns();
+    result.numPageFaults = stats.getNumPageFaults();
+    result.xrunTimes = stats.getXrunTimes();
+    result.histogramResolution = EngineStats::histogramResolution;
+    for (int i = 0; i < EngineStats::numHistogramBins; ++i)
+        result.histogram.add ((int) stats.getHistogramBin (i));
+    return result;
+}
+
+void AudioEngine::resetStatistics()
+{
+    if (priv != nullptr)
+        priv->stats.reset();
+}
+
+void AudioEngine::setLoadAlarmThreshold (double threshold)
+{
+    if (priv != nullptr)
+        priv->loadAlarmThreshold.set (jmax (0.0, threshold));
+}
+
+double AudioEngine::getLoadAlarmThreshold() const
+{
+    return priv != nullptr ? priv->loadAlarmThreshold.get() : 0.0;
+}
+
+void AudioEngine::setClockMeasurement (bool shouldMeasure, double referenceTempo)
+{
+    if (priv != nullptr)
+        priv->midiClock.setMeasuring (shouldMeasure, referenceTempo);
+}
+
+AudioEngine::ClockMeasurement AudioEngine::getClockMeasurement() const
+{
+    ClockMeasurement result;
+    if (priv == nullptr)
+        return result;
+
+    const auto m = priv->midiClock.getMeasurement();
+    result.measuring = m.enabled;
+    result.locked = priv->midiClock.isLocked();
+    result.numTicks = m.numTicks;
+    result.tempo = m.tempo;
+    result.referenceTempo = m.referenceTempo;
+    result.driftPpm = m.driftPpm;
+    result.jitterRms = m.jitterRms;
+    result.jitterPeak = m.jitterPeak;
+    return result;
+}
+
 AudioEngine::LevelMeterPtr AudioEngine::getLevelMeter (int channel, bool input)
 {
     auto& larr = input ? priv->inMeters : priv->outMeters;
@@ -0,0 +1,190 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <atomic>
+#include <array>
+
+#include <element/juce.hpp>
+
+namespace element {
+
+/** Lock-free accumulator of audio callback timing.
+
+    The audio thread calls begin() and end() around each callback.  Any
+    other thread may read the counters at the same time.  Load is the time
+    spent in the callback divided by the real-time budget of the block, so
+    1.0 means the entire budget was used.
+ */
+class EngineStats final
+{
+public:
+    /** Width of a histogram bin in load units (5%). */
+    static constexpr double histogramResolution = 0.05;
+    /** Number of histogram bins. The last bin collects everything >= 200%. */
+    static constexpr int numHistogramBins = 41;
+    /** Number of xrun timestamps remembered. */
+    static constexpr int numXrunTimes = 16;
+
+    EngineStats() { reset(); }
+
+    /** Reset all counters. Not realtime safe with respect to the audio thread
+        and meant to be called while it is not running, or when small
+        inaccuracies in the next few callbacks don't matter.
+     */
+    void reset() noexcept
+    {
+        for (auto& bin : histogram)
+            bin.store (0, std::memory_order_relaxed);
+        for (auto& t : xrunTimes)
+            t.store (0.0, std::memory_order_relaxed);
+        numCallbacks.store (0, std::memory_order_relaxed);
+        numXruns.store (0, std::memory_order_relaxed);
+        load.store (0.f, std::memory_order_relaxed);
+        averageLoad.store (0.f, std::memory_order_relaxed);
+        peakLoad.store (0.f, std::memory_order_relaxed);
+        lastStartTicks = 0;
+        lastNumSamples = 0;
+        pageFaultBase.store (-1, std::memory_order_relaxed);
+        pageFaultsBefore.store (0, std::memory_order_relaxed);
+        pageFaults.store (0, std::memory_order_relaxed);
+    }
+
+    /** Record the audio thread's running total of page faults. The reported
+        count is relative to the first total seen after a reset or restart.
+     */
+    void updatePageFaults (juce::int64 threadTotal) noexcept
+    {
+        if (threadTotal < 0)
+            return;
+        auto base = pageFaultBase.load (std::memory_order_relaxed);
+        if (base < 0 || threadTotal < base)
+        {
+            base = threadTotal;
+            pageFaultBase.store (base, std::memory_order_relaxed);
+        }
+        pageFaults.store (pageFaultsBefore.load (std::memory_order_relaxed) + threadTotal - base,
+                          std::memory_order_relaxed);
+    }
+
+    /** Call when the audio thread may change, e.g. the device restarts.
+        Faults counted so far are kept.
+     */
+    void restartPageFaults() noexcept
+    {
+        pageFaultsBefore.store (pageFaults.load (std::memory_order_relaxed), std::memory_order_relaxed);
+        pageFaultBase.store (-1, std::memory_order_relaxed);
+    }
+
+    /** Forget the previous callback's start time so the next one isn't
+        mistaken for a late callback.  Call while the audio callback isn't
+        running, e.g. when the device starts or stops.
+     */
+    void restartTiming() noexcept
+    {
+        lastStartTicks = 0;
+        lastNumSamples = 0;
+    }
+
+    /** Call at the start of an audio callback. */
+    void begin() noexcept
+    {
+        startTicks = juce::Time::getHighResolutionTicks();
+    }
+
+    /** Call at the end of an audio callback.
+
+        When detectGaps is true a callback starting more than two budgets
+        after the previous one also counts as an xrun.  Pass false when the
+        callbacks aren't driven by a device clock, e.g. inside a plugin host
+        that may process offline or pause between blocks.
+     */
+    void end (int numSamples, double sampleRate, bool detectGaps = true) noexcept
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+
+        const auto endTicks = juce::Time::getHighResolutionTicks();
+        const double budget = (double) numSamples / sampleRate;
+        const double elapsed = juce::Time::highResolutionTicksToSeconds (endTicks - startTicks);
+        const double newLoad = elapsed / budget;
+
+        // a callback that overran its budget, or one that arrived much later
+        // than expected, means the device dropped or repeated a buffer. The
+        // gap is only meaningful between blocks of the same size.
+        bool xrun = newLoad > 1.0;
+        if (! xrun && detectGaps && lastStartTicks > 0 && numSamples == lastNumSamples)
+            xrun = juce::Time::highResolutionTicksToSeconds (startTicks - lastStartTicks) > 2.0 * budget;
+        lastStartTicks = detectGaps ? startTicks : 0;
+        lastNumSamples = numSamples;
+
+        if (xrun)
+        {
+            const auto index = numXruns.fetch_add (1, std::memory_order_relaxed);
+            xrunTimes[(size_t) (index % numXrunTimes)].store (juce::Time::getMillisecondCounterHiRes(),
+                                                              std::memory_order_relaxed);
+        }
+
+        const auto bin = juce::jlimit (0, numHistogramBins - 1, (int) (newLoad / histogramResolution));
+        histogram[(size_t) bin].fetch_add (1, std::memory_order_relaxed);
+
+        // ~1 second time constant regardless of block size
+        const auto coeff = (float) juce::jmin (1.0, budget);
+        const auto avg = averageLoad.load (std::memory_order_relaxed);
+        averageLoad.store (avg + coeff * ((float) newLoad - avg), std::memory_order_relaxed);
+        if ((float) newLoad > peakLoad.load (std::memory_order_relaxed))
+            peakLoad.store ((float) newLoad, std::memory_order_relaxed);
+        load.store ((float) newLoad, std::memory_order_relaxed);
+        numCallbacks.fetch_add (1, std::memory_order_release);
+    }
+
+    /** Returns the load of the most recent callback. */
+    float getLoad() const noexcept { return load.load (std::memory_order_relaxed); }
+    /** Returns the load averaged over roughly one second. */
+    float getAverageLoad() const noexcept { return averageLoad.load (std::memory_order_relaxed); }
+    /** Returns the highest load seen since the last reset. */
+    float getPeakLoad() const noexcept { return peakLoad.load (std::memory_order_relaxed); }
+    /** Returns the number of callbacks since the last reset. */
+    juce::int64 getNumCallbacks() const noexcept { return numCallbacks.load (std::memory_order_acquire); }
+    /** Returns the number of xruns since the last reset. */
+    int getNumXruns() const noexcept { return numXruns.load (std::memory_order_relaxed); }
+
+    /** Returns the audio thread page faults since the last reset. */
+    juce::int64 getNumPageFaults() const noexcept { return pageFaults.load (std::memory_order_relaxed); }
+
+    /** Returns the count in a histogram bin. */
+    juce::uint32 getHistogramBin (int bin) const noexcept
+    {
+        return juce::isPositiveAndBelow (bin, numHistogramBins)
+                   ? histogram[(size_t) bin].load (std::memory_order_relaxed)
+                   : 0;
+    }
+
+    /** Returns the millisecond counter times of the most recent xruns, oldest first. */
+    juce::Array<double> getXrunTimes() const
+    {
+        juce::Array<double> times;
+        const int total = getNumXruns();
+        for (int i = juce::jmax (0, total - numXrunTimes); i < total; ++i)
+            times.add (xrunTimes[(size_t) (i % numXrunTimes)].load (std::memory_order_relaxed));
+        return times;
+    }
+
+private:
+    std::array<std::atomic<juce::uint32>, numHistogramBins> histogram;
+    std::array<std::atomic<double>, numXrunTimes> xrunTimes;
+    std::atomic<juce::int64> numCallbacks { 0 };
+    std::atomic<int> numXruns { 0 };
+    std::atomic<float> load { 0.f }, averageLoad { 0.f }, peakLoad { 0.f };
+    std::atomic<juce::int64> pageFaultBase { -1 }, pageFaultsBefore { 0 }, pageFaults { 0 };
+
+    // audio thread only
+    juce::int64 startTicks = 0;
+    juce::int64 lastStartTicks = 0;
+    int lastNumSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (EngineStats)
+};
+
+} // namespace element
@@ -32,36 +32,55 @@ private:
     int cvIndex = 0;
 };
 
-class BindParameterOp : public GraphOp,
-                        public Parameter::Listener
+/** Evaluates a Control to Control connection once per block.
+
+    Ops run in node order, so a chain of Control connections settles within
+    one block and every connection costs the same whatever the source does.
+    The graph's control smoothing ramps the destination towards the source.
+ */
+class ControlRateOp : public GraphOp
 {
 public:
-    BindParameterOp (ParameterPtr src, ParameterPtr dst)
-        : param1 (src), param2 (dst)
+    ControlRateOp (const GraphNode& g, ParameterPtr src, ParameterPtr dst)
+        : graph (g), source (src), dest (dst)
     {
-        param1->addListener (this);
     }
 
-    ~BindParameterOp()
+    void perform (AudioSampleBuffer&, const OwnedArray<MidiBuffer>&, const int numSamples) override
     {
-        param1->removeListener (this);
-    }
+        const float target = source->getValue();
+        const double ms = graph.getControlSmoothing();
+        if (ms != smoothing)
+        {
+            smoothing = ms;
+            ramp.reset (graph.getSampleRate(), ms * 0.001);
+            ramp.setCurrentAndTargetValue (hasValue ? lastValue : target);
+        }
 
-    void controlValueChanged (int index, float value) override
-    {
-        juce::ignoreUnused (index);
-        param2->setValueNotifyingHost (value);
-    }
+        float value = target;
+        if (smoothing > 0.0)
+        {
+            ramp.setTargetValue (target);
+            value = ramp.skip (numSamples);
+        }
 
-    void controlTouched (int index, bool grabbed) override
-    {
+        if (! hasValue || value != lastValue)
+        {
+            lastValue = value;
+            hasValue = true;
+            dest->setValueNotifyingHost (value);
+        }
     }
 
-    void perform (AudioSampleBuffer&, const OwnedArray<MidiBuffer>&, const int) override {}
-
 private:
-    ParameterPtr param1, param2;
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BindParameterOp)
+    const GraphNode& graph;
+    ParameterPtr source, dest;
+    LinearSmoothedValue<float> ramp;
+    double smoothing = -1.0;
+    // any float is a valid control value, so there is no sentinel for "unset"
+    float lastValue = 0.f;
+    bool hasValue = false;
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ControlRateOp)
 };
 
 class ClearChannelOp : public GraphOp
@@ -123,6 +142,15 @@ private:
     JUCE_DECLARE_NON_COPYABLE (AddChannelOp)
 };
 
+/** Copy MIDI keeping the destination's storage. MidiBuffer's assignment
+    operator reallocates.
+ */
+static void copyMidiBuffer (const MidiBuffer& source, MidiBuffer& dest) noexcept
+{
+    dest.data.clearQuick();
+    dest.data.addArray (source.data);
+}
+
 class ClearMidiBufferOp : public GraphOp
 {
 public:
@@ -153,7 +181,8 @@ public:
 
     void perform (AudioSampleBuffer&, const OwnedArray<MidiBuffer>& sharedMidiBuffers, const int)
     {
-        *sharedMidiBuffers.getUnchecked (dstBufferNum) = *sharedMidiBuffers.getUnchecked (srcBufferNum);
+        copyMidiBuffer (*sharedMidiBuffers.getUnchecked (srcBufferNum),
+                        *sharedMidiBuffers.getUnchecked (dstBufferNum));
     }
 
 private:
@@ -165,20 +194,41 @@ private:
 class AddMidiBufferOp : public GraphOp
 {
 public:
-    AddMidiBufferOp (const int srcBufferNum_, const int dstBufferNum_)
-        : srcBufferNum (srcBufferNum_),
-          dstBufferNum (dstBufferNum_)
+    AddMidiBufferOp (GraphNode& g, const int srcBufferNum_, const int dstBufferNum_)
+        : graph (g),
+          srcBufferNum (srcBufferNum_),
+          dstBufferNum (dstBufferNum_),
+          merged (g.getMidiEventCapacity(), g.getMidiByteCapacity())
     {
     }
 
     void perform (AudioSampleBuffer&, const OwnedArray<MidiBuffer>& sharedMidiBuffers, const int numSamples)
     {
-        sharedMidiBuffers.getUnchecked (dstBufferNum)
-            ->addEvents (*sharedMidiBuffers.getUnchecked (srcBufferNum), 0, numSamples, 0);
+        auto& dest = *sharedMidiBuffers.getUnchecked (dstBufferNum);
+        auto& src = *sharedMidiBuffers.getUnchecked (srcBufferNum);
+        merged.clear();
+        merged.addEvents (dest);
+        merged.addEvents (src, 0, numSamples, 0);
+
+        if (merged.hasOverflowed())
+        {
+            // merge into the MidiBuffer itself, which may allocate, rather
+            // than lose events.  The graph grows its buffers for next time.
+            graph.reportMidiOverflow (merged);
+            dest.addEvents (src, 0, numSamples, 0);
+        }
+        else
+        {
+            merged.copyTo (dest);
+        }
+
+        merged.clear();
     }
 
 private:
+    GraphNode& graph;
     const int srcBufferNum, dstBufferNum;
+    MidiEventBuffer merged;
 
     JUCE_DECLARE_NON_COPYABLE (AddMidiBufferOp)
 };
@@ -222,21 +272,25 @@ private:
 class ProcessBufferOp : public GraphOp
 {
 public:
-    ProcessBufferOp (const ProcessorPtr& node_,
+    ProcessBufferOp (GraphNode& graph_,
+                     const ProcessorPtr& node_,
                      const int totalChans_,
                      const int totalCV_,
                      const int midiBufferToUse_,
-                     const Array<int> chans[PortType::Unknown])
+                     const Array<int> chans[PortType::Unknown],
+                     const Array<int>& sharedMidi)
         : node (node_),
           processor (node_->getAudioPluginInstance()),
           audioChannelsToUse (chans[PortType::Audio]),
           cvChannelsToUse (chans[PortType::CV]),
           midiChannelsToUse (chans[PortType::Midi]),
+          graph (graph_),
           totalChans (std::max (1, totalChans_)),
           totalCV (std::max (1, totalCV_)),
           numAudioIns (node_->getNumPorts (PortType::Audio, true)),
           numAudioOuts (node_->getNumPorts (PortType::Audio, false)),
-          midiBufferToUse (midiBufferToUse_)
+          midiBufferToUse (midiBufferToUse_),
+          tempMidi (graph_.getMidiEventCapacity(), graph_.getMidiByteCapacity())
     {
         channels.calloc ((size_t) totalChans);
         cv.calloc ((size_t) totalCV);
@@ -251,11 +305,33 @@ public:
         else
             midiChannelsToUse.add (midiBufferToUse);
 
+        // slots with a shared source read it directly, or copy it into
+        // their own buffer when the node writes.
+        midiSharedSources = sharedMidi;
+        while (midiSharedSources.size() < midiChannelsToUse.size())
+            midiSharedSources.add (-1);
+        midiSharedChannels = midiChannelsToUse;
+        for (int i = 0; i < midiChannelsToUse.size(); ++i)
+        {
+            if (midiSharedSources.getUnchecked (i) >= 0)
+            {
+                midiSharedChannels.set (i, midiSharedSources.getUnchecked (i));
+                hasSharedMidi = true;
+            }
+        }
+
         lastMute = node->isMuted();
+        lastSuspended = node->isSuspended();
+
+        // holds the rest of the block's MIDI while a bypass change splits it,
+        // and catches rewrites that overflow tempMidi
+        const auto midiBufferSize = MidiEventBuffer::getMidiBufferSize (graph_.getMidiEventCapacity(),
+                                                                         graph_.getMidiByteCapacity());
+        for (int i = 0; i < midiChannelsToUse.size(); ++i)
+            splitMidi.add (new MidiBuffer())->ensureSize (midiBufferSize);
 
         osChanSize = totalChans;
         osChans.reset (new float*[osChanSize]);
-        tempMidi.ensureSize (128);
     }
 
     void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray<MidiBuffer>& sharedMidiBuffers, const int numSamples)
@@ -267,12 +343,46 @@ public:
 
         AudioSampleBuffer buffer (channels, totalChans, numSamples);
         AudioSampleBuffer cvbuffer (cv, totalCV, numSamples);
-        MidiPipe midiPipe (sharedMidiBuffers, midiChannelsToUse);
+
+        // one snapshot of the MIDI filters decides both sharing and filtering
+        {
+            ScopedLock spl (node->getPropertyLock());
+            filters.keyRange = node->getKeyRange();
+            filters.channels = node->getMidiChannels();
+            filters.programs = node->areMidiProgramsEnabled();
+            filters.transposeOffset = node->getTransposeOffset();
+        }
+
+        // bypass and mute changes from the mapping stage start at their frame
+        const bool suspended = node->isSuspended();
+        const int bypassFrame = node->bypassFrame.exchange (-1);
+        const int muteFrame = jlimit (0, numSamples, node->muteFrame.exchange (-1));
+        const int splitFrame = (suspended != lastSuspended && bypassFrame > 0 && bypassFrame < numSamples
+                                && node->getOversamplingFactor() <= 1)
+                                   ? bypassFrame
+                                   : 0;
+
+        bool readSharedMidi = false;
+        if (hasSharedMidi)
+        {
+            readSharedMidi = node->isMidiReadOnly() && ! suspended && splitFrame == 0
+                             && node->getOversamplingFactor() <= 1 && ! filters.isActive();
+            if (! readSharedMidi)
+            {
+                for (int i = 0; i < midiSharedSources.size(); ++i)
+                    if (midiSharedSources.getUnchecked (i) >= 0)
+                        copyMidiBuffer (*sharedMidiBuffers.getUnchecked (midiSharedSources.getUnchecked (i)),
+                                        *sharedMidiBuffers.getUnchecked (midiChannelsToUse.getUnchecked (i)));
+            }
+        }
+
+        MidiPipe midiPipe (sharedMidiBuffers, readSharedMidi ? midiSharedChannels : midiChannelsToUse);
 
         if (! node->isEnabled())
         {
             for (int ch = numAudioIns; ch < numAudioOuts; ++ch)
                 buffer.clear (ch, 0, buffer.getNumSamples());
+            lastSuspended = suspended;
             return;
         }
 
@@ -284,7 +394,8 @@ public:
             if (lastMute != muted)
             {
                 // just became muted
-                buffer.applyGainRamp (0, numSamples, node->getLastInputGain(), 0.0);
+                buffer.applyGain (0, muteFrame, node->getLastInputGain());
+                buffer.applyGainRamp (muteFrame, numSamples - muteFrame, node->getLastInputGain(), 0.0);
             }
             else
             {
@@ -295,7 +406,8 @@ public:
         else if (! muted && muteInput && muted != lastMute)
         {
             // just became unmuted
-            buffer.applyGainRamp (0, numSamples, 0.0, node->getInputGain());
+            buffer.applyGain (0, muteFrame, 0.0);
+            buffer.applyGainRamp (muteFrame, numSamples - muteFrame, 0.0, node->getInputGain());
         }
         else if (node->getInputGain() != node->getLastInputGain())
         {
@@ -310,51 +422,54 @@ public:
             node->setInputRMS (i, buffer.getRMSLevel (i, 0, numSamples));
 
         // Begin MIDI filters
+        if (! readSharedMidi)
         {
             jassert (tempMidi.getNumEvents() == 0);
-            ScopedLock spl (node->getPropertyLock());
-            transpose.setNoteOffset (node->getTransposeOffset());
-            const auto keyRange (node->getKeyRange());
-            const auto midiChans (node->getMidiChannels());
-            const auto useMidiProgram (node->areMidiProgramsEnabled());
+            transpose.setNoteOffset (filters.transposeOffset);
+            const auto& keyRange (filters.keyRange);
+            const auto& midiChans (filters.channels);
+            const auto useMidiProgram (filters.programs);
 
-            if (keyRange.getLength() > 0 || ! midiChans.isOmni() || useMidiProgram)
+            if (filters.filtersEvents())
             {
                 for (int i = 0; i < midiPipe.getNumBuffers(); ++i)
                 {
-                    auto& midi = *midiPipe.getWriteBuffer (i);
-                    for (auto m : midi)
-                    {
+                    rewriteMidi (*midiPipe.getWriteBuffer (i), i, [&] (auto& dest, const MidiMessageMetadata& m) {
                         auto msg = m.getMessage();
                         if (msg.isNoteOnOrOff())
                         {
                             // out of range
                             if (keyRange.getLength() > 0 && (msg.getNoteNumber() < keyRange.getStart() || msg.getNoteNumber() > keyRange.getEnd()))
-                                continue;
+                                return;
                         }
 
                         if (msg.getChannel() > 0 && midiChans.isOff (msg.getChannel()))
-                            continue;
+                            return;
 
                         if (useMidiProgram && msg.isProgramChange())
                         {
                             node->setMidiProgram (msg.getProgramChangeNumber());
                             node->reloadMidiProgram();
-                            continue;
+                            return;
                         }
 
                         transpose.process (msg);
-                        tempMidi.addEvent (msg, m.samplePosition);
-                    }
-
-                    midi.swapWith (tempMidi);
-                    tempMidi.clear();
+                        dest.addEvent (msg, m.samplePosition);
+                    });
                 }
             }
-            else
+            else if (filters.transposeOffset != 0)
             {
                 for (int i = 0; i < midiPipe.getNumBuffers(); ++i)
-                    transpose.process (*midiPipe.getWriteBuffer (i), numSamples);
+                {
+                    rewriteMidi (*midiPipe.getWriteBuffer (i), i, [&] (auto& dest, const MidiMessageMetadata& m) {
+                        if (m.samplePosition >= numSamples)
+                            return;
+                        auto msg = m.getMessage();
+                        transpose.process (msg);
+                        dest.addEvent (msg, m.samplePosition);
+                    });
+                }
             }
         }
 
@@ -364,7 +479,7 @@ public:
         auto pluginProcessBlock = [=] (AudioSampleBuffer& buffer, MidiPipe& midiPipe, AudioSampleBuffer& cvbuffer, bool isSuspended) {
             if (node->wantsMidiPipe())
             {
-                if (! node->isSuspended())
+                if (! isSuspended)
                     node->render (buffer, midiPipe, cvbuffer);
                 else
                     node->renderBypassed (buffer, midiPipe, cvbuffer);
@@ -407,42 +522,30 @@ public:
                                         buffer.getNumChannels(),
                                         static_cast<int> (osBlock.getNumSamples()));
 
-            tempMidi.clear();
             for (int i = 0; i < midiPipe.getNumBuffers(); ++i)
             {
-                auto& mb = *midiPipe.getWriteBuffer (i);
-                for (const MidiMessageMetadata msg : mb)
-                {
-                    tempMidi.addEvent (
-                        msg.data,
-                        msg.numBytes,
-                        msg.samplePosition * osFactor);
-                }
-                mb.swapWith (tempMidi);
-                tempMidi.clear();
+                rewriteMidi (*midiPipe.getWriteBuffer (i), i, [osFactor] (auto& dest, const MidiMessageMetadata& msg) {
+                    dest.addEvent (msg.data, msg.numBytes, msg.samplePosition * osFactor);
+                });
             }
 
-            pluginProcessBlock (osBuffer, midiPipe, cvbuffer, node->isSuspended());
+            pluginProcessBlock (osBuffer, midiPipe, cvbuffer, suspended);
             osProcessor->processSamplesDown (block);
 
-            tempMidi.clear();
             for (int i = 0; i < midiPipe.getNumBuffers(); ++i)
             {
-                auto& mb = *midiPipe.getWriteBuffer (i);
-                for (const MidiMessageMetadata msg : mb)
-                {
-                    tempMidi.addEvent (
-                        msg.data,
-                        msg.numBytes,
-                        msg.samplePosition / osFactor);
-                }
-                mb.swapWith (tempMidi);
-                tempMidi.clear();
+                rewriteMidi (*midiPipe.getWriteBuffer (i), i, [osFactor] (auto& dest, const MidiMessageMetadata& msg) {
+                    dest.addEvent (msg.data, msg.numBytes, msg.samplePosition / osFactor);
+                });
             }
         }
+        else if (splitFrame > 0)
+        {
+            renderSplit (pluginProcessBlock, buffer, midiPipe, cvbuffer, splitFrame, suspended);
+        }
         else
         {
-            pluginProcessBlock (buffer, midiPipe, cvbuffer, node->isSuspended());
+            pluginProcessBlock (buffer, midiPipe, cvbuffer, suspended);
         }
 
         if (muted && ! muteInput)
@@ -450,7 +553,8 @@ public:
             if (lastMute != muted)
             {
                 // just became muted
-                buffer.applyGainRamp (0, numSamples, node->getLastGain(), 0.0);
+                buffer.applyGain (0, muteFrame, node->getLastGain());
+                buffer.applyGainRamp (muteFrame, numSamples - muteFrame, node->getLastGain(), 0.0);
             }
             else
             {
@@ -461,7 +565,8 @@ public:
         else if (! muted && ! muteInput && muted != lastMute)
         {
             // just became unmuted
-            buffer.applyGainRamp (0, numSamples, 0.0, node->getGain());
+            buffer.applyGain (0, muteFrame, 0.0);
+            buffer.applyGainRamp (muteFrame, numSamples - muteFrame, 0.0, node->getGain());
         }
         else if (node->getGain() != node->getLastGain())
         {
@@ -474,6 +579,7 @@ public:
 
         node->updateGain();
         lastMute = muted;
+        lastSuspended = suspended;
 
         for (int i = 0; i < numAudioOuts; ++i)
             node->setOutputRMS (i, buffer.getRMSLevel (i, 0, numSamples));
@@ -483,19 +589,116 @@ public:
     AudioProcessor* const processor;
 
 private:
+    /** Replace a buffer's events with what rewrite adds to its destination.
+        Events go through tempMidi, which never allocates.  If it overflows
+        the pass is repeated into a spare MidiBuffer instead of dropping
+        events, and the graph is told so it can grow the buffers.  The
+        rewrite may run twice per event, so keep its side effects idempotent.
+     */
+    template <typename RewriteFunction>
+    void rewriteMidi (MidiBuffer& midi, int index, RewriteFunction&& rewrite)
+    {
+        tempMidi.clear();
+        for (const auto m : midi)
+            rewrite (tempMidi, m);
+
+        if (! tempMidi.hasOverflowed())
+        {
+            tempMidi.copyTo (midi);
+            tempMidi.clear();
+            return;
+        }
+
+        graph.reportMidiOverflow (tempMidi);
+        tempMidi.clear();
+
+        jassert (isPositiveAndBelow (index, splitMidi.size()));
+        auto& spare = *splitMidi.getUnchecked (index);
+        spare.clear();
+        for (const auto m : midi)
+            rewrite (spare, m);
+        midi.swapWith (spare);
+    }
+
+    /** Render a block whose bypass state changes at frame, the part before
+        it in the previous state.  MIDI is split at the same frame.
+     */
+    template <typename RenderFunction>
+    void renderSplit (RenderFunction& render, AudioSampleBuffer& buffer, MidiPipe& midiPipe,
+                      AudioSampleBuffer& cvbuffer, int frame, bool suspended)
+    {
+        const auto numSamples = buffer.getNumSamples();
+        const auto numBuffers = jmin (midiPipe.getNumBuffers(), splitMidi.size());
+        for (int i = 0; i < numBuffers; ++i)
+        {
+            auto& midi = *midiPipe.getWriteBuffer (i);
+            auto& rest = *splitMidi.getUnchecked (i);
+            rest.clear();
+            rest.addEvents (midi, frame, numSamples - frame, -frame);
+            midi.clear (frame, numSamples - frame);
+        }
+
+        AudioSampleBuffer head (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), 0, frame);
+        AudioSampleBuffer cvHead (cvbuffer.getArrayOfWritePointers(), cvbuffer.getNumChannels(), 0, frame);
+        render (head, midiPipe, cvHead, ! suspended);
+
+        // the first part's output waits in splitMidi while the rest renders
+        for (int i = 0; i < numBuffers; ++i)
+            midiPipe.getWriteBuffer (i)->swapWith (*splitMidi.getUnchecked (i));
+
+        AudioSampleBuffer tail (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), frame, numSamples - frame);
+        AudioSampleBuffer cvTail (cvbuffer.getArrayOfWritePointers(), cvbuffer.getNumChannels(), frame, numSamples - frame);
+        render (tail, midiPipe, cvTail, suspended);
+
+        for (int i = 0; i < numBuffers; ++i)
+        {
+            auto& midi = *midiPipe.getWriteBuffer (i);
+            auto& output = *splitMidi.getUnchecked (i);
+            output.addEvents (midi, 0, -1, frame);
+            midi.swapWith (output);
+        }
+    }
+
     Array<int> audioChannelsToUse;
     Array<int> cvChannelsToUse;
     Array<int> midiChannelsToUse;
+    Array<int> midiSharedSources;
+    Array<int> midiSharedChannels;
+    bool hasSharedMidi = false;
     HeapBlock<float*> channels;
     HeapBlock<float*> cv;
+    GraphNode& graph;
     int totalChans, totalCV, numAudioIns, numAudioOuts;
     int midiBufferToUse;
     bool lastMute = false;
+    bool lastSuspended = false;
+    OwnedArray<MidiBuffer> splitMidi;
     MidiTranspose transpose;
-    MidiBuffer tempMidi;
+    MidiEventBuffer tempMidi;
 
     std::unique_ptr<float*> osChans;
     int osChanSize = 0;
+
+    /** The node's MIDI filter settings, copied once per block. */
+    struct MidiFilters
+    {
+        Range<int> keyRange;
+        MidiChannels channels;
+        bool programs = false;
+        int transposeOffset = 0;
+
+        /** Returns true if events can be dropped or consumed. */
+        bool filtersEvents() const noexcept
+        {
+            return keyRange.getLength() > 0 || ! channels.isOmni() || programs;
+        }
+
+        /** Returns true if the filters would modify the node's input. */
+        bool isActive() const noexcept { return filtersEvents() || transposeOffset != 0; }
+    };
+
+    MidiFilters filters;
+
     JUCE_DECLARE_NON_COPYABLE (ProcessBufferOp)
 };
 
@@ -576,6 +779,7 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
     }
 
     Array<int> channelsToUse[PortType::Unknown];
+    Array<int> sharedMidi;
     int maxLatency = getInputLatency (node->nodeId);
 
     const uint32 numPorts (node->getNumPorts());
@@ -684,9 +888,9 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
             if (portType == PortType::Control)
             {
                 auto src = graph.getNodeForId (srcNode);
-                renderingOps.add (new BindParameterOp (
-                    src->getParameter ((int) srcPort),
-                    node->getParameter ((int) port)));
+                renderingOps.add (new ControlRateOp (graph,
+                                                     src->getParameter ((int) srcPort),
+                                                     node->getParameter ((int) port)));
             }
             else if (srcType == PortType::Control && portType == PortType::CV)
             {
@@ -708,7 +912,19 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
                         renderingOps.add (new CopyChannelOp (bufIndex, newFreeBuffer));
                         break;
                     case PortType::Midi:
-                        renderingOps.add (new CopyMidiBufferOp (bufIndex, newFreeBuffer));
+                        // read-only nodes share the source's MIDI, and ProcessBufferOp
+                        // only copies it when the node ends up writing. A pass-through
+                        // output read by others always needs the copy.
+                        if (node->isMidiReadOnly() && ! isOutputConnected (node, portType, inputChan, numOuts))
+                        {
+                            while (sharedMidi.size() < channelsToUse[PortType::Midi].size())
+                                sharedMidi.add (-1);
+                            sharedMidi.add (bufIndex);
+                        }
+                        else
+                        {
+                            renderingOps.add (new CopyMidiBufferOp (bufIndex, newFreeBuffer));
+                        }
                         break;
                     default:
                         break;
@@ -818,7 +1034,7 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
                         }
                         else if (portType == PortType::Midi)
                         {
-                            renderingOps.add (new AddMidiBufferOp (srcIndex, bufIndex));
+                            renderingOps.add (new AddMidiBufferOp (graph, srcIndex, bufIndex));
                         }
                     }
                 }
@@ -844,7 +1060,23 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
                            node->getNumPorts (PortType::Audio, false));
     int totalCV = jmax (node->getNumPorts (PortType::CV, true),
                         node->getNumPorts (PortType::CV, false));
-    renderingOps.add (new ProcessBufferOp (node, totalChans, totalCV, 0, channelsToUse));
+    renderingOps.add (new ProcessBufferOp (graph, node, totalChans, totalCV, 0, channelsToUse, sharedMidi));
+}
+
+bool GraphBuilder::isOutputConnected (const Processor* node, PortType type, int channel, uint32 numOuts) const
+{
+    if (channel >= (int) numOuts)
+        return false;
+
+    const uint32 outputPort = node->getNthPort (type, channel, false, false);
+    for (int i = graph.getNumConnections(); --i >= 0;)
+    {
+        const auto* const c = graph.getConnection (i);
+        if (c->sourceNode == node->nodeId && c->sourcePort == outputPort)
+            return true;
+    }
+
+    return false;
 }
 
 int GraphBuilder::getFreeBuffer (PortType _type)
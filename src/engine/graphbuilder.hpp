@@ -67,6 +67,7 @@ private:
     int getBufferContaining (const PortType type, const uint32 nodeId, const uint32 outputPort) noexcept;
     void markUnusedBuffersFree (const int stepIndex);
     bool isBufferNeededLater (int stepIndexToSearchFrom, uint32 inputChannelOfIndexToIgnore, const uint32 sourceNode, const uint32 outputPortIndex) const;
+    bool isOutputConnected (const Processor* node, PortType type, int channel, uint32 numOuts) const;
     void markBufferAsContaining (int bufferNum, PortType type, uint32 nodeId, uint32 portIndex);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphBuilder)
@@ -9,9 +9,11 @@
 #include "engine/graphbuilder.hpp"
 #include "engine/ionode.hpp"
 #include "nodes/audioprocessor.hpp"
+#include "engine/midieventbuffer.hpp"
 #include "engine/miditranspose.hpp"
 #include "nodes/nodetypes.hpp"
 #include "engine/graphnode.hpp"
+#include "engine/rtmemory.hpp"
 
 #ifndef EL_GRAPH_NODE_NAME
 #define EL_GRAPH_NODE_NAME "Graph"
@@ -29,6 +31,8 @@ GraphNode::GraphNode()
                      .toPortList()),
       lastNodeId (0),
       renderingBuffers (1, 1),
+      midiEventCapacity (MidiEventBuffer::defaultMaxEvents),
+      midiByteCapacity (MidiEventBuffer::defaultMaxBytes),
       currentAudioInputBuffer (nullptr),
       currentAudioOutputBuffer (1, 1),
       currentMidiInputBuffer (nullptr)
@@ -40,6 +44,7 @@ GraphNode::GraphNode()
 
 GraphNode::~GraphNode()
 {
+    stopTimer();
     renderingSequenceChanged.disconnect_all_slots();
     clearRenderingSequence();
     clear();
@@ -436,7 +441,10 @@ void GraphNode::buildRenderingSequence()
                 midiBuffers.add (new MidiBuffer());
         }
 
+        const auto midiBufferSize = MidiEventBuffer::getMidiBufferSize (midiEventCapacity, midiByteCapacity);
         ScopedLock sl (seqLock);
+        for (auto* buffer : midiBuffers)
+            buffer->ensureSize (midiBufferSize);
         renderingOps.swapWith (newRenderingOps);
     }
 
@@ -467,6 +475,47 @@ void GraphNode::handleAsyncUpdate()
     buildRenderingSequence();
 }
 
+void GraphNode::reportMidiOverflow (const MidiEventBuffer& buffer) noexcept
+{
+    reportMidiOverflow (buffer.getNumOverflows(), buffer.getNumEventsRequired(), buffer.getNumBytesRequired());
+}
+
+void GraphNode::reportMidiOverflow (int numEvents, int eventsRequired, int bytesRequired) noexcept
+{
+    midiOverflows.fetch_add (numEvents);
+
+    auto raise = [] (std::atomic<int>& required, int value) {
+        auto current = required.load();
+        while (current < value && ! required.compare_exchange_weak (current, value))
+            continue;
+    };
+
+    raise (midiEventsRequired, eventsRequired);
+    raise (midiBytesRequired, bytesRequired);
+}
+
+void GraphNode::timerCallback()
+{
+    const auto dropped = midiOverflows.exchange (0);
+    if (dropped <= 0)
+        return;
+
+    const auto events = midiEventsRequired.exchange (0);
+    const auto bytes = midiBytesRequired.exchange (0);
+    if (events > midiEventCapacity)
+        midiEventCapacity = jmax (midiEventCapacity * 2, nextPowerOfTwo (events));
+    if (bytes > midiByteCapacity)
+        midiByteCapacity = jmax (midiByteCapacity * 2, nextPowerOfTwo (bytes));
+
+    String msg ("[element] ");
+    msg << getName() << ": " << dropped << " MIDI event(s) overflowed the render buffers, "
+        << "growing them to " << midiEventCapacity << " events / " << midiByteCapacity << " bytes";
+    Logger::writeToLog (msg);
+
+    if (prepared())
+        buildRenderingSequence();
+}
+
 void GraphNode::prepareToRender (double sampleRate, int estimatedSamplesPerBlock)
 {
     if (prepared())
@@ -476,6 +525,8 @@ void GraphNode::prepareToRender (double sampleRate, int estimatedSamplesPerBlock
     currentAudioOutputBuffer.setSize (jmax (1, getNumAudioOutputs()), estimatedSamplesPerBlock);
     currentMidiInputBuffer = nullptr;
     currentMidiOutputBuffer.clear();
+    currentMidiOutputBuffer.ensureSize (MidiEventBuffer::getMidiBufferSize (midiEventCapacity, midiByteCapacity));
+    filteredMidi.ensureSize (MidiEventBuffer::getMidiBufferSize (midiEventCapacity, midiByteCapacity));
     clearRenderingSequence();
 
     _prepared = true;
@@ -486,6 +537,7 @@ void GraphNode::prepareToRender (double sampleRate, int estimatedSamplesPerBlock
         nodes.getUnchecked (i)->prepare (sampleRate, estimatedSamplesPerBlock, this);
 
     buildRenderingSequence();
+    startTimer (500);
 }
 
 void GraphNode::releaseResources()
@@ -497,6 +549,7 @@ void GraphNode::releaseResources()
         nodes.getUnchecked (i)->unprepare();
 
     _prepared = false;
+    stopTimer();
 
     renderingBuffers.setSize (1, 1);
     midiBuffers.clear();
@@ -507,6 +560,23 @@ void GraphNode::releaseResources()
     currentMidiOutputBuffer.clear();
 }
 
+void GraphNode::prefaultRenderMemory()
+{
+    if (! prepared())
+        return;
+
+    {
+        const ScopedLock sl (getPropertyLock());
+        RealtimeMemory::prefault (renderingBuffers);
+    }
+
+    RealtimeMemory::prefault (currentAudioOutputBuffer);
+
+    for (auto* node : nodes)
+        if (auto* graph = dynamic_cast<GraphNode*> (node))
+            graph->prefaultRenderMemory();
+}
+
 void GraphNode::reset()
 {
     const ScopedLock sl (getPropertyLock());
@@ -522,7 +592,7 @@ void GraphNode::render (AudioSampleBuffer& buffer, MidiPipe& midi, AudioSampleBu
     const int32 numSamples = buffer.getNumSamples();
     auto& midiMessages = *midi.getWriteBuffer (0);
     currentAudioInputBuffer = &buffer;
-    currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples);
+    currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples, false, false, true);
     currentAudioOutputBuffer.clear();
 
     if (midiChannels.isOmni() && velocityCurve.getMode() == VelocityCurve::Linear)
@@ -584,6 +654,31 @@ void GraphNode::getPluginDescription (PluginDescription& d) const
     d.numOutputChannels = getNumAudioOutputs();
 }
 
+int GraphNode::getFixedBlockSize() const noexcept
+{
+    if (fixedBlockSize > 0)
+        return fixedBlockSize;
+    auto* const parentGraph = getParentGraph();
+    return parentGraph != nullptr ? parentGraph->getFixedBlockSize() : 0;
+}
+
+int GraphNode::getNominalBlockSize() const noexcept
+{
+    if (nominalBlockSize > 0)
+        return nominalBlockSize;
+    auto* const parentGraph = getParentGraph();
+    return parentGraph != nullptr ? parentGraph->getNominalBlockSize() : 0;
+}
+
+double GraphNode::getControlSmoothing() const noexcept
+{
+    const auto ms = controlSmoothing.load (std::memory_order_relaxed);
+    if (ms >= 0.0)
+        return ms;
+    auto* const parentGraph = getParentGraph();
+    return parentGraph != nullptr ? parentGraph->getControlSmoothing() : 0.0;
+}
+
 void GraphNode::setPlayHead (AudioPlayHead* newPlayHead)
 {
     playhead = newPlayHead;
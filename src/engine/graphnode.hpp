@@ -11,8 +11,11 @@
 
 namespace element {
 
+class MidiEventBuffer;
+
 class GraphNode : public Processor,
-                  private AsyncUpdater
+                  private AsyncUpdater,
+                  private Timer
 {
 public:
     Signal<void()> renderingSequenceChanged;
@@ -158,6 +161,11 @@ public:
     void prepareToRender (double sampleRate, int estimatedBlockSize) override;
     void releaseResources() override;
 
+    /** Touch the render buffers of this graph and any nested graphs so the
+        audio thread doesn't page fault on first use. Call after preparing.
+     */
+    void prefaultRenderMemory();
+
     bool wantsMidiPipe() const override { return true; }
     void render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampleBuffer&) override;
     void renderBypassed (AudioSampleBuffer&, MidiPipe&, AudioSampleBuffer&) override {}
@@ -180,6 +188,51 @@ public:
     /** Returns true if the graph is prepared. */
     bool prepared() const noexcept { return _prepared; }
 
+    /** Set the number of frames every render gets, 0 if it varies.
+        Set it before preparing, nodes read it from prepareToRender().
+     */
+    void setFixedBlockSize (int size) noexcept { fixedBlockSize = jmax (0, size); }
+
+    /** Returns the block size set on this graph or the nearest parent
+        with one, 0 if blocks vary.
+     */
+    int getFixedBlockSize() const noexcept;
+
+    /** Set the number of frames a render usually gets, e.g. the audio
+        device's buffer size, which may be less than the prepared size.
+     */
+    void setNominalBlockSize (int size) noexcept { nominalBlockSize = jmax (0, size); }
+
+    /** Returns the nominal block size set on this graph or the nearest
+        parent with one, 0 if unknown.
+     */
+    int getNominalBlockSize() const noexcept;
+
+    /** Set how long Control port connections ramp to a new value in
+        milliseconds. 0 steps once per block, a negative time uses the
+        parent graph's.
+     */
+    void setControlSmoothing (double milliseconds) noexcept { controlSmoothing.store (milliseconds); }
+
+    /** Returns the ramp time of Control port connections in milliseconds. */
+    double getControlSmoothing() const noexcept;
+
+    /** Returns the number of events the graph's fixed capacity MIDI buffers hold. */
+    int getMidiEventCapacity() const noexcept { return midiEventCapacity; }
+    /** Returns the number of message bytes the graph's fixed capacity MIDI buffers hold. */
+    int getMidiByteCapacity() const noexcept { return midiByteCapacity; }
+
+    /** Called from the render path when one of the graph's fixed capacity MIDI
+        buffers ran out of room.  The graph logs it on the message thread and
+        rebuilds with larger buffers.
+     */
+    void reportMidiOverflow (const MidiEventBuffer& buffer) noexcept;
+
+    /** Report that numEvents didn't fit a MIDI buffer of the graph's capacity,
+        which needed room for eventsRequired events of bytesRequired bytes.
+     */
+    void reportMidiOverflow (int numEvents, int eventsRequired, int bytesRequired) noexcept;
+
 protected:
     //==========================================================================
     virtual void preRenderNodes() {}
@@ -206,6 +259,14 @@ private:
     OwnedArray<MidiBuffer> midiBuffers;
     Array<void*> renderingOps;
     bool _prepared = false;
+    int fixedBlockSize = 0;
+    int nominalBlockSize = 0;
+    std::atomic<double> controlSmoothing { -1.0 };
+
+    int midiEventCapacity, midiByteCapacity;
+    std::atomic<int> midiOverflows { 0 };
+    std::atomic<int> midiEventsRequired { 0 };
+    std::atomic<int> midiBytesRequired { 0 };
 
     AudioSampleBuffer* currentAudioInputBuffer;
     AudioSampleBuffer currentAudioOutputBuffer;
@@ -224,6 +285,7 @@ private:
     CriticalSection seqLock;
     friend class ScriptNode; // workaround so parameter connections work when params change.
     void handleAsyncUpdate() override;
+    void timerCallback() override;
     void clearRenderingSequence();
     void buildRenderingSequence();
     bool isAnInputTo (uint32 possibleInputId, uint32 possibleDestinationId, int recursionCheck) const;
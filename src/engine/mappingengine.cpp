@@ -1,9 +1,14 @@
 // Copyright 2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include <array>
+#include <atomic>
+
 #include <element/processor.hpp>
 #include "engine/mappingengine.hpp"
 #include "engine/midiengine.hpp"
+#include "engine/mpscqueue.hpp"
+#include "engine/sharedtable.hpp"
 #include <element/controller.hpp>
 #include <element/node.hpp>
 
@@ -12,22 +17,102 @@ namespace element {
 class ControllerMapHandler
 {
 public:
-    ControllerMapHandler() {}
+    /** The kinds of event handlers are dispatched by. */
+    enum Kind
+    {
+        Note = 0,
+        Controller,
+        Controller14, ///< 14-bit CC, MSB controller 0-31 with LSB at +32
+        NRPN
+    };
+
+    ControllerMapHandler (MappingEngine& e, Kind k, int n)
+        : engine (e), kind (k), number (n) {}
     virtual ~ControllerMapHandler() {}
 
+    /** Returns the dispatch key of a kind of event and its number. */
+    static constexpr int makeKey (Kind kind, int number) noexcept { return ((int) kind << 14) | (number & 0x3fff); }
+
+    Kind getKind() const noexcept { return kind; }
+    int getNumber() const noexcept { return number; }
+
+    /** Returns true if this handler accepts events on a 1-16 channel. */
+    virtual bool acceptsChannel (int channel) const = 0;
+
     virtual bool wants (const MidiMessage& message) const = 0;
     virtual void perform (const MidiMessage& message) = 0;
+
+    /** Handle an aggregated 14-bit CC or NRPN value, received at a device
+        timestamp in seconds.
+     */
+    virtual void performValue (int value, int maxValue, double timestamp) { ignoreUnused (value, maxValue, timestamp); }
+
+    /** Apply a change queued by post() from a sample offset in the block
+        about to render. Called on the audio thread, or the MIDI thread
+        while the engine isn't rendering, so this must be realtime safe.
+     */
+    virtual void apply (float value, int frame) = 0;
+
+    /** Finish a change made by apply() on the message thread. */
+    virtual void update (float value) = 0;
+
+protected:
+    /** Queue a change received at a device timestamp for the audio thread. */
+    void post (float value, double timestamp) { engine.postChange (*this, value, timestamp); }
+
+    /** Queue a call to update() on the message thread. */
+    void postUpdate (float value) { engine.postUpdate (*this, value); }
+
+    /** Store a mapped parameter value, or bypass or mute the node from
+        frame, and queue the rest of the change for the message thread.
+        A negative value toggles bypass and mute. Realtime safe.
+     */
+    void applyToNode (Processor& node, Parameter* parameter, int parameterIndex, float value, int frame) noexcept
+    {
+        if (parameter != nullptr)
+            parameter->setValue (value);
+        else if (parameterIndex == Processor::BypassParameter)
+            node.setSuspendedAt (value < 0.f ? ! node.isSuspended() : value >= 0.5f, frame);
+        else if (parameterIndex == Processor::MuteParameter)
+            node.setMutedAt (value < 0.f ? ! node.isMuted() : value >= 0.5f, frame);
+        postUpdate (value);
+    }
+
+    /** Finish a change on the message thread. Notifies the listeners of a
+        parameter or node that apply() changed. Returns true if the node's
+        model needs to be updated.
+     */
+    static bool updateNode (Processor& node, Parameter* parameter)
+    {
+        if (parameter != nullptr)
+        {
+            parameter->beginChangeGesture();
+            parameter->sendValueChangedMessageToListeners (parameter->getValue());
+            parameter->endChangeGesture();
+            return false;
+        }
+
+        node.notifyScheduledChanges();
+        return true;
+    }
+
+private:
+    MappingEngine& engine;
+    const Kind kind;
+    const int number;
 };
 
 struct MidiNoteControllerMap : public ControllerMapHandler,
                                public AsyncUpdater,
                                private Value::Listener
 {
-    MidiNoteControllerMap (const Control& ctl,
+    MidiNoteControllerMap (MappingEngine& engine,
+                           const Control& ctl,
                            const MidiMessage& message,
                            const Node& _node,
                            const int _parameter)
-        : control (ctl),
+        : ControllerMapHandler (engine, Note, message.getNoteNumber()),
+          control (ctl),
           model (_node),
           node (_node.getObject()),
           parameter (nullptr),
@@ -61,9 +146,14 @@ struct MidiNoteControllerMap : public ControllerMapHandler,
         channelObject.removeListener (this);
     }
 
+    bool acceptsChannel (int ch) const override
+    {
+        return channel.get() == 0 || (channel.get() > 0 && ch == channel.get());
+    }
+
     bool checkNoteAndChannel (const MidiMessage& message) const
     {
-        return message.getNoteNumber() == noteNumber && (channel.get() == 0 || (channel.get() > 0 && message.getChannel() == channel.get()));
+        return message.getNoteNumber() == noteNumber && acceptsChannel (message.getChannel());
     }
 
     bool wants (const MidiMessage& message) const override
@@ -87,27 +177,67 @@ struct MidiNoteControllerMap : public ControllerMapHandler,
 
         if (parameter != nullptr)
         {
-            parameter->beginChangeGesture();
             if (momentary.get() == 0)
             {
-                parameter->setValueNotifyingHost (parameter->getValue() < 0.5 ? 1.f : 0.f);
+                post (parameter->getValue() < 0.5 ? 1.f : 0.f, message.getTimeStamp());
             }
             else
             {
                 const bool onOrOff = isInverse ? message.isNoteOff() : message.isNoteOn();
-                parameter->setValueNotifyingHost (onOrOff ? 1.f : 0.f);
+                post (onOrOff ? 1.f : 0.f, message.getTimeStamp());
             }
-
-            parameter->endChangeGesture();
         }
-        else if (parameterIndex == Processor::EnabledParameter || parameterIndex == Processor::BypassParameter || parameterIndex == Processor::MuteParameter)
+        else if (parameterIndex == Processor::EnabledParameter)
         {
+            // enablement prepares the node, so stays on the message thread
             triggerAsyncUpdate();
         }
+        else if (parameterIndex == Processor::BypassParameter)
+        {
+            if (momentary.get() == 0)
+                post (-1.f, message.getTimeStamp());
+            else
+                post ((isInverse ? message.isNoteOn() : message.isNoteOff()) ? 1.f : 0.f, message.getTimeStamp());
+        }
+        else if (parameterIndex == Processor::MuteParameter)
+        {
+            if (momentary.get() == 0)
+                post (-1.f, message.getTimeStamp());
+            else
+                post ((isInverse ? message.isNoteOff() : message.isNoteOn()) ? 1.f : 0.f, message.getTimeStamp());
+        }
+    }
+
+    void apply (float value, int frame) override
+    {
+        applyToNode (*node, parameter.get(), parameterIndex, value, frame);
+    }
+
+    void update (float) override
+    {
+        if (updateNode (*node, parameter.get()))
+            handleAsyncUpdate();
     }
 
     void handleAsyncUpdate() override
     {
+        if (parameterIndex == Processor::BypassParameter)
+        {
+            if (model.isBypassed() != node->isSuspended())
+                model.setProperty (tags::bypass, node->isSuspended());
+            return;
+        }
+
+        if (parameterIndex == Processor::MuteParameter)
+        {
+            if (model.isMuted() != node->isMuted())
+                model.setMuted (node->isMuted());
+            return;
+        }
+
+        if (parameterIndex != Processor::EnabledParameter)
+            return;
+
         MidiMessage event;
 
         {
@@ -117,42 +247,16 @@ struct MidiNoteControllerMap : public ControllerMapHandler,
 
         if (momentary.get() == 0)
         {
-            if (parameterIndex == Processor::EnabledParameter)
-            {
-                node->setEnabled (! node->isEnabled());
-                model.setProperty (tags::enabled, node->isEnabled());
-            }
-            else if (parameterIndex == Processor::BypassParameter)
-            {
-                node->suspendProcessing (! node->isSuspended());
-                model.setProperty (tags::bypass, node->isSuspended());
-            }
-            else if (parameterIndex == Processor::MuteParameter)
-            {
-                model.setMuted (! model.isMuted());
-            }
+            node->setEnabled (! node->isEnabled());
         }
         else
         {
             jassert (event.isNoteOnOrOff());
-            // DBG("async note off: " << (int) event.isNoteOff());
             const bool isInverse = inverse.get() == 1;
-
-            if (parameterIndex == Processor::EnabledParameter)
-            {
-                node->setEnabled (isInverse ? event.isNoteOff() : event.isNoteOn());
-                model.setProperty (tags::enabled, node->isEnabled());
-            }
-            else if (parameterIndex == Processor::BypassParameter)
-            {
-                node->suspendProcessing (isInverse ? event.isNoteOn() : event.isNoteOff());
-                model.setProperty (tags::bypass, node->isSuspended());
-            }
-            else if (parameterIndex == Processor::MuteParameter)
-            {
-                model.setMuted (isInverse ? event.isNoteOff() : event.isNoteOn());
-            }
+            node->setEnabled (isInverse ? event.isNoteOff() : event.isNoteOn());
         }
+
+        model.setProperty (tags::enabled, node->isEnabled());
     }
 
 private:
@@ -197,13 +301,15 @@ struct MidiCCControllerMapHandler : public ControllerMapHandler,
                                     public AsyncUpdater,
                                     private Value::Listener
 {
-    MidiCCControllerMapHandler (const Control& ctl,
-                                const MidiMessage& message,
+    MidiCCControllerMapHandler (MappingEngine& engine,
+                                const Control& ctl,
+                                Kind kind,
+                                int number,
                                 const Node& _node,
                                 const int _parameter)
-        : control (ctl), model (_node), node (_node.getObject()), parameter (nullptr), controllerNumber (message.getControllerNumber()), parameterIndex (_parameter)
+        : ControllerMapHandler (engine, kind, number), control (ctl), model (_node), node (_node.getObject()), parameter (nullptr), controllerNumber (number), parameterIndex (_parameter)
     {
-        jassert (message.isController());
+        jassert (kind == Controller || kind == Controller14 || kind == NRPN);
         jassert (node != nullptr);
 
         toggleValueObject = control.getToggleValueObject();
@@ -241,20 +347,30 @@ struct MidiCCControllerMapHandler : public ControllerMapHandler,
         channelObject.removeListener (this);
     }
 
+    bool acceptsChannel (int ch) const override
+    {
+        return channel.get() == 0 || (channel.get() > 0 && ch == channel.get());
+    }
+
     bool wants (const MidiMessage& message) const override
     {
-        return message.isController() && message.getControllerNumber() == controllerNumber && (channel.get() == 0 || (channel.get() > 0 && message.getChannel() == channel.get()));
+        return getKind() == Controller && message.isController() && message.getControllerNumber() == controllerNumber && acceptsChannel (message.getChannel());
     }
 
     void perform (const MidiMessage& message) override
     {
-        const auto ccValue = message.getControllerValue();
+        performValue (message.getControllerValue(), 127, message.getTimeStamp());
+    }
+
+    void performValue (int value, int maxValue, double timestamp) override
+    {
+        // toggles compare against 7-bit values whatever the resolution
+        const auto ccValue = maxValue == 127 ? value
+                                             : jlimit (0, 127, roundToInt (127.0 * value / (double) maxValue));
 
         if (nullptr != parameter)
         {
-            parameter->beginChangeGesture();
-            parameter->setValueNotifyingHost (static_cast<float> (ccValue) / 127.f);
-            parameter->endChangeGesture();
+            post (static_cast<float> (value) / (float) maxValue, timestamp);
         }
         else if (parameterIndex == Processor::EnabledParameter || parameterIndex == Processor::BypassParameter || parameterIndex == Processor::MuteParameter)
         {
@@ -311,38 +427,58 @@ struct MidiCCControllerMapHandler : public ControllerMapHandler,
             }
 
             if (currentToggleState != desiredToggleState.get())
-                triggerAsyncUpdate();
+            {
+                const bool toggledOn = desiredToggleState.get() == getStateToCompare();
+                if (parameterIndex == Processor::EnabledParameter)
+                    triggerAsyncUpdate(); // enablement prepares the node, so stays on the message thread
+                else if (parameterIndex == Processor::BypassParameter)
+                    post (toggledOn ? 0.f : 1.f, timestamp); // inverted because UI displays bypass as inactive (or active for not bypassed)
+                else
+                    post (toggledOn ? 1.f : 0.f, timestamp);
+            }
         }
 
         lastControllerValue = ccValue;
     }
 
-    void handleAsyncUpdate() override
+    void apply (float value, int frame) override
     {
-        const auto mode = toggleMode.get();
-        const int stateToCompare = mode != Control::toggleEquals
-                                       ? (inverseToggle.get() == 1 ? 0 : 1) // inverse on, then compare false
-                                       : 1; // equals mode always compare true
+        applyToNode (*node, parameter.get(), parameterIndex, value, frame);
+    }
 
+    void update (float) override
+    {
+        if (updateNode (*node, parameter.get()))
+            handleAsyncUpdate();
+    }
+
+    void handleAsyncUpdate() override
+    {
         if (parameterIndex == Processor::EnabledParameter)
         {
-            node->setEnabled (desiredToggleState.get() == stateToCompare);
+            node->setEnabled (desiredToggleState.get() == getStateToCompare());
             if (model.isEnabled() != node->isEnabled())
                 model.setProperty (tags::enabled, node->isEnabled());
         }
         else if (parameterIndex == Processor::BypassParameter)
         {
-            // inverted because UI displays bypass as inactive (or active for not bypassed)
-            node->suspendProcessing (! (desiredToggleState.get() == stateToCompare));
             if (model.isBypassed() != node->isSuspended())
                 model.setProperty (tags::bypass, node->isSuspended());
         }
         else if (parameterIndex == Processor::MuteParameter)
         {
-            model.setMuted (desiredToggleState.get() == stateToCompare);
+            if (model.isMuted() != node->isMuted())
+                model.setMuted (node->isMuted());
         }
     }
 
+    int getStateToCompare() const noexcept
+    {
+        return toggleMode.get() != Control::toggleEquals
+                   ? (inverseToggle.get() == 1 ? 0 : 1) // inverse on, then compare false
+                   : 1; // equals mode always compare true
+    }
+
 private:
     Control control;
     Node model;
@@ -389,34 +525,111 @@ private:
     }
 };
 
+/** Handlers of one controller device, indexed by event so an incoming
+    message only reaches the handlers mapped to it.  Built on the message
+    thread and read by the MIDI input thread.
+ */
+struct ControllerMapDispatch
+{
+    using Kind = ControllerMapHandler::Kind;
+
+    Array<ControllerMapHandler*> handlers; // grouped by event
+    std::array<Range<int>, 128> notes, controllers;
+    std::array<Range<int>, 32> controllers14;
+    HashMap<int, Range<int>> nrpns { 509 };
+    bool hasHighResolution = false;
+
+    // mapped controls, used when capturing
+    HashMap<int, Control> controls, noteControls;
+    BigInteger controllerNumbers, noteNumbers;
+
+    void build (const Controller& device, const OwnedArray<ControllerMapHandler>& source)
+    {
+        for (int i = device.getNumControls(); --i >= 0;)
+        {
+            const auto control (device.getControl (i));
+            const auto midi (control.getMidiMessage());
+            if (control.isNoteEvent())
+            {
+                noteNumbers.setBit (midi.getNoteNumber(), true);
+                noteControls.set (midi.getNoteNumber(), control);
+            }
+            else if (control.isControllerEvent())
+            {
+                controllerNumbers.setBit (midi.getControllerNumber(), true);
+                controls.set (midi.getControllerNumber(), control);
+            }
+        }
+
+        Array<ControllerMapHandler*> sorted;
+        sorted.addArray (source);
+        std::stable_sort (sorted.begin(), sorted.end(), [] (ControllerMapHandler* a, ControllerMapHandler* b) {
+            return ControllerMapHandler::makeKey (a->getKind(), a->getNumber())
+                   < ControllerMapHandler::makeKey (b->getKind(), b->getNumber());
+        });
+
+        for (int i = 0; i < sorted.size();)
+        {
+            auto* const first = sorted.getUnchecked (i);
+            int end = i + 1;
+            while (end < sorted.size() && sorted.getUnchecked (end)->getKind() == first->getKind()
+                   && sorted.getUnchecked (end)->getNumber() == first->getNumber())
+                ++end;
+
+            const Range<int> range (handlers.size(), handlers.size() + (end - i));
+            for (int j = i; j < end; ++j)
+                handlers.add (sorted.getUnchecked (j));
+
+            const auto number = first->getNumber();
+            switch (first->getKind())
+            {
+                case Kind::Note:
+                    if (isPositiveAndBelow (number, 128))
+                        notes[(size_t) number] = range;
+                    break;
+                case Kind::Controller:
+                    if (isPositiveAndBelow (number, 128))
+                        controllers[(size_t) number] = range;
+                    break;
+                case Kind::Controller14:
+                    if (isPositiveAndBelow (number, 32))
+                        controllers14[(size_t) number] = range;
+                    hasHighResolution = true;
+                    break;
+                case Kind::NRPN:
+                    nrpns.set (number, range);
+                    hasHighResolution = true;
+                    break;
+            }
+
+            i = end;
+        }
+    }
+};
+
 class ControllerMapInput : public MidiInputCallback
 {
 public:
     explicit ControllerMapInput (MappingEngine& owner, MidiEngine& m, const Controller& device)
         : midi (m), mapping (owner), controllerDevice (device)
     {
+        resetHighResolutionState();
     }
 
     ~ControllerMapInput()
     {
         close();
+        dispatch.publish (nullptr);
     }
 
-    void handleIncomingMidiMessage (MidiInput*, const MidiMessage& message)
+    void handleIncomingMidiMessage (MidiInput*, const MidiMessage& message) override
     {
-        if ((! message.isController() || ! controllerNumbers[message.getControllerNumber()]) && (! message.isNoteOnOrOff() || ! noteNumbers[message.getNoteNumber()]))
+        if (! message.isController() && ! message.isNoteOnOrOff())
             return;
 
-        // DBG("[element] handle mapped MIDI: " << message.getControllerNumber()
-        //     << " : " << message.getControllerValue());
-        if (message.isNoteOn())
-            mapping.captureNextEvent (*this, notes[message.getNoteNumber()], message);
-        else if (message.isController())
-            mapping.captureNextEvent (*this, controls[message.getControllerNumber()], message);
-
-        for (auto* handler : handlers)
-            if (handler->wants (message))
-                handler->perform (message);
+        const SharedTable<ControllerMapDispatch>::ScopedReader reader (dispatch);
+        if (const auto* table = reader.get())
+            handle (*table, message);
     }
 
     bool close()
@@ -428,22 +641,8 @@ public:
     bool open()
     {
         close();
-
-        for (int i = controllerDevice.getNumControls(); --i >= 0;)
-        {
-            const auto control (controllerDevice.getControl (i));
-            const auto midi (control.getMidiMessage());
-            if (midi.isController())
-            {
-                controllerNumbers.setBit (midi.getControllerNumber(), true);
-                controls.set (midi.getControllerNumber(), control);
-            }
-            else if (midi.isNoteOn())
-            {
-                noteNumbers.setBit (midi.getNoteNumber(), true);
-                notes.set (midi.getNoteNumber(), control);
-            }
-        }
+        rebuild();
+        resetHighResolutionState();
 
         const auto deviceId = controllerDevice.getInputDevice().toString();
         midi.addMidiInputCallback (deviceId, this, true);
@@ -473,19 +672,127 @@ public:
 
     void addHandler (ControllerMapHandler* handler)
     {
-        stop();
         handlers.add (handler);
-        start();
+        rebuild();
     }
 
 private:
     MidiEngine& midi;
     MappingEngine& mapping;
     Controller controllerDevice;
-    std::unique_ptr<MidiInput> midiInput;
     OwnedArray<ControllerMapHandler> handlers;
-    BigInteger controllerNumbers, noteNumbers;
-    HashMap<int, Control> controls, notes;
+
+    SharedTable<ControllerMapDispatch> dispatch;
+
+    // MIDI thread only
+    struct ChannelState
+    {
+        uint8 msb[32];
+        int nrpn;
+        uint8 dataMsb;
+    };
+    ChannelState channels[16];
+
+    void resetHighResolutionState() noexcept
+    {
+        for (auto& state : channels)
+        {
+            zeromem (state.msb, sizeof (state.msb));
+            state.nrpn = -1;
+            state.dataMsb = 0;
+        }
+    }
+
+    void rebuild()
+    {
+        auto table = std::make_unique<ControllerMapDispatch>();
+        table->build (controllerDevice, handlers);
+        dispatch.publish (std::move (table));
+    }
+
+    static void dispatchMessage (const ControllerMapDispatch& table, Range<int> range, const MidiMessage& message)
+    {
+        for (int i = range.getStart(); i < range.getEnd(); ++i)
+        {
+            auto* const handler = table.handlers.getUnchecked (i);
+            if (handler->wants (message))
+                handler->perform (message);
+        }
+    }
+
+    static void dispatchValue (const ControllerMapDispatch& table, Range<int> range, int channel, int value, double timestamp)
+    {
+        for (int i = range.getStart(); i < range.getEnd(); ++i)
+        {
+            auto* const handler = table.handlers.getUnchecked (i);
+            if (handler->acceptsChannel (channel))
+                handler->performValue (value, 16383, timestamp);
+        }
+    }
+
+    void handle (const ControllerMapDispatch& table, const MidiMessage& message)
+    {
+        if (message.isNoteOnOrOff())
+        {
+            const auto note = message.getNoteNumber();
+            if (message.isNoteOn() && table.noteNumbers[note])
+                mapping.captureNextEvent (*this, table.noteControls[note], message);
+            dispatchMessage (table, table.notes[(size_t) note], message);
+            return;
+        }
+
+        const auto cc = message.getControllerNumber();
+        const auto value = message.getControllerValue();
+        if (table.controllerNumbers[cc])
+            mapping.captureNextEvent (*this, table.controls[cc], message);
+        dispatchMessage (table, table.controllers[(size_t) cc], message);
+
+        if (! table.hasHighResolution)
+            return;
+
+        const auto channel = message.getChannel();
+        const auto timestamp = message.getTimeStamp();
+        auto& state = channels[jlimit (1, 16, channel) - 1];
+
+        // 14-bit CC: an MSB resets the LSB, an LSB completes the value
+        if (cc < 32)
+        {
+            state.msb[cc] = (uint8) value;
+            dispatchValue (table, table.controllers14[(size_t) cc], channel, value << 7, timestamp);
+        }
+        else if (cc < 64)
+        {
+            dispatchValue (table, table.controllers14[(size_t) (cc - 32)], channel, (state.msb[cc - 32] << 7) | value, timestamp);
+        }
+
+        // NRPN: 99/98 select the parameter, 6/38 carry data. Selecting an
+        // RPN with 101/100 disables NRPN data until the next selection.
+        switch (cc)
+        {
+            case 99:
+                state.nrpn = (value << 7) | (state.nrpn >= 0 ? (state.nrpn & 0x7f) : 0);
+                break;
+            case 98:
+                state.nrpn = (state.nrpn >= 0 ? (state.nrpn & 0x3f80) : 0) | value;
+                break;
+            case 101:
+            case 100:
+                state.nrpn = -1;
+                break;
+            case 6:
+                state.dataMsb = (uint8) value;
+                if (state.nrpn >= 0 && table.nrpns.contains (state.nrpn))
+                    dispatchValue (table, table.nrpns[state.nrpn], channel, value << 7, timestamp);
+                break;
+            case 38:
+                if (state.nrpn >= 0 && table.nrpns.contains (state.nrpn))
+                    dispatchValue (table, table.nrpns[state.nrpn], channel, (state.dataMsb << 7) | value, timestamp);
+                break;
+            default:
+                break;
+        }
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ControllerMapInput)
 };
 
@@ -570,18 +877,129 @@ private:
     bool running = false;
 };
 
+//==============================================================================
+/** Changes from controller inputs waiting for the audio thread. Any MIDI
+    thread may push, only the audio thread pops.
+
+    Applied changes that listeners or the model need to know about are
+    queued again and finished on the message thread at display rate.
+ */
+class MappingEngine::EventQueue : private Timer
+{
+public:
+    /** Changes are applied directly if the engine hasn't processed the queue
+        for this long, e.g. while the audio device is stopped.
+     */
+    static constexpr uint32 staleMilliseconds = 250;
+
+    EventQueue() : changes (capacity), updates (capacity) { startTimerHz (60); }
+    ~EventQueue() override { stopTimer(); }
+
+    bool push (ControllerMapHandler& handler, float value, double timestamp) noexcept
+    {
+        const auto now = Time::getMillisecondCounter();
+        if (now - lastProcessed.load (std::memory_order_relaxed) > staleMilliseconds)
+            return false;
+        return changes.push ({ &handler, value, timestamp, generation.load() });
+    }
+
+    void process (const MidiEngine& midi) noexcept
+    {
+        processing.store (true);
+        lastProcessed.store (Time::getMillisecondCounter(), std::memory_order_relaxed);
+        const auto current = generation.load();
+
+        // changes queued before handlers were deleted are dropped
+        Change change;
+        while (changes.pop (change))
+            if (change.generation == current)
+                change.handler->apply (change.value, midi.getSampleOffset (change.timestamp));
+
+        processing.store (false);
+    }
+
+    /** Queue a handler's update() for the message thread. Any thread.
+        Returns false if the queue is full.
+     */
+    bool pushUpdate (ControllerMapHandler& handler, float value) noexcept
+    {
+        return updates.push ({ &handler, value, 0.0, generation.load() });
+    }
+
+    /** Call update() for every queued change. Message thread only. */
+    void dispatchUpdates()
+    {
+        const auto current = generation.load();
+        Change change;
+        while (updates.pop (change))
+            if (change.generation == current)
+                change.handler->update (change.value);
+    }
+
+    void invalidate()
+    {
+        generation.fetch_add (1);
+        while (processing.load())
+            Thread::yield();
+    }
+
+private:
+    static constexpr int capacity = 1024;
+
+    struct Change
+    {
+        ControllerMapHandler* handler = nullptr;
+        float value = 0.f;
+        double timestamp = 0.0;
+        int generation = 0;
+    };
+
+    MpscQueue<Change> changes;
+    std::atomic<int> generation { 0 };
+    std::atomic<bool> processing { false };
+    std::atomic<uint32> lastProcessed { 0 };
+    MpscQueue<Change> updates;
+
+    void timerCallback() override { dispatchUpdates(); }
+};
+
+//==============================================================================
 MappingEngine::MappingEngine()
 {
     inputs.reset (new Inputs());
+    events.reset (new EventQueue());
     capturedEvent.capture.set (true);
 }
 
 MappingEngine::~MappingEngine()
 {
+    inputs->stop();
+    invalidateEvents();
     inputs->clear();
     inputs = nullptr;
 }
 
+void MappingEngine::processEvents (const MidiEngine& midi) noexcept
+{
+    events->process (midi);
+}
+
+void MappingEngine::postChange (ControllerMapHandler& handler, float value, double timestamp)
+{
+    if (! events->push (handler, value, timestamp))
+        handler.apply (value, 0);
+}
+
+void MappingEngine::postUpdate (ControllerMapHandler& handler, float value)
+{
+    events->pushUpdate (handler, value);
+}
+
+void MappingEngine::invalidateEvents()
+{
+    events->invalidate();
+}
+
 bool MappingEngine::addInput (const Controller& controller, MidiEngine& midi)
 {
     if (inputs->containsInputFor (controller))
@@ -610,10 +1028,14 @@ bool MappingEngine::addHandler (const Control& control,
             const auto message (control.getMidiMessage());
             std::unique_ptr<ControllerMapHandler> handler;
 
-            if (message.isController())
-                handler.reset (new MidiCCControllerMapHandler (control, message, node, parameter));
+            if (control.isController14Event())
+                handler.reset (new MidiCCControllerMapHandler (*this, control, ControllerMapHandler::Controller14, jlimit (0, 31, control.getEventId()), node, parameter));
+            else if (control.isNrpnEvent())
+                handler.reset (new MidiCCControllerMapHandler (*this, control, ControllerMapHandler::NRPN, jlimit (0, 16383, control.getEventId()), node, parameter));
+            else if (message.isController())
+                handler.reset (new MidiCCControllerMapHandler (*this, control, ControllerMapHandler::Controller, message.getControllerNumber(), node, parameter));
             else if (message.isNoteOn())
-                handler.reset (new MidiNoteControllerMap (control, message, node, parameter));
+                handler.reset (new MidiNoteControllerMap (*this, control, message, node, parameter));
 
             if (nullptr != handler)
             {
@@ -629,6 +1051,9 @@ bool MappingEngine::removeInput (const Controller& controller)
 {
     if (! inputs->containsInputFor (controller))
         return true;
+    if (auto* input = inputs->findInput (controller))
+        input->close();
+    invalidateEvents();
     return inputs->remove (controller);
 }
 
@@ -650,6 +1075,7 @@ bool MappingEngine::refreshInput (const Controller& device)
 void MappingEngine::clear()
 {
     stopMapping();
+    invalidateEvents();
     inputs->clear();
 }
 
@@ -32,6 +32,14 @@ public:
     void startMapping();
     void stopMapping();
 
+    /** Apply the mapped changes controller inputs queued since the last call.
+        The audio engine calls this at the start of every block, after the
+        MIDI engine began the block and before the graph renders.  Bypass and
+        mute take effect at the event's sample offset in the block, placed
+        the same way as MIDI input, regardless of the message thread.
+     */
+    void processEvents (const MidiEngine& midi) noexcept;
+
     void capture (const bool start = true) { capturedEvent.capture.set (start); }
     MidiMessage getCapturedMidiMessage() const { return capturedEvent.message; }
     Control getCapturedControl() const { return capturedEvent.control; }
@@ -39,8 +47,16 @@ public:
 
 private:
     friend class ControllerMapInput;
+    friend class ControllerMapHandler;
     class Inputs;
     std::unique_ptr<Inputs> inputs;
+    class EventQueue;
+    std::unique_ptr<EventQueue> events;
+
+    void postChange (ControllerMapHandler&, float value, double timestamp);
+    void postUpdate (ControllerMapHandler&, float value);
+    /** Discard queued changes. Call before deleting handlers. */
+    void invalidateEvents();
 
     class CapturedEvent : public AsyncUpdater
     {
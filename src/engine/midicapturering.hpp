@@ -0,0 +1,221 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include <element/juce.hpp>
+
+namespace element {
+
+/** A fixed size, lock-free ring of captured MIDI messages for monitoring.
+
+    One thread captures, normally the audio thread, and never waits. When
+    the ring is full the oldest messages are overwritten.  Readers keep their
+    own position and are told how many messages they missed.  Each slot is
+    guarded by a sequence number, so a reader never returns a slot that was
+    overwritten while it was being read.
+
+    Messages are counted per type before filtering, so rates stay accurate
+    while uninteresting types, e.g. clock, are kept out of the ring.
+    Messages longer than maxMessageBytes (sysex) keep their leading bytes
+    and their original size.
+ */
+class MidiCaptureRing final
+{
+public:
+    /** Message types used for counting and filtering. */
+    enum Type
+    {
+        noteType = 0,
+        controllerType,
+        programType,
+        pitchBendType,
+        pressureType,
+        sysexType,
+        clockType,
+        systemType,
+        numTypes
+    };
+
+    /** Bytes stored per message. */
+    static constexpr int maxMessageBytes = 16;
+
+    /** Type mask with every type captured. */
+    static constexpr uint32 allTypes = (1u << numTypes) - 1u;
+
+    /** Type mask with everything except clock captured. */
+    static constexpr uint32 defaultTypes = allTypes & ~(1u << clockType);
+
+    /** A captured message. */
+    struct Message
+    {
+        double time = 0.0;               ///< Millisecond counter time.
+        int size = 0;                    ///< Original size of the message.
+        uint8 data[maxMessageBytes] {}; ///< Leading bytes of the message.
+
+        /** Returns the number of bytes in data. */
+        int getNumStoredBytes() const noexcept { return jmin (size, maxMessageBytes); }
+    };
+
+    /** Create a ring. The capacity is rounded up to a power of two. */
+    explicit MidiCaptureRing (int capacity = 1024)
+    {
+        int size = 1;
+        while (size < jmax (2, capacity))
+            size <<= 1;
+        mask = (uint64) size - 1;
+        slots.reset (new Slot[(size_t) size]);
+        for (auto& count : counts)
+            count.store (0, std::memory_order_relaxed);
+    }
+
+    /** Returns the type of a message. */
+    static Type getType (const uint8* data, int size) noexcept
+    {
+        if (size <= 0)
+            return systemType;
+        switch (data[0] & 0xf0)
+        {
+            case 0x80:
+            case 0x90:
+                return noteType;
+            case 0xa0:
+            case 0xd0:
+                return pressureType;
+            case 0xb0:
+                return controllerType;
+            case 0xc0:
+                return programType;
+            case 0xe0:
+                return pitchBendType;
+            default:
+                break;
+        }
+
+        if (data[0] == 0xf0)
+            return sysexType;
+        if (data[0] == 0xf8)
+            return clockType;
+        return systemType;
+    }
+
+    /** Capture a message. Call only from the capturing thread. */
+    void capture (double time, const uint8* data, int size) noexcept
+    {
+        if (size <= 0)
+            return;
+
+        const auto type = getType (data, size);
+        counts[(size_t) type].fetch_add (1, std::memory_order_relaxed);
+        if ((typeMask.load (std::memory_order_relaxed) & (1u << type)) == 0)
+            return;
+
+        const auto index = writePos.load (std::memory_order_relaxed);
+        auto& slot = slots[(size_t) (index & mask)];
+
+        // odd while writing
+        slot.sequence.store (index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        slot.message.time = time;
+        slot.message.size = size;
+        std::memcpy (slot.message.data, data, (size_t) jmin (size, maxMessageBytes));
+        slot.sequence.store (index * 2 + 2, std::memory_order_release);
+
+        writePos.store (index + 1, std::memory_order_release);
+    }
+
+    /** Read messages captured since position, oldest first, and advance it.
+        Returns the number of messages that were overwritten before they
+        could be read.
+
+        @param position     The reader's position, start with getWritePosition().
+        @param callback     void (const Message&)
+     */
+    template <typename Callback>
+    uint64 read (uint64& position, Callback&& callback) const
+    {
+        const auto end = writePos.load (std::memory_order_acquire);
+        const auto capacity = mask + 1;
+        uint64 missed = 0;
+
+        if (position > end)
+            position = end;
+        if (end - position > capacity)
+        {
+            missed = end - position - capacity;
+            position = end - capacity;
+        }
+
+        for (; position < end; ++position)
+        {
+            const auto& slot = slots[(size_t) (position & mask)];
+            const auto expected = position * 2 + 2;
+
+            if (slot.sequence.load (std::memory_order_acquire) != expected)
+            {
+                ++missed;
+                continue;
+            }
+
+            Message copy = slot.message;
+            std::atomic_thread_fence (std::memory_order_acquire);
+            if (slot.sequence.load (std::memory_order_relaxed) != expected)
+            {
+                ++missed;
+                continue;
+            }
+
+            callback (copy);
+        }
+
+        return missed;
+    }
+
+    /** Returns the position of the next message to be captured. */
+    uint64 getWritePosition() const noexcept { return writePos.load (std::memory_order_acquire); }
+
+    /** Returns the number of messages of a type seen, captured or not. */
+    uint64 getCount (Type type) const noexcept
+    {
+        return isPositiveAndBelow ((int) type, (int) numTypes) ? counts[(size_t) type].load (std::memory_order_relaxed) : 0;
+    }
+
+    /** Returns the number of messages seen of every type. */
+    uint64 getTotalCount() const noexcept
+    {
+        uint64 total = 0;
+        for (const auto& count : counts)
+            total += count.load (std::memory_order_relaxed);
+        return total;
+    }
+
+    /** Set the types to capture, a mask of (1 << Type) bits. */
+    void setTypeMask (uint32 newMask) noexcept { typeMask.store (newMask & allTypes, std::memory_order_relaxed); }
+
+    /** Returns the mask of types captured. */
+    uint32 getTypeMask() const noexcept { return typeMask.load (std::memory_order_relaxed); }
+
+    /** Returns the number of messages the ring holds. */
+    int getCapacity() const noexcept { return (int) (mask + 1); }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64> sequence { 0 };
+        Message message;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    uint64 mask = 0;
+    std::atomic<uint64> writePos { 0 };
+    std::atomic<uint32> typeMask { defaultTypes };
+    std::array<std::atomic<uint64>, numTypes> counts;
+
+    JUCE_DECLARE_NON_COPYABLE (MidiCaptureRing)
+};
+
+} // namespace element
@@ -5,48 +5,169 @@
 
 namespace element {
 
+namespace detail {
+// loop bandwidths relative to the tick rate. wide while acquiring, narrow once locked.
+static constexpr double clockAcquireBandwidth = 1.0 / 12.0;
+static constexpr double clockLockedBandwidth = 1.0 / 128.0;
+
+// a gap longer than this means the clock stopped (20 bpm ticks are 125ms apart)
+static constexpr double clockDropoutSeconds = 0.25;
+} // namespace detail
+
 void MidiClock::process (const MidiMessage& msg)
 {
     jassert (sampleRate > 0.0 && blockSize > 0);
     jassert (msg.isMidiClock() || msg.isSongPositionPointer());
+    if (! msg.isMidiClock())
+        return;
+
+    const double time = msg.getTimeStamp();
+
+    if (midiClockTicks > 0 && (time <= lastTickTime || time - lastTickTime > detail::clockDropoutSeconds))
+    {
+        const bool wasLocked = locked.load (std::memory_order_relaxed);
+        restart (time);
+        if (wasLocked)
+            for (auto* listener : listeners)
+                listener->midiClockSignalDropped();
+        return;
+    }
 
     if (midiClockTicks <= 0)
     {
-        dll.reset (msg.getTimeStamp(), (double) blockSize / sampleRate, 1.0);
-        dll.setParams ((double) blockSize / sampleRate, 1.0);
+        restart (time);
+        return;
+    }
+
+    double error = 0.0;
+    if (midiClockTicks == 1)
+    {
+        // the first interval seeds the loop's period
+        dll.reset (time, time - lastTickTime, 1.0);
+        dll.setParams (detail::clockAcquireBandwidth, 1.0);
     }
     else
     {
-        dll.update (msg.getTimeStamp());
+        error = time - (dll.currentTime() + dll.timeDiff());
+        dll.update (time);
     }
 
-    if (midiClockTicks == syncPeriodTicks)
+    lastTickTime = time;
+    ++midiClockTicks;
+
+    if (measuring.load (std::memory_order_relaxed))
+        measureTick (time, error, locked.load (std::memory_order_relaxed));
+
+    if (midiClockTicks == lockTicks)
+    {
+        // the mean interval over the first beat is a better period estimate
+        // than the wide loop's, start the narrow loop from it
+        dll.reset (time, (time - firstTickTime) / (double) (lockTicks - 1), 1.0);
+        dll.setParams (detail::clockLockedBandwidth, 1.0);
+        locked.store (true, std::memory_order_relaxed);
         for (auto* listener : listeners)
             listener->midiClockSignalAcquired();
+    }
 
-    if (midiClockTicks >= syncPeriodTicks && msg.getTimeStamp() - timeOfLastUpdate >= 1.0)
+    if (midiClockTicks >= lockTicks && midiClockTicks % lockTicks == 0)
     {
-        lastKnownTimeDiff = dll.timeDiff();
-        const double bpm = 60.0 / (lastKnownTimeDiff * 24.0);
-        timeOfLastUpdate = msg.getTimeStamp();
-
-        if (bpm >= 20.0 && bpm <= 999.0)
+        const double bpm = 60.0 / (dll.period() * 24.0);
+        if (bpm >= 20.0 && bpm <= 999.0 && std::abs (bpm - lastKnownTempo) >= 0.01)
+        {
+            lastKnownTempo = bpm;
             for (auto* listener : listeners)
-                listener->midiClockTempoChanged (bpm);
+                listener->midiClockTempoChanged ((float) bpm);
+        }
     }
+}
 
-    ++midiClockTicks;
+void MidiClock::restart (double time)
+{
+    firstTickTime = lastTickTime = time;
+    midiClockTicks = 1;
+    locked.store (false, std::memory_order_relaxed);
 }
 
 void MidiClock::reset (const double sr, const int bs)
 {
     sampleRate = sr;
     blockSize = bs;
-    timeOfLastUpdate = 0.0;
-    lastKnownTimeDiff = 0.0;
+    firstTickTime = lastTickTime = 0.0;
+    lastKnownTempo = 0.0;
     midiClockTicks = 0;
+    locked.store (false, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void MidiClock::setMeasuring (bool shouldMeasure, double referenceTempo)
+{
+    SpinLock::ScopedLockType sl (measureLock);
+    if (shouldMeasure)
+    {
+        measure = {};
+        measure.referenceTempo = jmax (0.0, referenceTempo);
+    }
+    measuring.store (shouldMeasure, std::memory_order_relaxed);
+}
+
+void MidiClock::measureTick (double time, double error, bool errorValid)
+{
+    SpinLock::ScopedLockType sl (measureLock);
+    auto& m = measure;
+
+    if (m.n == 0)
+        m.startTime = time;
+
+    // fit tick times to a line, the slope is the long term clock period
+    const auto x = (double) m.n;
+    const auto y = time - m.startTime;
+    m.sumX += x;
+    m.sumY += y;
+    m.sumXX += x * x;
+    m.sumXY += x * y;
+    ++m.n;
+
+    if (errorValid)
+    {
+        ++m.numErrors;
+        m.sumErrorSquared += error * error;
+        m.peakError = jmax (m.peakError, std::abs (error));
+    }
+}
+
+MidiClock::Measurement MidiClock::getMeasurement() const
+{
+    SpinLock::ScopedLockType sl (measureLock);
+    const auto& m = measure;
+
+    Measurement result;
+    result.enabled = measuring.load (std::memory_order_relaxed);
+    result.numTicks = m.n;
+    result.referenceTempo = m.referenceTempo;
+
+    if (m.n >= 2)
+    {
+        const auto n = (double) m.n;
+        const auto denom = n * m.sumXX - m.sumX * m.sumX;
+        const auto period = denom > 0.0 ? (n * m.sumXY - m.sumX * m.sumY) / denom : 0.0;
+        if (period > 0.0)
+        {
+            result.tempo = 60.0 / (period * 24.0);
+            if (m.referenceTempo > 0.0)
+                result.driftPpm = (result.tempo / m.referenceTempo - 1.0) * 1.0e6;
+        }
+    }
+
+    if (m.numErrors > 0)
+    {
+        result.jitterRms = std::sqrt (m.sumErrorSquared / (double) m.numErrors) * 1000.0;
+        result.jitterPeak = m.peakError * 1000.0;
+    }
+
+    return result;
 }
 
+//==============================================================================
 void MidiClock::addListener (Listener* listener)
 {
     if (listener)
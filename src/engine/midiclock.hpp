@@ -3,11 +3,24 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "ElementApp.h"
 #include "delaylockedloop.hpp"
 
 namespace element {
 
+/** Follows incoming MIDI clock.
+
+    Tick timestamps (in seconds, as delivered by the device) drive a delay
+    locked loop running at the clock rate.  The loop runs wide for the first
+    beat, then restarts narrow from the beat's mean tick interval to reject
+    jitter.  Tempo is reported once per beat after lock.
+
+    When measuring, the loop's phase error gives the jitter of the incoming
+    clock, and a least squares fit of all ticks gives its long term tempo and
+    drift against a reference tempo.
+ */
 class MidiClock
 {
 public:
@@ -22,28 +35,79 @@ public:
         virtual void midiClockTempoChanged (const float bpm) = 0;
     };
 
+    /** Results of a jitter and drift measurement. */
+    struct Measurement
+    {
+        bool enabled = false;        ///< True while measuring.
+        int64 numTicks = 0;          ///< Ticks measured since the measurement started.
+        double tempo = 0.0;          ///< Long term tempo of the incoming clock.
+        double referenceTempo = 0.0; ///< Tempo drift is measured against, 0 if none.
+        double driftPpm = 0.0;       ///< Deviation from the reference tempo in parts per million.
+        double jitterRms = 0.0;      ///< RMS tick jitter in milliseconds.
+        double jitterPeak = 0.0;     ///< Largest tick jitter in milliseconds.
+    };
+
     MidiClock() = default;
     ~MidiClock() {}
 
     void process (const MidiMessage& msg);
     void reset (const double sampleRate, const int blockSize);
 
+    /** Start or stop measuring. Starting clears the previous results. Drift is
+        reported against referenceTempo when it is greater than zero.
+     */
+    void setMeasuring (bool shouldMeasure, double referenceTempo = 0.0);
+
+    /** Returns true if measuring. */
+    bool isMeasuring() const noexcept { return measuring.load (std::memory_order_relaxed); }
+
+    /** Returns the current measurement. Safe to call from any thread. */
+    Measurement getMeasurement() const;
+
+    /** Returns true if the loop is locked to an incoming clock. */
+    bool isLocked() const noexcept { return locked.load (std::memory_order_relaxed); }
+
     void addListener (Listener*);
     void removeListener (Listener*);
 
+    /** Ticks to acquire lock, and between tempo updates (one beat). */
+    static constexpr int lockTicks = 24;
+
 private:
     double sampleRate = 0.0;
     int blockSize = 0;
     DelayLockedLoop dll;
-    double timeOfLastUpdate = 0.0;
-    double lastKnownTimeDiff = 0.0;
+    double firstTickTime = 0.0;
+    double lastTickTime = 0.0;
+    double lastKnownTempo = 0.0;
     int midiClockTicks = 0;
-    int syncPeriodTicks = 48;
-    double bpmUpdateSeconds = 1.0;
+    std::atomic<bool> locked { false };
+
+    std::atomic<bool> measuring { false };
+    mutable SpinLock measureLock;
+    struct MeasureState
+    {
+        double referenceTempo = 0.0;
+        double startTime = 0.0;
+        int64 n = 0;
+        double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+        int64 numErrors = 0;
+        double sumErrorSquared = 0.0;
+        double peakError = 0.0;
+    } measure;
 
     Array<Listener*> listeners;
+
+    void restart (double time);
+    void measureTick (double time, double error, bool errorValid);
 };
 
+/** Generates MIDI clock for a stream of audio blocks.
+
+    The position of the next pulse is tracked with sub-sample precision so
+    pulses don't drift at tempos that aren't a whole number of samples per
+    clock.  Tempo changes keep the phase of the pulse in progress.
+ */
 class MidiClockMaster
 {
 public:
@@ -55,15 +119,16 @@ public:
 
     ~MidiClockMaster() noexcept {}
 
+    /** Restart so the next pulse is at the start of the next block. */
     inline void reset()
     {
-        pos = 0;
+        samplesUntilClock = 0.0;
         updateCoefficients();
     }
 
     inline void setTempo (const double newTempo) noexcept
     {
-        if (tempo == newTempo)
+        if (tempo == newTempo || newTempo <= 0.0)
             return;
         tempo = newTempo;
         updateCoefficients();
@@ -71,41 +136,56 @@ public:
 
     inline void setSampleRate (const double newSampleRate) noexcept
     {
-        if (sampleRate == newSampleRate)
+        if (sampleRate == newSampleRate || newSampleRate <= 0.0)
             return;
         sampleRate = newSampleRate;
         updateCoefficients();
     }
 
+    /** Returns the exact number of samples between pulses. */
+    inline double getSamplesPerClock() const noexcept { return samplesPerClock; }
+
+    /** Returns the fractional number of samples from the start of the next
+        block to the next pulse.
+     */
+    inline double getSamplesUntilClock() const noexcept { return samplesUntilClock; }
+
     inline void render (MidiBuffer& midi, int numSamples) noexcept
     {
-        if (samplesPerClock <= 0)
+        if (samplesPerClock <= 0.0)
             return;
 
-        int frame = static_cast<int> (pos % samplesPerClock);
-        if (frame > 0)
-            frame = samplesPerClock - frame;
-        while (frame < numSamples)
+        // each pulse goes on the first sample at or after its exact position,
+        // one falling between the last sample and the next block is carried
+        // over as a small negative offset.
+        double next = samplesUntilClock;
+        for (;;)
         {
+            const auto frame = (int) std::ceil (next);
+            if (frame >= numSamples)
+                break;
             midi.addEvent (clockMessage, frame);
-            frame += samplesPerClock;
+            next += samplesPerClock;
         }
 
-        pos += numSamples;
+        samplesUntilClock = next - (double) numSamples;
     }
 
 private:
     MidiMessage clockMessage;
-    int64 pos = 0;
     double tempo = 120.0;
     double sampleRate = 44100.0;
-    int samplesPerClock = 0;
-    double clocksPerMinute = 1.0;
+    double samplesPerClock = 0.0;
+    double samplesUntilClock = 0.0;
 
     void updateCoefficients()
     {
-        clocksPerMinute = 24.f * tempo;
-        samplesPerClock = roundToIntAccurate ((60.0 * sampleRate) / clocksPerMinute);
+        const double newSamplesPerClock = (60.0 * sampleRate) / (24.0 * tempo);
+
+        // keep the fraction of the current pulse interval still to go
+        if (samplesPerClock > 0.0)
+            samplesUntilClock *= newSamplesPerClock / samplesPerClock;
+        samplesPerClock = newSamplesPerClock;
     }
 };
 
@@ -0,0 +1,110 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include "engine/mididevicehub.hpp"
+#include "engine/midieventbuffer.hpp"
+
+namespace element {
+
+//==============================================================================
+MidiInputHub::MidiInputHub (const String& deviceIdentifier, const int64& blockCounter, const MidiInputTimer& t)
+    : identifier (deviceIdentifier),
+      engineBlock (blockCounter),
+      timer (t)
+{
+    block.ensureSize (MidiEventBuffer::getMidiBufferSize());
+}
+
+void MidiInputHub::push (const MidiMessage& message) noexcept
+{
+    if (subscribed.load (std::memory_order_acquire))
+        queue.push (message);
+}
+
+const MidiBuffer& MidiInputHub::getBlock (int numSamples) noexcept
+{
+    if (lastBlock == engineBlock)
+        return block;
+
+    lastBlock = engineBlock;
+    block.clear();
+
+    // messages queued before the last unsubscribe are stale
+    if (flushPending.exchange (false, std::memory_order_acq_rel))
+        queue.clear();
+
+    queue.pop ([this, numSamples] (double timestamp, const uint8* data, int size) {
+        block.addEvent (data, size, jlimit (0, jmax (0, numSamples - 1), timer.getSampleOffset (timestamp)));
+    });
+
+    return block;
+}
+
+//==============================================================================
+MidiOutputHub::MidiOutputHub (std::unique_ptr<MidiOutput> o)
+    : Thread ("element.midiOutputHub"),
+      identifier (o->getIdentifier()),
+      output (std::move (o))
+{
+    startThread (Thread::Priority::high);
+}
+
+MidiOutputHub::~MidiOutputHub()
+{
+    stopThread (1000);
+    output.reset();
+}
+
+void MidiOutputHub::send (const MidiBuffer& buffer, int numSamples, double startMs, double sampleRate) noexcept
+{
+    if (buffer.isEmpty() || sampleRate <= 0.0)
+        return;
+
+    const double msPerSample = 1000.0 / sampleRate;
+    for (const auto m : buffer)
+    {
+        if (m.samplePosition >= numSamples)
+            break;
+        queue.push (startMs + msPerSample * (double) m.samplePosition, m.data, m.numBytes);
+    }
+
+    notify();
+}
+
+void MidiOutputHub::run()
+{
+    // messages from all nodes, ordered by time. only this thread touches it.
+    struct Pending
+    {
+        double time;
+        MidiMessage message;
+    };
+    std::vector<Pending> pending;
+    pending.reserve (1024);
+
+    while (! threadShouldExit())
+    {
+        queue.pop ([&pending] (double timestamp, const uint8* data, int size) {
+            Pending p { timestamp, MidiMessage (data, size, timestamp) };
+            auto pos = std::upper_bound (pending.begin(), pending.end(), timestamp, [] (double t, const Pending& other) {
+                return t < other.time;
+            });
+            pending.insert (pos, std::move (p));
+        });
+
+        const auto now = Time::getMillisecondCounterHiRes();
+        auto due = pending.begin();
+        while (due != pending.end() && due->time <= now)
+        {
+            output->sendMessageNow (due->message);
+            ++due;
+        }
+        pending.erase (pending.begin(), due);
+
+        const int waitMs = pending.empty() ? 100
+                                           : jlimit (1, 100, roundToInt (pending.front().time - now));
+        wait (waitMs);
+    }
+}
+
+} // namespace element
@@ -0,0 +1,94 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include "engine/midiinputqueue.hpp"
+
+namespace element {
+
+/** The shared input of one MIDI device.
+
+    MidiEngine owns one hub per input device and feeds it from the device
+    thread.  Any number of MidiDeviceProcessor nodes may subscribe.  The
+    first node rendered in an audio block drains the queue into the hub's
+    block buffer, every other node reads that same buffer.
+
+    Hubs live as long as the MidiEngine, so the device thread never sees
+    one go away.
+ */
+class MidiInputHub final
+{
+public:
+    /** Returns the device identifier. */
+    const String& getIdentifier() const noexcept { return identifier; }
+
+    /** Returns this block's messages from the device. Call only from the
+        audio thread.
+     */
+    const MidiBuffer& getBlock (int numSamples) noexcept;
+
+    /** Returns the number of subscribed nodes. */
+    int getNumSubscribers() const noexcept { return numSubscribers; }
+
+private:
+    friend class MidiEngine;
+    MidiInputHub (const String& deviceIdentifier, const int64& blockCounter, const MidiInputTimer& timer);
+
+    const String identifier;
+    const int64& engineBlock;
+    const MidiInputTimer& timer;
+
+    MidiInputQueue queue;
+    std::atomic<bool> subscribed { false };
+    std::atomic<bool> flushPending { false };
+    int numSubscribers = 0; // message thread
+
+    // audio thread
+    MidiBuffer block;
+    int64 lastBlock = -1;
+
+    /** Called by the device thread. */
+    void push (const MidiMessage& message) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (MidiInputHub)
+};
+
+//==============================================================================
+/** The shared output of one MIDI device.
+
+    Every node sending to the device writes into one queue.  A merger thread
+    per port orders the messages by time and sends them when due, so output
+    from several nodes is never interleaved mid-block.
+ */
+class MidiOutputHub final : private Thread
+{
+public:
+    ~MidiOutputHub();
+
+    /** Returns the device identifier. */
+    const String& getIdentifier() const noexcept { return identifier; }
+
+    /** Queue a block of messages. The block starts at startMs on the
+        millisecond counter. Call only from the audio thread.
+     */
+    void send (const MidiBuffer& buffer, int numSamples, double startMs, double sampleRate) noexcept;
+
+    /** Returns the number of messages dropped because the queue was full. */
+    int getNumOverflows() const noexcept { return queue.getNumOverflows(); }
+
+private:
+    friend class MidiEngine;
+    MidiOutputHub (std::unique_ptr<MidiOutput> output);
+
+    const String identifier;
+    std::unique_ptr<MidiOutput> output;
+    MidiInputQueue queue;
+    int numSubscribers = 0; // message thread
+
+    void run() override;
+
+    JUCE_DECLARE_NON_COPYABLE (MidiOutputHub)
+};
+
+} // namespace element
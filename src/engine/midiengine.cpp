@@ -54,6 +54,8 @@ void MidiEngine::writeSettings (Settings& settings)
     ValueTree data ("MidiSettings");
     for (auto* const holder : openMidiInputs)
     {
+        if (holder->input == nullptr)
+            continue;
         ValueTree input (tags::input);
         input.setProperty (tags::name, holder->input->getName(), nullptr)
             .setProperty (tags::identifier, holder->input->getIdentifier(), nullptr)
@@ -155,10 +157,15 @@ void MidiEngine::MidiInputHolder::handleIncomingMidiMessage (MidiInput* source,
         return;
 
     jassert (source == input.get());
+    if (active)
+        queue.push (message);
+    if (auto* h = hub.load (std::memory_order_acquire))
+        h->push (message);
+
     const ScopedLock sl (engine.midiCallbackLock);
 
     for (auto& mc : engine.midiCallbacks)
-        if ((active || mc.consumer) && (mc.device.isEmpty() || mc.device == input->getIdentifier()))
+        if ((active || mc.consumer) && (mc.device.isEmpty() || mc.device == identifier))
             mc.callback->handleIncomingMidiMessage (input.get(), message);
 }
 
@@ -177,7 +184,7 @@ MidiEngine::~MidiEngine()
 MidiEngine::MidiInputHolder* MidiEngine::getMidiInput (const String& identifier, bool openIfNotAlready)
 {
     for (auto* const holder : openMidiInputs)
-        if (holder->input && holder->input->getIdentifier() == identifier)
+        if (holder->identifier == identifier)
             return holder;
 
     if (! openIfNotAlready)
@@ -200,17 +207,51 @@ MidiEngine::MidiInputHolder* MidiEngine::getMidiInput (const String& identifier,
     {
         std::unique_ptr<MidiInputHolder> holder;
         holder.reset (new MidiInputHolder (*this));
+        holder->identifier = identifier;
         if (auto midiIn = MidiInput::openDevice (identifier, holder.get()))
         {
             holder->input.reset (midiIn.release());
             holder->input->start();
-            return openMidiInputs.add (holder.release());
+            return addMidiInput (std::move (holder));
         }
     }
 
     return nullptr;
 }
 
+MidiEngine::MidiInputHolder* MidiEngine::addMidiInput (std::unique_ptr<MidiInputHolder> holder)
+{
+    auto* const added = openMidiInputs.add (holder.release());
+    const auto numQueues = numInputQueues.load (std::memory_order_relaxed);
+    if (numQueues < maxInputQueues)
+    {
+        inputQueues[(size_t) numQueues] = added;
+        numInputQueues.store (numQueues + 1, std::memory_order_release);
+    }
+    return added;
+}
+
+MidiInputCallback* MidiEngine::addVirtualInput (const String& identifier)
+{
+    if (auto* const existing = getMidiInput (identifier, false))
+        return existing->input == nullptr ? existing : nullptr;
+
+    std::unique_ptr<MidiInputHolder> holder;
+    holder.reset (new MidiInputHolder (*this));
+    holder->identifier = identifier;
+    holder->active = true;
+    return addMidiInput (std::move (holder));
+}
+
+int MidiEngine::getNumInputOverflows() const noexcept
+{
+    int overflows = 0;
+    const auto numQueues = numInputQueues.load (std::memory_order_acquire);
+    for (int i = 0; i < numQueues; ++i)
+        overflows += inputQueues[(size_t) i]->queue.getNumOverflows();
+    return overflows;
+}
+
 //==============================================================================
 void MidiEngine::setMidiInputEnabled (const MidiDeviceInfo& device, const bool enabled)
 {
@@ -234,7 +275,7 @@ void MidiEngine::setMidiInputEnabled (const MidiDeviceInfo& device, const bool e
 bool MidiEngine::isMidiInputEnabled (const MidiDeviceInfo& device) const
 {
     for (auto* mi : openMidiInputs)
-        if (mi->input != nullptr && mi->input->getIdentifier() == device.identifier && mi->active)
+        if (mi->identifier == device.identifier && mi->active)
             return true;
 
     return false;
@@ -330,6 +371,95 @@ void MidiEngine::processMidiBuffer (const MidiBuffer& buffer, int nframes, doubl
     }
 }
 
+void MidiEngine::prepareInputQueues (double sampleRate, int blockSize)
+{
+    inputTimer.reset (sampleRate, blockSize);
+    const auto numQueues = numInputQueues.load (std::memory_order_acquire);
+    for (int i = 0; i < numQueues; ++i)
+        inputQueues[(size_t) i]->queue.clear();
+}
+
+void MidiEngine::beginBlock (int numSamples) noexcept
+{
+    inputTimer.beginBlock (0.001 * Time::getMillisecondCounterHiRes(), numSamples);
+    ++blockCounter;
+}
+
+void MidiEngine::renderInputQueues (MidiBuffer& buffer, int numSamples) noexcept
+{
+    beginBlock (numSamples);
+    const auto numQueues = numInputQueues.load (std::memory_order_acquire);
+    for (int i = 0; i < numQueues; ++i)
+    {
+        inputQueues[(size_t) i]->queue.pop ([this, &buffer] (double timestamp, const uint8* data, int size) {
+            buffer.addEvent (data, size, inputTimer.getSampleOffset (timestamp));
+        });
+    }
+}
+
+//==============================================================================
+MidiInputHub* MidiEngine::acquireInputHub (const MidiDeviceInfo& device)
+{
+    auto* const holder = getMidiInput (device.identifier, true);
+    if (holder == nullptr)
+        return nullptr;
+
+    auto* hub = holder->hub.load (std::memory_order_acquire);
+    if (hub == nullptr)
+    {
+        hub = inputHubs.add (new MidiInputHub (device.identifier, blockCounter, inputTimer));
+        holder->hub.store (hub, std::memory_order_release);
+    }
+
+    if (hub->numSubscribers++ == 0)
+    {
+        hub->flushPending.store (true, std::memory_order_release);
+        hub->subscribed.store (true, std::memory_order_release);
+    }
+
+    return hub;
+}
+
+void MidiEngine::releaseInputHub (MidiInputHub* hub)
+{
+    if (hub == nullptr || ! inputHubs.contains (hub))
+        return;
+    jassert (hub->numSubscribers > 0);
+    if (--hub->numSubscribers <= 0)
+    {
+        hub->numSubscribers = 0;
+        hub->subscribed.store (false, std::memory_order_release);
+    }
+}
+
+MidiOutputHub* MidiEngine::acquireOutputHub (const MidiDeviceInfo& device)
+{
+    for (auto* const hub : outputHubs)
+    {
+        if (hub->getIdentifier() == device.identifier)
+        {
+            ++hub->numSubscribers;
+            return hub;
+        }
+    }
+
+    auto output = MidiOutput::openDevice (device.identifier);
+    if (output == nullptr)
+        return nullptr;
+
+    auto* const hub = outputHubs.add (new MidiOutputHub (std::move (output)));
+    hub->numSubscribers = 1;
+    return hub;
+}
+
+void MidiEngine::releaseOutputHub (MidiOutputHub* hub)
+{
+    if (hub == nullptr || ! outputHubs.contains (hub))
+        return;
+    if (--hub->numSubscribers <= 0)
+        outputHubs.removeObject (hub);
+}
+
 int MidiEngine::getNumActiveMidiInputs() const
 {
     int total = 0;
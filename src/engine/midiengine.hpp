@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include "engine/mididevicehub.hpp"
+#include "engine/midiinputqueue.hpp"
+
 namespace element {
 
 class Settings;
@@ -71,6 +74,19 @@ public:
     /** Returns the number of enabled midi inputs */
     int getNumActiveMidiInputs() const;
 
+    /** Adds an enabled input which isn't backed by a device, e.g. for tests
+        and benchmarks.  Messages passed to the returned callback go through
+        the same queue, hub and listeners as a device's, so a source of null
+        is expected.  Listeners register with the same identifier.  The input
+        lives as long as the engine.
+     */
+    MidiInputCallback* addVirtualInput (const String& identifier);
+
+    /** Returns the number of input messages dropped because a device's queue
+        was full.
+     */
+    int getNumInputOverflows() const noexcept;
+
     //==============================================================================
     /** Sets a midi output device to use as the default.
 
@@ -103,6 +119,50 @@ public:
 
     CriticalSection& getMidiOutputLock() { return midiOutputLock; }
 
+    //==============================================================================
+    /** Prepares the per-device input queues for rendering.  Pending messages
+        are discarded.  Call this while the audio device is stopped.
+     */
+    void prepareInputQueues (double sampleRate, int blockSize);
+
+    /** Merges messages from all active input devices into a buffer. Events are
+        placed at sample offsets derived from the device timestamps.  This is
+        wait-free and should only be called at the start of an audio block.
+     */
+    void renderInputQueues (MidiBuffer& buffer, int numSamples) noexcept;
+
+    /** Starts a new audio block for the input queues and hubs. This is called
+        by renderInputQueues(), call it directly when that isn't used.
+     */
+    void beginBlock (int numSamples) noexcept;
+
+    /** Returns the sample offset in the current block of a MIDI device
+        timestamp in seconds, the same as input messages get. Audio thread,
+        after beginBlock().
+     */
+    int getSampleOffset (double timestamp) const noexcept { return inputTimer.getSampleOffset (timestamp); }
+
+    //==============================================================================
+    /** Subscribes to the shared input of a device, opening the device if
+        needed.  Returns nullptr if it couldn't be opened.  Call from the
+        message thread, and balance with releaseInputHub().
+     */
+    MidiInputHub* acquireInputHub (const MidiDeviceInfo& device);
+
+    /** Unsubscribes from a device input hub. */
+    void releaseInputHub (MidiInputHub* hub);
+
+    /** Subscribes to the shared output of a device, opening the device if
+        needed.  Returns nullptr if it couldn't be opened.  Call from the
+        message thread, and balance with releaseOutputHub().
+     */
+    MidiOutputHub* acquireOutputHub (const MidiDeviceInfo& device);
+
+    /** Unsubscribes from a device output hub. The device closes when the last
+        subscriber leaves, make sure the audio thread no longer uses it.
+     */
+    void releaseOutputHub (MidiOutputHub* hub);
+
 private:
     struct MidiCallbackInfo
     {
@@ -122,8 +182,11 @@ private:
         MidiInputHolder (MidiEngine& e)
             : engine (e) {}
 
+        String identifier;
         std::unique_ptr<MidiInput> input;
         bool active = false; // if true, then will feed to audio engine
+        MidiInputQueue queue;
+        std::atomic<MidiInputHub*> hub { nullptr };
 
         void handleIncomingMidiMessage (MidiInput* source, const MidiMessage& message) override;
 
@@ -132,6 +195,9 @@ private:
     };
 
     StringArray midiInsFromXml;
+    // declared before the holders so devices close before their hubs go away
+    OwnedArray<MidiInputHub> inputHubs;
+    OwnedArray<MidiOutputHub> outputHubs;
     OwnedArray<MidiInputHolder> openMidiInputs;
     Array<MidiCallbackInfo> midiCallbacks;
 
@@ -139,10 +205,19 @@ private:
     std::unique_ptr<MidiOutput> defaultMidiOutput;
     CriticalSection audioCallbackLock, midiCallbackLock, midiOutputLock;
 
+    // holders are only ever added while the engine is alive, so the audio
+    // thread can read the first numInputQueues entries without locking.
+    static constexpr int maxInputQueues = 128;
+    std::array<MidiInputHolder*, maxInputQueues> inputQueues {};
+    std::atomic<int> numInputQueues { 0 };
+    MidiInputTimer inputTimer;
+    int64 blockCounter = 0;
+
     class CallbackHandler;
     std::unique_ptr<CallbackHandler> callbackHandler;
 
     MidiInputHolder* getMidiInput (const String& identifier, bool openIfNotAlready);
+    MidiInputHolder* addMidiInput (std::unique_ptr<MidiInputHolder> holder);
     void handleIncomingMidiMessageInt (juce::MidiInput*, const juce::MidiMessage&);
 };
 
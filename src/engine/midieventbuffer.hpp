@@ -0,0 +1,189 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <element/juce.hpp>
+
+namespace element {
+
+/** A fixed capacity, time ordered buffer of MIDI events for the render path.
+
+    Storage is allocated once, up front.  Sample offsets, event positions
+    and message bytes live in separate contiguous arrays, so adding events
+    never allocates.  When an event doesn't fit it is left out and counted
+    as an overflow, callers should fall back to a MidiBuffer for that block
+    and report it so the capacity can grow off the audio thread.
+
+    Events are kept sorted by sample offset, events with equal offsets
+    keep the order they were added in.
+ */
+class MidiEventBuffer final
+{
+public:
+    /** Default number of events. */
+    static constexpr int defaultMaxEvents = 1024;
+    /** Default number of message bytes. */
+    static constexpr int defaultMaxBytes = 8 * 1024;
+
+    /** Returns the number of bytes a juce::MidiBuffer needs to hold the given
+        events. Use with MidiBuffer::ensureSize so copyTo() doesn't allocate.
+     */
+    static constexpr size_t getMidiBufferSize (int numEvents = defaultMaxEvents,
+                                               int numBytes = defaultMaxBytes) noexcept
+    {
+        return (size_t) numEvents * (sizeof (int32) + sizeof (uint16)) + (size_t) numBytes;
+    }
+
+    explicit MidiEventBuffer (int maxEvents = defaultMaxEvents, int maxBytes = defaultMaxBytes)
+    {
+        reserve (maxEvents, maxBytes);
+    }
+
+    /** Change the capacity. This allocates and clears the buffer, don't call
+        it from the audio thread.
+     */
+    void reserve (int maxEvents, int maxBytes)
+    {
+        eventCapacity = jmax (1, maxEvents);
+        byteCapacity = jmax (3, maxBytes);
+        timestamps.allocate ((size_t) eventCapacity, true);
+        offsets.allocate ((size_t) eventCapacity, true);
+        sizes.allocate ((size_t) eventCapacity, true);
+        bytes.allocate ((size_t) byteCapacity, true);
+        clear();
+    }
+
+    /** Remove all events and reset the overflow count. */
+    void clear() noexcept
+    {
+        numEvents = 0;
+        numBytes = 0;
+        overflows = 0;
+        overflowBytes = 0;
+    }
+
+    /** Add a message at a sample offset. Returns false if there wasn't room. */
+    bool addEvent (const uint8* data, int size, int sampleOffset) noexcept
+    {
+        if (size <= 0 || size > std::numeric_limits<uint16>::max()
+            || numEvents >= eventCapacity || numBytes + size > byteCapacity)
+        {
+            ++overflows;
+            overflowBytes += jmax (0, size);
+            return false;
+        }
+
+        std::memcpy (bytes + numBytes, data, (size_t) size);
+
+        // most events arrive in order, so the search is usually skipped
+        int index = numEvents;
+        if (index > 0 && timestamps[index - 1] > sampleOffset)
+            index = (int) (std::upper_bound (timestamps.get(), timestamps + numEvents, sampleOffset) - timestamps.get());
+
+        if (index < numEvents)
+        {
+            const auto count = (size_t) (numEvents - index);
+            std::memmove (timestamps + index + 1, timestamps + index, count * sizeof (int32));
+            std::memmove (offsets + index + 1, offsets + index, count * sizeof (int32));
+            std::memmove (sizes + index + 1, sizes + index, count * sizeof (uint16));
+        }
+
+        timestamps[index] = sampleOffset;
+        offsets[index] = numBytes;
+        sizes[index] = (uint16) size;
+        numBytes += size;
+        ++numEvents;
+        return true;
+    }
+
+    /** Add a message at a sample offset. Returns false if there wasn't room. */
+    bool addEvent (const MidiMessage& message, int sampleOffset) noexcept
+    {
+        return addEvent (message.getRawData(), message.getRawDataSize(), sampleOffset);
+    }
+
+    /** Add events in the range [startSample, startSample + numSamples) of a
+        MidiBuffer, shifted by sampleDelta. A negative numSamples adds all.
+        Returns false if any event was dropped.
+     */
+    bool addEvents (const MidiBuffer& source, int startSample = 0, int numSamples = -1, int sampleDelta = 0) noexcept
+    {
+        bool ok = true;
+        for (const auto metadata : source)
+        {
+            if (metadata.samplePosition < startSample)
+                continue;
+            if (numSamples >= 0 && metadata.samplePosition >= startSample + numSamples)
+                break;
+            ok = addEvent (metadata.data, metadata.numBytes, metadata.samplePosition + sampleDelta) && ok;
+        }
+        return ok;
+    }
+
+    /** Replace the contents of a MidiBuffer with these events.
+
+        The events are written straight into the MidiBuffer's storage, so this
+        doesn't allocate provided the destination has at least
+        getMidiBufferSize() bytes reserved.
+     */
+    void copyTo (MidiBuffer& dest) const noexcept
+    {
+        constexpr int headerSize = (int) (sizeof (int32) + sizeof (uint16));
+        const int totalBytes = numEvents * headerSize + numBytes;
+
+        // resize() alone would release storage when shrinking
+        dest.data.clearQuick();
+        dest.data.ensureStorageAllocated (totalBytes);
+        dest.data.resize (totalBytes);
+
+        auto* d = dest.data.getRawDataPointer();
+        for (int i = 0; i < numEvents; ++i)
+        {
+            writeUnaligned<int32> (d, timestamps[i]);
+            d += sizeof (int32);
+            writeUnaligned<uint16> (d, sizes[i]);
+            d += sizeof (uint16);
+            std::memcpy (d, bytes + offsets[i], sizes[i]);
+            d += sizes[i];
+        }
+    }
+
+    /** Returns the number of events. */
+    int getNumEvents() const noexcept { return numEvents; }
+    /** Returns true if there are no events. */
+    bool isEmpty() const noexcept { return numEvents == 0; }
+    /** Returns the sample offset of an event. */
+    int getSampleOffset (int index) const noexcept { return timestamps[index]; }
+    /** Returns the message bytes of an event. */
+    const uint8* getData (int index) const noexcept { return bytes + offsets[index]; }
+    /** Returns the number of message bytes in an event. */
+    int getSize (int index) const noexcept { return (int) sizes[index]; }
+
+    /** Returns the number of events dropped since the last clear. */
+    int getNumOverflows() const noexcept { return overflows; }
+    /** Returns true if any event was dropped since the last clear. */
+    bool hasOverflowed() const noexcept { return overflows > 0; }
+    /** Returns the number of events that would have fit everything since the last clear. */
+    int getNumEventsRequired() const noexcept { return numEvents + overflows; }
+    /** Returns the number of message bytes that would have fit everything since the last clear. */
+    int getNumBytesRequired() const noexcept { return numBytes + overflowBytes; }
+
+    /** Returns the maximum number of events. */
+    int getEventCapacity() const noexcept { return eventCapacity; }
+    /** Returns the maximum number of message bytes. */
+    int getByteCapacity() const noexcept { return byteCapacity; }
+
+private:
+    HeapBlock<int32> timestamps;
+    HeapBlock<int32> offsets;
+    HeapBlock<uint16> sizes;
+    HeapBlock<uint8> bytes;
+    int eventCapacity = 0, byteCapacity = 0;
+    int numEvents = 0, numBytes = 0;
+    int overflows = 0, overflowBytes = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (MidiEventBuffer)
+};
+
+} // namespace element
@@ -0,0 +1,179 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include "ElementApp.h"
+#include "delaylockedloop.hpp"
+#include "ringbuffer.hpp"
+
+namespace element {
+
+/** A wait-free, single producer/single consumer queue of timestamped MIDI
+    messages.  One of these is owned by every open MIDI input device.  The
+    device thread pushes and the audio thread pops.
+ */
+class MidiInputQueue final
+{
+public:
+    explicit MidiInputQueue (int32 capacityBytes = 32 * 1024)
+        : ring (capacityBytes)
+    {
+        scratch.allocate ((size_t) ring.size(), true);
+    }
+
+    /** Push a message on to the queue. Call only from the device thread.
+        Returns false and counts an overflow if there wasn't enough room.
+     */
+    bool push (const MidiMessage& message) noexcept
+    {
+        return push (message.getTimeStamp(), message.getRawData(), message.getRawDataSize());
+    }
+
+    /** Push raw message bytes on to the queue. Call only from the producer thread. */
+    bool push (double timestamp, const uint8* data, int size) noexcept
+    {
+        const Header header { timestamp, (uint32) jmax (0, size) };
+        if (header.size == 0 || ! ring.canWrite (sizeof (Header) + header.size))
+        {
+            overflows.fetch_add (1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // the reader waits until the whole body is available
+        ring.write (header);
+        ring.write (data, header.size);
+        return true;
+    }
+
+    /** Pop every complete message in the queue. Call only from the audio thread.
+
+        @param callback     void (double timestamp, const uint8* data, int size)
+     */
+    template <typename Callback>
+    void pop (Callback&& callback) noexcept
+    {
+        Header header;
+        while (ring.canRead (sizeof (Header)))
+        {
+            ring.peak (&header, sizeof (Header));
+            if (! ring.canRead (sizeof (Header) + header.size))
+                break;
+            ring.advance (sizeof (Header), false);
+            ring.read (scratch.getData(), header.size);
+            callback (header.timestamp, scratch.getData(), (int) header.size);
+        }
+    }
+
+    /** Discard all pending messages. Call only from the consumer side. */
+    void clear() noexcept
+    {
+        pop ([] (double, const uint8*, int) {});
+    }
+
+    /** Returns the number of messages dropped because the queue was full. */
+    int getNumOverflows() const noexcept { return overflows.load (std::memory_order_relaxed); }
+
+private:
+    struct Header
+    {
+        double timestamp;
+        uint32 size;
+    };
+
+    RingBuffer ring;
+    HeapBlock<uint8> scratch;
+    std::atomic<int> overflows { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (MidiInputQueue)
+};
+
+//==============================================================================
+/** Converts MIDI device timestamps (seconds, Time::getMillisecondCounterHiRes
+    based) to sample offsets in the current audio block.
+
+    The audio callback's wall clock start time is filtered with a delay
+    locked loop, so both callback jitter and drift between the audio and
+    system clocks are smoothed out.  Messages are placed relative to the
+    previous filtered block start, giving one block of latency in exchange
+    for preserving the timing between events.
+ */
+class MidiInputTimer final
+{
+public:
+    MidiInputTimer() = default;
+
+    /** Reset the estimator. Call when the audio device (re)starts or the
+        sample rate changes.
+     */
+    void reset (double newSampleRate, int newBlockSize) noexcept
+    {
+        sampleRate = newSampleRate;
+        nominalBlockSize = blockSize = newBlockSize;
+        started = false;
+    }
+
+    /** Update with the system time at the start of an audio callback.
+
+        Blocks may vary in size, the loop advances by each block's own
+        length.  It only restarts after a gap of several blocks, e.g. an
+        xrun or a stalled device.
+     */
+    void beginBlock (double nowSeconds, int numSamples) noexcept
+    {
+        if (sampleRate <= 0.0 || numSamples <= 0)
+            return;
+
+        if (nominalBlockSize <= 0)
+            nominalBlockSize = numSamples;
+
+        const auto nominalPeriod = (double) nominalBlockSize / sampleRate;
+        if (started && std::abs (nowSeconds - dll.nextTime()) > 4.0 * nominalPeriod)
+            started = false;
+
+        if (! started)
+        {
+            blockSize = numSamples;
+            dll.reset (nowSeconds, (double) nominalBlockSize, sampleRate);
+            // roughly one Hz of bandwidth relative to the callback rate
+            dll.setParams (1.0, 1.0 / nominalPeriod);
+            lastBlockStart = nowSeconds - ((double) numSamples / sampleRate);
+            blockStart = nowSeconds;
+            samplesPerSecond = sampleRate;
+            started = true;
+            return;
+        }
+
+        lastBlockStart = blockStart;
+        dll.update (nowSeconds, (double) numSamples / (double) nominalBlockSize);
+        blockStart = dll.currentTime();
+        blockSize = numSamples;
+
+        const auto period = dll.period();
+        samplesPerSecond = period > 0.0 ? (double) nominalBlockSize / period : sampleRate;
+    }
+
+    /** Returns the sample offset in the current block for a device timestamp. */
+    int getSampleOffset (double timestamp) const noexcept
+    {
+        if (! started || timestamp <= 0.0)
+            return 0;
+        const auto offset = roundToInt ((timestamp - lastBlockStart) * samplesPerSecond);
+        return jlimit (0, jmax (0, blockSize - 1), offset);
+    }
+
+    /** Returns the currently estimated device sample rate. */
+    double getEstimatedSampleRate() const noexcept { return samplesPerSecond; }
+
+private:
+    DelayLockedLoop dll;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int nominalBlockSize = 0;
+    bool started = false;
+    double lastBlockStart = 0.0;
+    double blockStart = 0.0;
+    double samplesPerSecond = 0.0;
+};
+
+} // namespace element
@@ -5,15 +5,14 @@
 
 #include <element/juce.hpp>
 
+#include "engine/midieventbuffer.hpp"
+
 namespace element {
 
 class MidiTranspose
 {
 public:
-    MidiTranspose()
-    {
-        output.ensureSize (sizeof (uint8) * 3 * 16);
-    }
+    MidiTranspose() = default;
 
     ~MidiTranspose()
     {
@@ -57,13 +56,13 @@ public:
             output.addEvent (msg, m.samplePosition);
         }
 
-        midi.swapWith (output);
+        output.copyTo (midi);
         output.clear();
     }
 
 private:
     Atomic<int> offset { 0 };
-    MidiBuffer output;
+    MidiEventBuffer output;
 };
 
 } // namespace element
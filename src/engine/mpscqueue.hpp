@@ -0,0 +1,104 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <element/juce/core.hpp>
+
+namespace element {
+
+/** A bounded, lock-free queue with many producers and one consumer.
+
+    Producers claim a cell with a compare and swap on the write position,
+    then publish it through the cell's sequence number, so pushing never
+    blocks and never allocates.  Only one thread may pop.
+
+    ElementType should be cheap to copy, e.g. a pointer or a small struct.
+ */
+template <typename ElementType>
+class MpscQueue final
+{
+public:
+    /** Create a queue. The capacity is rounded up to a power of two. */
+    explicit MpscQueue (int capacity = 1024)
+    {
+        size_t size = 2;
+        while (size < (size_t) juce::jmax (2, capacity))
+            size <<= 1;
+        mask = size - 1;
+        cells.reset (new Cell[size]);
+        for (size_t i = 0; i < size; ++i)
+            cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+
+    /** Returns the number of elements the queue can hold. */
+    int getCapacity() const noexcept { return (int) (mask + 1); }
+
+    /** Add an element. Returns false if the queue is full. Any thread. */
+    bool push (const ElementType& element) noexcept
+    {
+        auto pos = writePos.load (std::memory_order_relaxed);
+        Cell* cell = nullptr;
+
+        for (;;)
+        {
+            cell = &cells[pos & mask];
+            const auto sequence = cell->sequence.load (std::memory_order_acquire);
+            const auto diff = (intptr_t) sequence - (intptr_t) pos;
+
+            if (diff == 0)
+            {
+                if (writePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = writePos.load (std::memory_order_relaxed);
+            }
+        }
+
+        cell->element = element;
+        cell->sequence.store (pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Remove the oldest element. Returns false if the queue is empty.
+        Consumer thread only.
+     */
+    bool pop (ElementType& element) noexcept
+    {
+        auto& cell = cells[readPos & mask];
+        if ((intptr_t) cell.sequence.load (std::memory_order_acquire) - (intptr_t) (readPos + 1) < 0)
+            return false;
+
+        element = cell.element;
+        cell.element = ElementType();
+        cell.sequence.store (readPos + mask + 1, std::memory_order_release);
+        ++readPos;
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence { 0 };
+        ElementType element {};
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    std::atomic<size_t> writePos { 0 };
+    size_t readPos = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (MpscQueue)
+};
+
+} // namespace element
@@ -3,6 +3,8 @@
 
 #include <element/parameter.hpp>
 
+#include "engine/parameterchangebus.hpp"
+
 using namespace juce;
 namespace element {
 
@@ -58,14 +60,42 @@ void Parameter::endChangeGesture()
 
 void Parameter::sendValueChangedMessageToListeners (float newValue)
 {
-    ScopedLock lock (listenerLock);
-    for (int i = listeners.size(); --i >= 0;)
-        if (auto* l = listeners[i])
-            l->controlValueChanged (getParameterIndex(), newValue);
+    handleValueChanged (newValue);
+
+    if (numListeners.load (std::memory_order_relaxed) > 0)
+    {
+        ScopedLock lock (listenerLock);
+        for (int i = listeners.size(); --i >= 0;)
+            if (auto* l = listeners[i])
+                l->controlValueChanged (getParameterIndex(), newValue);
+    }
+
+    if (hasAsyncListeners.load (std::memory_order_relaxed) && ! asyncChangePending.exchange (true))
+    {
+        // a full or missing bus drops this change, the next one posts again
+        auto* bus = ParameterChangeBus::getCurrent();
+        if (bus == nullptr || ! bus->post (*this))
+            asyncChangePending.store (false);
+    }
+}
+
+void Parameter::sendAsyncValueChanged()
+{
+    // clear first: a change during the callbacks is posted again
+    asyncChangePending.store (false);
+    const auto value = getValue();
+    for (int i = asyncListeners.size(); --i >= 0;)
+        if (auto* l = asyncListeners[i])
+            l->parameterValueChanged (*this, value);
 }
 
 void Parameter::sendGestureChangedMessageToListeners (bool touched)
 {
+    handleGestureChanged (touched);
+
+    if (numListeners.load (std::memory_order_relaxed) <= 0)
+        return;
+
     ScopedLock lock (listenerLock);
     for (int i = listeners.size(); --i >= 0;)
         if (auto* l = listeners[i])
@@ -107,12 +137,36 @@ void Parameter::addListener (Parameter::Listener* newListener)
 {
     const ScopedLock sl (listenerLock);
     listeners.addIfNotAlreadyThere (newListener);
+    numListeners.store (listeners.size());
 }
 
 void Parameter::removeListener (Parameter::Listener* listenerToRemove)
 {
     const ScopedLock sl (listenerLock);
     listeners.removeFirstMatchingValue (listenerToRemove);
+    numListeners.store (listeners.size());
+}
+
+void Parameter::addAsyncListener (AsyncListener* newListener)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    if (newListener == nullptr || asyncListeners.contains (newListener))
+        return;
+    asyncListeners.add (newListener);
+    hasAsyncListeners.store (true);
+    if (auto* bus = ParameterChangeBus::getCurrent())
+        bus->addClient();
+}
+
+void Parameter::removeAsyncListener (AsyncListener* listenerToRemove)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    if (! asyncListeners.contains (listenerToRemove))
+        return;
+    asyncListeners.removeFirstMatchingValue (listenerToRemove);
+    hasAsyncListeners.store (! asyncListeners.isEmpty());
+    if (auto* bus = ParameterChangeBus::getCurrent())
+        bus->removeClient();
 }
 
 RangedParameter::RangedParameter (const PortDescription& p)
@@ -0,0 +1,115 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include "engine/parameterchangebus.hpp"
+
+using namespace juce;
+
+namespace element {
+
+namespace {
+// the shared bus, its owners are counted under the lock
+CriticalSection sharedLock;
+int numOwners = 0;
+std::atomic<ParameterChangeBus*> sharedBus { nullptr };
+
+ParameterChangeBus& retainSharedBus()
+{
+    const ScopedLock sl (sharedLock);
+    if (numOwners++ == 0)
+        sharedBus.store (new ParameterChangeBus(), std::memory_order_release);
+    return *sharedBus.load (std::memory_order_relaxed);
+}
+
+void releaseSharedBus()
+{
+    const ScopedLock sl (sharedLock);
+    jassert (numOwners > 0);
+    if (--numOwners == 0)
+        delete sharedBus.exchange (nullptr);
+}
+} // namespace
+
+class ParameterChangeBus::Dispatcher : public Timer
+{
+public:
+    explicit Dispatcher (ParameterChangeBus& b) : bus (b) { startTimerHz (60); }
+    ~Dispatcher() override { stopTimer(); }
+    void timerCallback() override { bus.dispatch(); }
+
+private:
+    ParameterChangeBus& bus;
+};
+
+ParameterChangeBus::ParameterChangeBus (int capacity)
+    : queue (capacity) {}
+
+ParameterChangeBus::~ParameterChangeBus()
+{
+    dispatcher.reset();
+    release();
+}
+
+ParameterChangeBus::Owner::Owner() : bus (retainSharedBus()) {}
+ParameterChangeBus::Owner::~Owner() { releaseSharedBus(); }
+
+ParameterChangeBus* ParameterChangeBus::getCurrent() noexcept
+{
+    return sharedBus.load (std::memory_order_acquire);
+}
+
+bool ParameterChangeBus::post (Parameter& param) noexcept
+{
+    // keeps the parameter alive until dispatched
+    param.incReferenceCount();
+    if (queue.push (&param))
+        return true;
+    param.decReferenceCountWithoutDeleting();
+    return false;
+}
+
+int ParameterChangeBus::dispatch()
+{
+    int count = 0;
+    Parameter* queued = nullptr;
+    while (queue.pop (queued))
+    {
+        ParameterPtr param (queued);
+        param->decReferenceCountWithoutDeleting();
+        param->sendAsyncValueChanged();
+        ++count;
+    }
+
+    ++numDispatches;
+    return count;
+}
+
+void ParameterChangeBus::addClient()
+{
+    if (++numClients == 1)
+        dispatcher = std::make_unique<Dispatcher> (*this);
+}
+
+void ParameterChangeBus::removeClient()
+{
+    // a listener added before this bus existed
+    if (numClients == 0 || --numClients > 0)
+        return;
+
+    dispatcher.reset();
+    // nobody is listening
+    release();
+}
+
+void ParameterChangeBus::release()
+{
+    Parameter* queued = nullptr;
+    while (queue.pop (queued))
+    {
+        ParameterPtr param (queued);
+        param->decReferenceCountWithoutDeleting();
+        param->asyncChangePending.store (false);
+    }
+}
+
+} // namespace element
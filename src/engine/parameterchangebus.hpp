@@ -0,0 +1,91 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <memory>
+
+#include <element/parameter.hpp>
+#include "engine/mpscqueue.hpp"
+
+namespace element {
+
+/** Carries parameter changes from any thread to async listeners on the
+    message thread.
+
+    Parameter::sendValueChangedMessageToListeners() posts a parameter here
+    once per dispatch, no matter how often it changes in between, so
+    posting is a flag exchange plus, at most, one push into a lock-free
+    queue.  dispatch() runs at display rate while async listeners exist and
+    hands each changed parameter's current value to its listeners.
+
+    Any number of threads post, only the message thread dispatches.  One
+    bus is shared by every Context in the process, e.g. several plugin
+    instances, each holding an Owner.  It is created with the first Owner
+    and deleted with the last.  Without one, changes aren't delivered.
+
+    @see Parameter::addAsyncListener
+ */
+class ParameterChangeBus final
+{
+public:
+    /** Create a bus holding up to capacity changed parameters per dispatch.
+        The capacity is rounded up to a power of two.
+     */
+    explicit ParameterChangeBus (int capacity = 4096);
+    ~ParameterChangeBus();
+
+    /** Keeps the shared bus alive. Create and delete on the message thread,
+        delete only once the owner's audio has stopped.
+     */
+    class Owner final
+    {
+    public:
+        Owner();
+        ~Owner();
+
+        /** Returns the shared bus. */
+        ParameterChangeBus& getBus() const noexcept { return bus; }
+
+    private:
+        ParameterChangeBus& bus;
+        JUCE_DECLARE_NON_COPYABLE (Owner)
+    };
+
+    /** Returns the shared bus parameters post to, or nullptr if there is no
+        Owner.
+     */
+    static ParameterChangeBus* getCurrent() noexcept;
+
+    /** Queue a changed parameter. Returns false if the queue is full. Call
+        only when the parameter isn't already queued, the caller owns that
+        flag.
+     */
+    bool post (Parameter& param) noexcept;
+
+    /** Notify listeners of every queued parameter. Returns the number of
+        parameters. Message thread only.
+     */
+    int dispatch();
+
+    /** Dispatch at display rate while there are clients. Message thread only. */
+    void addClient();
+    void removeClient();
+
+    /** Returns the number of dispatches so far. */
+    int getNumDispatches() const noexcept { return numDispatches; }
+
+private:
+    MpscQueue<Parameter*> queue;
+    int numClients = 0;
+    int numDispatches = 0;
+
+    class Dispatcher;
+    std::unique_ptr<Dispatcher> dispatcher;
+
+    void release();
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterChangeBus)
+};
+
+} // namespace element
@@ -78,18 +78,10 @@ bool PortBuffer::addEvent (int64 frames, uint32 size, uint32 bodyType, const uin
 {
     if (isSequence())
     {
-        if (sizeof (LV2_Atom) + buffer.atom->size + lv2_atom_pad_size (size) > capacity)
+        auto* const body = prepareEvent (frames, size, bodyType);
+        if (body == nullptr)
             return false;
-
-        LV2_Atom_Sequence* seq = (LV2_Atom_Sequence*) buffer.atom;
-        LV2_Atom_Event* ev = (LV2_Atom_Event*) ((uint8*) seq + lv2_atom_total_size (&seq->atom));
-
-        ev->time.frames = frames;
-        ev->body.size = size;
-        ev->body.type = bodyType;
-        memcpy (ev + 1, data, size);
-
-        buffer.atom->size += sizeof (LV2_Atom_Event) + lv2_atom_pad_size (size);
+        memcpy (body + 1, data, size);
         return true;
     }
     else if (isEvent())
@@ -112,6 +104,22 @@ bool PortBuffer::addEvent (int64 frames, uint32 size, uint32 bodyType, const uin
     return false;
 }
 
+LV2_Atom* PortBuffer::prepareEvent (int64 frames, uint32 size, uint32 bodyType) noexcept
+{
+    jassert (isSequence());
+    const auto used = lv2_atom_total_size (buffer.atom);
+    const auto eventSize = static_cast<uint32> (sizeof (LV2_Atom_Event)) + lv2_atom_pad_size (size);
+    if (used + eventSize > capacity)
+        return nullptr;
+
+    auto* const ev = (LV2_Atom_Event*) ((uint8*) buffer.atom + used);
+    ev->time.frames = frames;
+    ev->body.size = size;
+    ev->body.type = bodyType;
+    buffer.atom->size += eventSize;
+    return &ev->body;
+}
+
 void PortBuffer::clear()
 {
     if (isAudio() || isControl())
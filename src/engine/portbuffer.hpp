@@ -26,6 +26,12 @@ public:
 
     bool addEvent (int64 frames, uint32 size, uint32 type, const uint8* data);
 
+    /** Append an event to an atom sequence without copying a body.
+        Returns the event's atom with size and type set, the caller writes
+        size bytes after it.  Returns nullptr if the sequence is full.
+     */
+    LV2_Atom* prepareEvent (int64 frames, uint32 size, uint32 type) noexcept;
+
     inline uint32 getCapacity() const { return capacity; }
     void* getPortData() const;
 
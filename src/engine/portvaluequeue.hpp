@@ -0,0 +1,100 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <element/juce/core.hpp>
+
+#include "engine/mpscqueue.hpp"
+
+namespace element {
+
+/** A lock-free queue of control port values which keeps only the latest
+    value of each port.
+
+    Every port has a fixed slot.  Pushing a value overwrites the slot and
+    queues the port index only if it isn't already queued, so a stream of
+    writes to one port between two pops costs one entry and the reader sees
+    only the newest value.  The index queue holds every port at once, so a
+    push never fails for a valid port.
+
+    Any number of threads may push, e.g. the UI and the audio thread both
+    writing a plugin's controls.  One thread pops.
+ */
+class PortValueQueue final
+{
+public:
+    explicit PortValueQueue (int numPorts = 0) { resize (numPorts); }
+
+    /** Set the number of ports and clear the queue. Not realtime safe. */
+    void resize (int numPorts)
+    {
+        size = (uint32_t) juce::jmax (0, numPorts);
+        slots.reset (new Slot[size + 1]);
+        indexes = std::make_unique<MpscQueue<uint32_t>> ((int) size + 1);
+        numQueued.store (0);
+    }
+
+    /** Returns the number of ports. */
+    int getNumPorts() const noexcept { return (int) size; }
+
+    /** Set the value of a port. Returns false if the port is out of range. */
+    bool push (uint32_t port, float value) noexcept
+    {
+        if (port >= size)
+            return false;
+
+        auto& slot = slots[port];
+        slot.value.store (value, std::memory_order_relaxed);
+        if (! slot.pending.exchange (true))
+        {
+            // pending is set once per pop, so the queue can't be full
+            numQueued.fetch_add (1);
+            indexes->push (port);
+        }
+        return true;
+    }
+
+    /** Call fn (uint32_t port, float value) for every port with a new value.
+        Returns the number of ports.
+     */
+    template <typename Fn>
+    int pop (Fn&& fn)
+    {
+        // ports pushed again while popping wait for the next call
+        int count = 0;
+        uint32_t port = 0;
+        while (count < (int) size && indexes->pop (port))
+        {
+            numQueued.fetch_sub (1);
+            auto& slot = slots[port];
+            // clear first: a value pushed after this is queued again
+            slot.pending.exchange (false);
+            fn (port, slot.value.load (std::memory_order_relaxed));
+            ++count;
+        }
+        return count;
+    }
+
+    /** Returns true if no port has a new value. */
+    bool isEmpty() const noexcept { return numQueued.load() <= 0; }
+
+private:
+    struct Slot
+    {
+        std::atomic<float> value { 0.f };
+        std::atomic<bool> pending { false };
+    };
+
+    uint32_t size = 0;
+    std::unique_ptr<Slot[]> slots;
+    std::unique_ptr<MpscQueue<uint32_t>> indexes;
+    std::atomic<int> numQueued { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (PortValueQueue)
+};
+
+} // namespace element
@@ -234,6 +234,15 @@ void Processor::suspendProcessing (const bool shouldBeSuspended)
         bypassChanged (this);
 }
 
+void Processor::setSuspendedAt (bool shouldBeSuspended, int frame) noexcept
+{
+    if (isSuspended() == shouldBeSuspended)
+        return;
+    bypassed.set (shouldBeSuspended ? 1 : 0);
+    bypassFrame.set (jmax (0, frame));
+    bypassScheduled.set (1);
+}
+
 bool Processor::isGraph() const noexcept { return isA<GraphNode>(); }
 bool Processor::isRootGraph() const noexcept { return isA<RootGraph>(); }
 bool Processor::isSubGraph() const noexcept { return isGraph() && ! isRootGraph(); }
@@ -696,6 +705,30 @@ void Processor::setMuted (bool muted)
         muteChanged (this);
 }
 
+void Processor::setMutedAt (bool shouldBeMuted, int frame) noexcept
+{
+    if (isMuted() == shouldBeMuted)
+        return;
+    mute.set (shouldBeMuted ? 1 : 0);
+    muteFrame.set (jmax (0, frame));
+    muteScheduled.set (1);
+}
+
+void Processor::notifyScheduledChanges()
+{
+    if (bypassScheduled.exchange (0) == 1)
+    {
+        // keep a wrapped processor's own flag in step
+        if (auto* proc = getAudioProcessor())
+            if (proc->isSuspended() != isSuspended())
+                proc->suspendProcessing (isSuspended());
+        bypassChanged (this);
+    }
+
+    if (muteScheduled.exchange (0) == 1)
+        muteChanged (this);
+}
+
 //==============================================================================
 dsp::Oversampling<float>* Processor::getOversamplingProcessor()
 {
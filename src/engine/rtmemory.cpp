@@ -0,0 +1,126 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include "engine/rtmemory.hpp"
+
+#if JUCE_LINUX
+#include <alloca.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace element {
+
+// warn when fewer bytes than this can be locked
+static constexpr juce::uint64 minimumLockableBytes = 256 * 1024 * 1024;
+// most audio thread stack to touch, host threads can have small stacks
+static constexpr size_t stackPrefaultBytes = 64 * 1024;
+
+static std::atomic<bool> memoryLocked { false };
+
+bool RealtimeMemory::lockAll()
+{
+#if JUCE_LINUX
+    if (memoryLocked.load())
+        return true;
+
+    // with a low limit MCL_FUTURE would make later allocations fail once
+    // the limit is reached, so only lock what is mapped now.
+    int flags = MCL_CURRENT | MCL_FUTURE;
+    rlimit limit {};
+    if (getrlimit (RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY
+        && (juce::uint64) limit.rlim_cur < minimumLockableBytes)
+    {
+        flags = MCL_CURRENT;
+        juce::String msg ("[element] RT memory: RLIMIT_MEMLOCK is ");
+        msg << juce::File::descriptionOfSizeInBytes ((juce::int64) limit.rlim_cur)
+            << ", at least " << juce::File::descriptionOfSizeInBytes ((juce::int64) minimumLockableBytes)
+            << " is recommended. Raise memlock in /etc/security/limits.conf."
+            << " Only current pages will be locked";
+        juce::Logger::writeToLog (msg);
+    }
+
+    if (mlockall (flags) != 0)
+    {
+        juce::Logger::writeToLog ("[element] RT memory: mlockall failed: "
+                                  + juce::String (strerror (errno)));
+        return false;
+    }
+
+    memoryLocked = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RealtimeMemory::unlockAll()
+{
+#if JUCE_LINUX
+    if (memoryLocked.exchange (false))
+        munlockall();
+#endif
+}
+
+bool RealtimeMemory::isLocked() noexcept { return memoryLocked.load(); }
+
+void RealtimeMemory::prefault (void* data, size_t numBytes) noexcept
+{
+#if JUCE_LINUX
+    if (data == nullptr || numBytes == 0)
+        return;
+
+    static const size_t pageSize = (size_t) sysconf (_SC_PAGESIZE);
+    auto* bytes = static_cast<volatile juce::uint8*> (data);
+    for (size_t i = 0; i < numBytes; i += pageSize)
+        bytes[i] = bytes[i];
+    bytes[numBytes - 1] = bytes[numBytes - 1];
+#else
+    juce::ignoreUnused (data, numBytes);
+#endif
+}
+
+void RealtimeMemory::prefaultStack() noexcept
+{
+#if JUCE_LINUX
+    // stay within half of the stack left below this frame
+    size_t numBytes = stackPrefaultBytes;
+    pthread_attr_t attr;
+    if (pthread_getattr_np (pthread_self(), &attr) == 0)
+    {
+        void* stackAddress = nullptr;
+        size_t stackSize = 0;
+        if (pthread_attr_getstack (&attr, &stackAddress, &stackSize) == 0 && stackAddress != nullptr)
+        {
+            const auto here = reinterpret_cast<juce::pointer_sized_uint> (&numBytes);
+            const auto bottom = reinterpret_cast<juce::pointer_sized_uint> (stackAddress);
+            numBytes = here > bottom ? juce::jmin (numBytes, (size_t) (here - bottom) / 2) : 0;
+        }
+        pthread_attr_destroy (&attr);
+    }
+
+    if (numBytes == 0)
+        return;
+    auto* stack = static_cast<volatile juce::uint8*> (alloca (numBytes));
+    for (size_t i = 0; i < numBytes; i += 1024)
+        stack[i] = 0;
+#endif
+}
+
+juce::int64 RealtimeMemory::getThreadPageFaults() noexcept
+{
+#if JUCE_LINUX && defined(RUSAGE_THREAD)
+    rusage usage {};
+    if (getrusage (RUSAGE_THREAD, &usage) == 0)
+        return (juce::int64) usage.ru_minflt + (juce::int64) usage.ru_majflt;
+#endif
+    return -1;
+}
+
+} // namespace element
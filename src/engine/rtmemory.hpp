@@ -0,0 +1,55 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <element/juce/audio_basics.hpp>
+
+namespace element {
+
+/** Helpers for keeping realtime memory resident.
+
+    On Linux this locks the process' pages with mlockall and touches buffers
+    so their first access doesn't page fault on the audio thread.  The
+    functions are no-ops elsewhere.
+ */
+struct RealtimeMemory final
+{
+    /** Lock all current and future pages in memory. If RLIMIT_MEMLOCK is
+        too low only current pages are locked and a warning is written to
+        the log, as is any failure to lock.
+        Returns true if the pages were locked.
+     */
+    static bool lockAll();
+
+    /** Undo lockAll(). */
+    static void unlockAll();
+
+    /** Returns true if lockAll() succeeded and memory is still locked. */
+    static bool isLocked() noexcept;
+
+    /** Touch every page of a block of memory without changing it. */
+    static void prefault (void* data, size_t numBytes) noexcept;
+
+    /** Touch every page of an audio buffer's channels. */
+    static void prefault (juce::AudioBuffer<float>& buffer) noexcept
+    {
+        for (int c = 0; c < buffer.getNumChannels(); ++c)
+            prefault (buffer.getWritePointer (c), sizeof (float) * (size_t) buffer.getNumSamples());
+    }
+
+    /** Touch up to 64 KB of the calling thread's stack, less if the thread
+        has little stack left. Call once from the audio thread.
+     */
+    static void prefaultStack() noexcept;
+
+    /** Returns the calling thread's total page faults (minor and major),
+        or -1 if not supported.
+     */
+    static juce::int64 getThreadPageFaults() noexcept;
+
+private:
+    RealtimeMemory() = delete;
+};
+
+} // namespace element
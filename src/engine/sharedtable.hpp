@@ -0,0 +1,72 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <element/juce/core.hpp>
+
+namespace element {
+
+/** An immutable table built on one thread and read on a realtime thread.
+
+    publish() swaps in a new table and deletes the old one after every
+    reader has let go of it.  Readers hold a ScopedReader while they use
+    the table, which costs two atomic increments and never blocks.
+
+    Readers count while they hold any table, old or new, so publish()
+    waits for a moment with no readers at all.  Any reader that starts
+    after the swap already sees the new table, so once the count drops to
+    zero nothing can still point at the old one.  Reads are short, so the
+    wait is too, but publish() is not realtime safe and must only be
+    called from one thread at a time.
+ */
+template <typename TableType>
+class SharedTable final
+{
+public:
+    SharedTable() = default;
+    ~SharedTable() { delete current.exchange (nullptr); }
+
+    /** Install a new table, or nullptr for none, and delete the old one once
+        no reader holds it. Blocks while readers are active.
+     */
+    void publish (std::unique_ptr<TableType> table)
+    {
+        std::unique_ptr<TableType> old (current.exchange (table.release()));
+        while (readers.load() > 0)
+            juce::Thread::yield();
+    }
+
+    /** Holds the current table for the lifetime of the reader. */
+    class ScopedReader final
+    {
+    public:
+        explicit ScopedReader (const SharedTable& t) noexcept
+            : owner (t)
+        {
+            owner.readers.fetch_add (1);
+            table = owner.current.load();
+        }
+
+        ~ScopedReader() { owner.readers.fetch_sub (1); }
+
+        /** Returns the table, or nullptr if none is published. */
+        const TableType* get() const noexcept { return table; }
+
+    private:
+        const SharedTable& owner;
+        const TableType* table = nullptr;
+        JUCE_DECLARE_NON_COPYABLE (ScopedReader)
+    };
+
+private:
+    std::atomic<TableType*> current { nullptr };
+    mutable std::atomic<int> readers { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (SharedTable)
+};
+
+} // namespace element
@@ -0,0 +1,195 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <array>
+#include <atomic>
+
+#if JUCE_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <element/settings.hpp>
+
+#include "engine/threadscheduler.hpp"
+
+namespace element {
+
+namespace detail {
+static std::array<std::atomic<int>, ThreadScheduler::numClasses> priorities {};
+static std::array<std::atomic<juce::uint64>, ThreadScheduler::numClasses> affinities {};
+static std::atomic<int> generation { 0 };
+} // namespace detail
+
+const char* ThreadScheduler::getClassSlug (Class threadClass) noexcept
+{
+    switch (threadClass)
+    {
+        case Audio:
+            return "audio";
+        case Worker:
+            return "worker";
+        case Disk:
+            return "disk";
+        case Network:
+            return "network";
+        case numClasses:
+            break;
+    }
+    return "";
+}
+
+juce::String ThreadScheduler::getClassName (Class threadClass)
+{
+    switch (threadClass)
+    {
+        case Audio:
+            return "Audio";
+        case Worker:
+            return "Plugin Workers";
+        case Disk:
+            return "Disk Streaming";
+        case Network:
+            return "Network";
+        case numClasses:
+            break;
+    }
+    return {};
+}
+
+void ThreadScheduler::setPolicy (Class threadClass, const Policy& policy) noexcept
+{
+    if (! juce::isPositiveAndBelow ((int) threadClass, (int) numClasses))
+        return;
+    const auto i = (size_t) threadClass;
+    if (detail::priorities[i].load() == policy.priority && detail::affinities[i].load() == policy.affinity)
+        return;
+    detail::priorities[i].store (policy.priority);
+    detail::affinities[i].store (policy.affinity);
+    detail::generation.fetch_add (1, std::memory_order_release);
+}
+
+ThreadScheduler::Policy ThreadScheduler::getPolicy (Class threadClass) noexcept
+{
+    Policy policy;
+    if (juce::isPositiveAndBelow ((int) threadClass, (int) numClasses))
+    {
+        policy.priority = detail::priorities[(size_t) threadClass].load();
+        policy.affinity = detail::affinities[(size_t) threadClass].load();
+    }
+    return policy;
+}
+
+void ThreadScheduler::applySettings (Settings& settings)
+{
+    for (int i = 0; i < numClasses; ++i)
+    {
+        const auto threadClass = static_cast<Class> (i);
+        Policy policy;
+        policy.priority = settings.getThreadPriority (getClassSlug (threadClass));
+        policy.affinity = parseCpuList (settings.getThreadAffinity (getClassSlug (threadClass)));
+        setPolicy (threadClass, policy);
+    }
+}
+
+bool ThreadScheduler::applyToCurrentThread (Class threadClass)
+{
+    const auto policy = getPolicy (threadClass);
+    bool result = true;
+
+#if JUCE_LINUX
+    // threads we made realtime go back to normal scheduling when the
+    // priority is cleared, others keep whatever their creator gave them.
+    static thread_local bool raisedPriority = false;
+    if (policy.priority > 0)
+    {
+        sched_param param {};
+        param.sched_priority = juce::jlimit (sched_get_priority_min (SCHED_FIFO),
+                                             sched_get_priority_max (SCHED_FIFO),
+                                             policy.priority);
+        const bool ok = pthread_setschedparam (pthread_self(), SCHED_FIFO, &param) == 0;
+        raisedPriority = raisedPriority || ok;
+        result = ok && result;
+    }
+    else if (raisedPriority)
+    {
+        sched_param param {};
+        param.sched_priority = 0;
+        const bool ok = pthread_setschedparam (pthread_self(), SCHED_OTHER, &param) == 0;
+        raisedPriority = ! ok;
+        result = ok && result;
+    }
+
+    // an empty mask restores every CPU so clearing the setting takes effect
+    cpu_set_t cpus;
+    CPU_ZERO (&cpus);
+    const int numCpus = juce::jmin (64, juce::SystemStats::getNumCpus());
+    for (int cpu = 0; cpu < numCpus; ++cpu)
+        if (policy.affinity == 0 || (policy.affinity & (juce::uint64 (1) << cpu)) != 0)
+            CPU_SET (cpu, &cpus);
+    result = pthread_setaffinity_np (pthread_self(), sizeof (cpus), &cpus) == 0 && result;
+#else
+    // as above an empty mask restores every CPU, JUCE masks only cover 32
+    const int numCpus = juce::jmin (32, juce::SystemStats::getNumCpus());
+    const auto allCpus = numCpus >= 32 ? ~juce::uint32 (0) : (juce::uint32 (1) << numCpus) - 1;
+    juce::Thread::setCurrentThreadAffinityMask (policy.affinity != 0 ? (juce::uint32) policy.affinity : allCpus);
+    result = policy.priority <= 0;
+#endif
+
+    return result;
+}
+
+void ThreadScheduler::updateCurrentThread (Class threadClass, int& appliedGeneration)
+{
+    const auto current = detail::generation.load (std::memory_order_acquire);
+    if (current == appliedGeneration)
+        return;
+
+    const bool firstTime = appliedGeneration < 0;
+    appliedGeneration = current;
+
+    // leave threads untouched until something has been configured
+    const auto policy = getPolicy (threadClass);
+    if (firstTime && policy.priority <= 0 && policy.affinity == 0)
+        return;
+
+    applyToCurrentThread (threadClass);
+}
+
+juce::uint64 ThreadScheduler::parseCpuList (const juce::String& cpus)
+{
+    juce::uint64 mask = 0;
+    for (const auto& token : juce::StringArray::fromTokens (cpus, ",", {}))
+    {
+        const auto range = token.trim();
+        if (range.isEmpty())
+            continue;
+
+        int first = range.upToFirstOccurrenceOf ("-", false, false).getIntValue();
+        int last = range.containsChar ('-') ? range.fromFirstOccurrenceOf ("-", false, false).getIntValue()
+                                            : first;
+        first = juce::jlimit (0, 63, first);
+        last = juce::jlimit (first, 63, last);
+        for (int cpu = first; cpu <= last; ++cpu)
+            mask |= juce::uint64 (1) << cpu;
+    }
+    return mask;
+}
+
+juce::String ThreadScheduler::toCpuList (juce::uint64 affinity)
+{
+    juce::StringArray ranges;
+    for (int cpu = 0; cpu < 64; ++cpu)
+    {
+        if ((affinity & (juce::uint64 (1) << cpu)) == 0)
+            continue;
+        int last = cpu;
+        while (last < 63 && (affinity & (juce::uint64 (1) << (last + 1))) != 0)
+            ++last;
+        ranges.add (last == cpu ? juce::String (cpu) : juce::String (cpu) + "-" + juce::String (last));
+        cpu = last;
+    }
+    return ranges.joinIntoString (",");
+}
+
+} // namespace element
@@ -0,0 +1,95 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <element/juce/core.hpp>
+
+namespace element {
+
+class Settings;
+
+/** Realtime scheduling and CPU affinity per class of engine thread.
+
+    Policies are global. Threads pick up changes by calling
+    updateCurrentThread() at a safe point in their loop, so changing a
+    policy never touches another thread directly.  Realtime priorities use
+    SCHED_FIFO and are only supported on Linux, affinity applies everywhere
+    the OS allows it.
+ */
+class ThreadScheduler final
+{
+public:
+    enum Class
+    {
+        Audio = 0, ///< The audio device callback.
+        Worker,    ///< LV2 work threads.
+        Disk,      ///< File streaming threads, e.g. the audio file player.
+        Network,   ///< OSC and other network helpers.
+        numClasses
+    };
+
+    struct Policy
+    {
+        /** SCHED_FIFO priority. 0 or less uses normal scheduling, threads
+            this raised go back to SCHED_OTHER.
+         */
+        int priority = 0;
+        /** Allowed CPUs, bit 0 is the first. 0 means any CPU. */
+        juce::uint64 affinity = 0;
+    };
+
+    /** Returns the settings slug for a thread class. e.g. "audio" */
+    static const char* getClassSlug (Class threadClass) noexcept;
+
+    /** Returns a human readable name for a thread class. */
+    static juce::String getClassName (Class threadClass);
+
+    /** Change the policy for a thread class. */
+    static void setPolicy (Class threadClass, const Policy& policy) noexcept;
+
+    /** Returns the policy for a thread class. */
+    static Policy getPolicy (Class threadClass) noexcept;
+
+    /** Load all policies from settings. */
+    static void applySettings (Settings& settings);
+
+    /** Apply a class policy to the calling thread. Returns false if the OS
+        refused, usually because of missing realtime permissions.
+     */
+    static bool applyToCurrentThread (Class threadClass);
+
+    /** Apply a class policy to the calling thread if it changed since the
+        last call.  Each thread keeps its own generation, initialize it to -1.
+     */
+    static void updateCurrentThread (Class threadClass, int& appliedGeneration);
+
+    /** Parses a CPU list like "2,3" or "0-1,4" to an affinity mask. */
+    static juce::uint64 parseCpuList (const juce::String& cpus);
+
+    /** Formats an affinity mask as a CPU list. */
+    static juce::String toCpuList (juce::uint64 affinity);
+
+    /** A time slice client that keeps a TimeSliceThread up to date with
+        the policy of a thread class.
+     */
+    class TimeSliceClient final : public juce::TimeSliceClient
+    {
+    public:
+        explicit TimeSliceClient (Class c) : threadClass (c) {}
+        int useTimeSlice() override
+        {
+            updateCurrentThread (threadClass, generation);
+            return 500;
+        }
+
+    private:
+        const Class threadClass;
+        int generation = -1;
+    };
+
+private:
+    ThreadScheduler() = delete;
+};
+
+} // namespace element
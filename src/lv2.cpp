@@ -23,6 +23,7 @@ JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Wdeprecated-declarations",
 
 #include <element/ui/nodeeditor.hpp>
 #include <element/nodefactory.hpp>
+#include "engine/graphnode.hpp"
 #include "engine/portbuffer.hpp"
 #include <element/juce/gui_basics.hpp>
 #include <element/juce/gui_extra.hpp>
@@ -276,13 +277,7 @@ public:
         wantsMidiMessages = midiPort != EL_INVALID_PORT;
         sendsMidiMessages = notifyPort != EL_INVALID_PORT;
 
-        setPorts (module->ports());
-        if (sendsMidiMessages && getNumPorts (PortType::Midi, false) <= 0)
-        {
-            auto newPorts = portList();
-            newPorts.add (PortType::Midi, newPorts.size(), 0, "element_midi_output", "MIDI Out", false);
-            setPorts (newPorts);
-        }
+        setPorts (createPorts());
 
         const ChannelConfig& channels (module->getChannelConfig());
         totalAudioIn = channels.getNumAtomInputs();
@@ -394,6 +389,12 @@ public:
 
         if (initialised)
         {
+            // fixed only when the engine promises it
+            const auto* const graph = getParentGraph();
+            const int osFactor = jmax (1, getOversamplingFactor());
+            const int fixedSize = graph != nullptr ? graph->getFixedBlockSize() * osFactor : 0;
+            const int nominalSize = graph != nullptr ? graph->getNominalBlockSize() * osFactor : 0;
+            module->setBlockLength (blockSize, fixedSize, nominalSize);
             module->setSampleRate (sampleRate);
             tempBuffer.setSize (std::max (1, std::max (totalAudioIn, totalAudioOut)), blockSize);
             module->activate();
@@ -410,6 +411,8 @@ public:
 
     bool wantsMidiPipe() const override { return true; }
 
+    void setPlayHead (AudioPlayHead* newPlayHead) override { playhead.store (newPlayHead); }
+
     void renderBypassed (AudioSampleBuffer& a, MidiPipe& m, AudioSampleBuffer& cv) override
     {
         Processor::renderBypassed (a, m, cv);
@@ -427,17 +430,32 @@ public:
             return;
         }
 
-        if (wantsMidiMessages)
-        {
-            PortBuffer* const buf = module->getPortBuffer (midiPort);
-            buf->reset();
+        module->resetInputEvents();
 
-            for (auto m : *midi.getReadBuffer (0))
+        if (module->hasTimeInputs())
+            if (auto* const ph = playhead.load (std::memory_order_relaxed))
+                if (const auto pos = ph->getPosition())
+                    module->writeTimePosition (*pos, (uint32) numSamples);
+
+        const int numMidiIn = jmin (midiInputs.size(), midi.getNumBuffers());
+        for (int c = 0; c < numMidiIn; ++c)
+        {
+            auto* const buf = midiInputs.getUnchecked (c);
+            if (buf->isSequence())
             {
-                buf->addEvent (m.samplePosition,
-                               static_cast<uint32_t> (m.numBytes),
-                               midiEvent,
-                               m.data);
+                for (const auto m : *midi.getReadBuffer (c))
+                {
+                    const auto size = static_cast<uint32> (m.numBytes);
+                    auto* const body = buf->prepareEvent (m.samplePosition, size, midiEvent);
+                    if (body == nullptr)
+                        break;
+                    memcpy (body + 1, m.data, size);
+                }
+            }
+            else
+            {
+                for (const auto m : *midi.getReadBuffer (c))
+                    buf->addEvent (m.samplePosition, static_cast<uint32> (m.numBytes), midiEvent, m.data);
             }
         }
 
@@ -445,20 +463,16 @@ public:
         module->run ((uint32) numSamples);
 
         midi.clear();
-        if (sendsMidiMessages)
+        const int numMidiOut = jmin (midiOutputs.size(), midi.getNumBuffers());
+        for (int c = 0; c < numMidiOut; ++c)
         {
-            PortBuffer* const buf = module->getPortBuffer (notifyPort);
-            jassert (buf != nullptr);
+            auto* const seq = (const LV2_Atom_Sequence*) midiOutputs.getUnchecked (c)->getPortData();
+            auto* const out = midi.getWriteBuffer (c);
 
-            LV2_ATOM_SEQUENCE_FOREACH ((LV2_Atom_Sequence*) buf->getPortData(), ev)
+            LV2_ATOM_SEQUENCE_FOREACH (seq, ev)
             {
                 if (ev->body.type == midiEvent)
-                {
-                    midi.getWriteBuffer (0)->addEvent (
-                        LV2_ATOM_BODY_CONST (&ev->body),
-                        ev->body.size,
-                        (int) ev->time.frames);
-                }
+                    out->addEvent (LV2_ATOM_BODY_CONST (&ev->body), (int) ev->body.size, (int) ev->time.frames);
             }
         }
     }
@@ -475,12 +489,17 @@ public:
     //==============================================================================
     void getState (MemoryBlock& mb) override
     {
-        const auto state = module->getStateString();
-        mb.append (state.toRawUTF8(), state.length());
+        module->setStateDirectory (getStateDirectory());
+        module->getState (mb);
     }
 
     void setState (const void* data, int size) override
     {
+        module->setStateDirectory (getStateDirectory());
+        if (module->setState (data, (size_t) size))
+            return;
+
+        // Turtle from older sessions
         MemoryInputStream stream (data, (size_t) size, false);
         module->setStateString (stream.readEntireStreamAsString());
     }
@@ -495,6 +514,57 @@ public:
     }
 
 private:
+    /** The plugin's ports plus a MIDI port for every atom sequence port.
+
+        MIDI channel n of each direction is the plugin's nth sequence port.
+        The plugin's MIDI ports come first, so channel 0 is the port a single
+        MIDI port plugin would use.  The first input and output MIDI ports
+        keep the indexes earlier versions gave them, so saved connections
+        still apply.
+     */
+    PortList createPorts()
+    {
+        auto result = module->ports();
+        Array<uint32> ins, outs;
+
+        for (uint32 p = 0; p < numPorts; ++p)
+        {
+            const auto type = module->getPortType (p);
+            const bool input = module->isPortInput (p);
+            if (type == PortType::Atom || (input && p == midiPort))
+                (input ? ins : outs).add (p);
+        }
+
+        if (midiPort != EL_INVALID_PORT)
+            ins.move (ins.indexOf (midiPort), 0);
+        if (notifyPort != EL_INVALID_PORT)
+            outs.move (outs.indexOf (notifyPort), 0);
+
+        const auto addMidiPort = [this, &result] (uint32 port, int channel, bool input) {
+            const auto index = result.size();
+            if (channel == 0)
+                result.add (PortType::Midi, index, 0, input ? "element_midi_input" : "element_midi_output", input ? "MIDI In" : "MIDI Out", input);
+            else
+                result.add (PortType::Midi, index, channel, "element_midi_" + module->ports().getPort ((int) port).symbol, module->getPortName (port), input);
+            (input ? midiInputs : midiOutputs).add (module->getPortBuffer (port));
+        };
+
+        // channel 0 of each direction first, see above
+        if (ins.isEmpty())
+            result.add (PortType::Midi, result.size(), 0, "element_midi_input", "MIDI In", true);
+        else
+            addMidiPort (ins.getFirst(), 0, true);
+        if (! outs.isEmpty())
+            addMidiPort (outs.getFirst(), 0, false);
+
+        for (int c = 1; c < ins.size(); ++c)
+            addMidiPort (ins.getUnchecked (c), c, true);
+        for (int c = 1; c < outs.size(); ++c)
+            addMidiPort (outs.getUnchecked (c), c, false);
+
+        return result;
+    }
+
     CriticalSection lock, midiInLock;
     bool wantsMidiMessages, sendsMidiMessages,
         initialised, isPowerOn;
@@ -503,6 +573,8 @@ private:
     AudioSampleBuffer tempBuffer;
     std::unique_ptr<LV2Module> module;
     OwnedArray<PortBuffer> buffers;
+    Array<PortBuffer*> midiInputs, midiOutputs; ///< sequence port per MIDI channel
+    std::atomic<AudioPlayHead*> playhead { nullptr };
 
     uint32 numPorts { 0 };
     uint32 midiPort { EL_INVALID_PORT };
@@ -800,7 +872,10 @@ public:
 
     void getTypes (StringArray& tps)
     {
-        world->getSupportedPlugins (tps);
+        // the first call is at startup, trust the saved index there and
+        // check bundles for changes on later scans.
+        world->getSupportedPlugins (tps, indexChecked);
+        indexChecked = true;
     }
 
     LV2Processor* instantiate (const String& uri)
@@ -835,6 +910,7 @@ private:
     friend class LV2NodeProvider;
     LV2NodeProvider& provider;
     std::unique_ptr<World> world;
+    bool indexChecked = false;
 };
 
 LV2NodeProvider::LV2NodeProvider()
@@ -1,13 +1,21 @@
 // Copyright 2014-2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include <lv2/atom/forge.h>
+#include <lv2/atom/util.h>
+#include <lv2/buf-size/buf-size.h>
+#include <lv2/options/options.h>
+#include <lv2/time/time.h>
 #include <lv2/ui/ui.h>
 #include <lvtk/ext/idle.hpp>
 #include <lv2/midi/midi.h>
 #include <lvtk/ext/state.hpp>
 
+#include <element/datapath.hpp>
+
 #include "engine/portbuffer.hpp"
 #include "lv2/module.hpp"
+#include "lv2/statestore.hpp"
 #include "lv2/workerfeature.hpp"
 
 namespace element {
@@ -82,6 +90,7 @@ public:
                 continue;
 
             auto* const buffer = buffers.getUnchecked (port->index);
+            owner.notifiedValues[port->index] = buffer->getValue();
 
             if (ui)
             {
@@ -93,18 +102,17 @@ public:
         }
     }
 
+    /** Returns the index of a control port by symbol, or -1 */
+    int findControlPort (const char* symbol) const
+    {
+        const int index = symbols[String::fromUTF8 (symbol)];
+        return index > 0 && buffers.getUnchecked (index - 1)->isControl() ? index - 1 : -1;
+    }
+
     static const void* getPortValue (const char* port_symbol, void* user_data, uint32_t* size, uint32_t* type)
     {
         LV2Module::Private* priv = static_cast<LV2Module::Private*> (user_data);
-        int portIdx = -1;
-        for (const auto* port : priv->ports.getPorts())
-        {
-            if (port->symbol == port_symbol && port->type == PortType::Control)
-            {
-                portIdx = port->index;
-                break;
-            }
-        }
+        const int portIdx = priv->findControlPort (port_symbol);
 
         if (portIdx >= 0)
         {
@@ -129,28 +137,35 @@ public:
                               uint32_t type)
     {
         auto* priv = (Private*) user_data;
-        auto& plugin = priv->owner;
-        lvtk::ignore (plugin);
-        if (type != priv->owner.map (LV2_ATOM__Float))
+        if (type != priv->owner.map (LV2_ATOM__Float) || size != sizeof (float))
             return;
 
-        int portIdx = -1;
-        const PortDescription* port = nullptr;
-        for (const auto* p : priv->ports.getPorts())
+        const int portIdx = priv->findControlPort (port_symbol);
+        if (portIdx >= 0)
         {
-            port = p;
-            if (port->symbol == port_symbol && port->type == PortType::Control)
-            {
-                portIdx = port->index;
-                break;
-            }
+            if (auto* const buffer = priv->buffers[portIdx])
+                buffer->setValue (*((const float*) value));
         }
+    }
 
-        if (portIdx >= 0 && port)
+    //==========================================================================
+    /** Returns the store binary state saves plugin properties through. */
+    LV2StateStore& getStateStore()
+    {
+        if (stateStore == nullptr)
         {
-            if (auto* const buffer = priv->buffers[portIdx])
-                buffer->setValue (*((float*) value));
+            auto& features = owner.getWorld().getFeatures();
+            auto* const map = (LV2_URID_Map*) features.getFeature (LV2_URID__map)->getFeature()->data;
+            auto* const unmap = (LV2_URID_Unmap*) features.getFeature (LV2_URID__unmap)->getFeature()->data;
+            // files plugins make go in the instance's own directory
+            const auto dir = stateDirectory != File()
+                                 ? stateDirectory
+                                 : DataPath::applicationDataDir().getChildFile ("LV2State").getChildFile (Uuid().toString());
+            stateDirectory = dir;
+            stateStore = std::make_unique<LV2StateStore> (*map, *unmap, dir);
         }
+
+        return *stateStore;
     }
 
 private:
@@ -167,6 +182,74 @@ private:
 
     HeapBlock<float> mins, maxes, defaults;
     OwnedArray<PortBuffer> buffers;
+    HashMap<String, int> symbols; ///< port index + 1 by symbol
+    std::unique_ptr<LV2StateStore> stateStore; ///< plugin properties while saving or restoring
+    File stateDirectory;                       ///< see LV2Module::setStateDirectory
+
+    // Port connection state, see LV2Module::run
+    Array<uint32> referredPorts; ///< audio and CV, may point elsewhere every block
+    Array<uint32> sequenceOutputs; ///< atom outputs, reset before every run
+    Array<uint32> eventInputs; ///< atom and event inputs, see resetInputEvents
+    HeapBlock<void*> connections; ///< data last connected per port
+    bool connectAllPending { true };
+
+    void connectAll()
+    {
+        for (int p = 0; p < buffers.size(); ++p)
+            owner.connectPort (static_cast<uint32> (p), buffers.getUnchecked (p)->getPortData());
+        connectAllPending = false;
+    }
+
+    // Block lengths given to the next instance, see LV2Module::setBlockLength
+    int minBlockLength { 1 };
+    int maxBlockLength { 8192 };
+    int nominalBlockLength { 0 }; ///< the device's block size, 0 if unknown
+    int fixedBlockLength { 0 };
+    bool blockLengthPending { false };
+    LV2_Options_Option blockOptions[4];
+    LV2_Feature optionsFeature { LV2_OPTIONS__options, blockOptions };
+    LV2_Feature fixedBlockLengthFeature { LV2_BUF_SIZE__fixedBlockLength, nullptr };
+    LV2_Feature powerOf2BlockLengthFeature { LV2_BUF_SIZE__powerOf2BlockLength, nullptr };
+
+    void updateBlockOptions()
+    {
+        const auto intType = owner.map (LV2_ATOM__Int);
+        const int* const minValue = fixedBlockLength > 0 ? &fixedBlockLength : &minBlockLength;
+        const int* const nominalValue = fixedBlockLength > 0 ? &fixedBlockLength
+                                        : nominalBlockLength > 0 ? &nominalBlockLength
+                                                                 : &maxBlockLength;
+        blockOptions[0] = { LV2_OPTIONS_INSTANCE, 0, owner.map (LV2_BUF_SIZE__minBlockLength), sizeof (int), intType, minValue };
+        blockOptions[1] = { LV2_OPTIONS_INSTANCE, 0, owner.map (LV2_BUF_SIZE__maxBlockLength), sizeof (int), intType, &maxBlockLength };
+        blockOptions[2] = { LV2_OPTIONS_INSTANCE, 0, owner.map (LV2_BUF_SIZE__nominalBlockLength), sizeof (int), intType, nominalValue };
+        blockOptions[3] = { LV2_OPTIONS_BLANK, 0, 0, 0, 0, nullptr };
+    }
+
+    /** Give a running instance a new nominal length, through its options
+        interface if it has one.  Others get it when next instantiated.
+     */
+    void publishNominalBlockLength()
+    {
+        updateBlockOptions();
+        if (auto* iface = (const LV2_Options_Interface*) owner.getExtensionData (LV2_OPTIONS__interface))
+            if (iface->set != nullptr)
+                iface->set (owner.getHandle(), blockOptions + 2);
+    }
+
+    // Transport, see LV2Module::writeTimePosition
+    Array<uint32> timeInputs; ///< atom inputs which support time:Position
+    LV2_Atom_Forge forge;
+    struct TimeURIDs
+    {
+        LV2_URID Position, frame, speed, bar, barBeat, beatUnit, beatsPerBar, beatsPerMinute;
+    } time;
+
+    struct TimeState
+    {
+        bool valid = false;
+        int64 nextFrame = 0;
+        float speed = 0.f, beatsPerMinute = 0.f;
+        int beatsPerBar = 0, beatUnit = 0;
+    } lastTime;
 
     LV2_Feature instanceFeature { LV2_INSTANCE_ACCESS_URI, nullptr };
 };
@@ -198,19 +281,31 @@ void LV2Module::activatePorts()
 void LV2Module::init()
 {
     events.reset (new RingBuffer (EL_LV2_RING_BUFFER_SIZE));
-    evbufsize = jmax (evbufsize, static_cast<uint32> (EL_LV2_RING_BUFFER_SIZE));
-    evbuf.realloc (evbufsize);
-    evbuf.clear (evbufsize);
-
     notifications.reset (new RingBuffer (EL_LV2_RING_BUFFER_SIZE));
-    ntbufsize = jmax (ntbufsize, static_cast<uint32> (EL_LV2_RING_BUFFER_SIZE));
-    ntbuf.realloc (ntbufsize);
-    ntbuf.clear (ntbufsize);
+    ntbuf.realloc (EL_LV2_RING_BUFFER_SIZE);
+    eventTransfer = map (LV2_ATOM__eventTransfer);
+    midiEvent = map (LV2_MIDI__MidiEvent);
+
+    auto* const uridMap = (LV2_URID_Map*) world.getFeatures().getFeature (LV2_URID__map)->getFeature()->data;
+    lv2_atom_forge_init (&priv->forge, uridMap);
+    priv->time = { map (LV2_TIME__Position),
+                   map (LV2_TIME__frame),
+                   map (LV2_TIME__speed),
+                   map (LV2_TIME__bar),
+                   map (LV2_TIME__barBeat),
+                   map (LV2_TIME__beatUnit),
+                   map (LV2_TIME__beatsPerBar),
+                   map (LV2_TIME__beatsPerMinute) };
+
+    controlChanges.resize ((int) numPorts);
+    controlNotifications.resize ((int) numPorts);
+    notifiedValues.allocate (numPorts, true);
 
     // create and set default port values
     priv->mins.allocate (numPorts, true);
     priv->maxes.allocate (numPorts, true);
     priv->defaults.allocate (numPorts, true);
+    priv->connections.allocate (numPorts, true);
 
     lilv_plugin_get_port_ranges_float (plugin, priv->mins, priv->maxes, priv->defaults);
 
@@ -240,6 +335,7 @@ void LV2Module::init()
         const String symbol = lilv_node_as_string (lilv_port_get_symbol (plugin, port));
 
         priv->ports.add (type, p, priv->ports.size (type, isInput), symbol, name, isInput);
+        priv->symbols.set (symbol, (int) p + 1);
         priv->channels.addPort (type, p, isInput);
 
         uint32 capacity = sizeof (float);
@@ -276,7 +372,21 @@ void LV2Module::init()
             new PortBuffer (isInput, type, dataType, capacity));
 
         if (type == PortType::Control)
+        {
             buf->setValue (priv->defaults[p]);
+            notifiedValues[p] = priv->defaults[p];
+        }
+
+        if (type == PortType::Audio || type == PortType::CV)
+            priv->referredPorts.add (p);
+        else if (type == PortType::Atom && ! isInput)
+            priv->sequenceOutputs.add (p);
+
+        if (isInput && (type == PortType::Atom || type == PortType::Event))
+            priv->eventInputs.add (p);
+
+        if (isInput && type == PortType::Atom && lilv_port_supports_event (plugin, port, world.time_Position))
+            priv->timeInputs.add (p);
     }
 
     // // load related GUIs
@@ -371,6 +481,94 @@ void LV2Module::setStateString (const String& stateStr)
     }
 }
 
+//==============================================================================
+// Binary state:
+//   magic, version
+//   port count, then per input control port: symbol, value
+//   property count, then per property: key URI, type URI, flags, size, bytes
+static constexpr int binaryStateMagic = 0x53324c45; // "EL2S"
+static constexpr int binaryStateVersion = 1;
+
+bool LV2Module::isBinaryState (const void* data, size_t size)
+{
+    return size >= 8 && ByteOrder::littleEndianInt (data) == (uint32) binaryStateMagic;
+}
+
+void LV2Module::getState (MemoryBlock& block) const
+{
+    MemoryOutputStream out (block, false);
+    out.writeInt (binaryStateMagic);
+    out.writeInt (binaryStateVersion);
+
+    int numControls = 0;
+    for (const auto* port : priv->ports.getPorts())
+        if (port->type == PortType::Control && port->input)
+            ++numControls;
+
+    out.writeInt (numControls);
+    for (const auto* port : priv->ports.getPorts())
+    {
+        if (port->type != PortType::Control || ! port->input)
+            continue;
+        out.writeString (port->symbol);
+        out.writeFloat (priv->buffers.getUnchecked (port->index)->getValue());
+    }
+
+    auto& store = priv->getStateStore();
+    store.clear();
+    const auto* iface = (const LV2_State_Interface*) getExtensionData (LV2_STATE__interface);
+    if (instance != nullptr && iface != nullptr && iface->save != nullptr)
+    {
+        iface->save (lilv_instance_get_handle (instance), LV2StateStore::store, store.getHandle(),
+                     LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE, store.getFeatures());
+    }
+
+    store.write (out);
+    store.clear();
+}
+
+void LV2Module::setStateDirectory (const File& directory)
+{
+    if (directory == priv->stateDirectory)
+        return;
+    priv->stateDirectory = directory;
+    priv->stateStore.reset();
+}
+
+bool LV2Module::setState (const void* data, size_t size)
+{
+    if (instance == nullptr || ! isBinaryState (data, size))
+        return false;
+
+    MemoryInputStream in (data, size, false);
+    in.readInt();
+    if (in.readInt() != binaryStateVersion)
+        return false;
+
+    for (int i = jmax (0, in.readInt()); --i >= 0 && ! in.isExhausted();)
+    {
+        const auto symbol = in.readString();
+        const float value = in.readFloat();
+        const int port = priv->findControlPort (symbol.toRawUTF8());
+        if (port >= 0)
+            priv->buffers.getUnchecked (port)->setValue (value);
+    }
+
+    auto& store = priv->getStateStore();
+    store.read (in);
+
+    const auto* iface = (const LV2_State_Interface*) getExtensionData (LV2_STATE__interface);
+    if (iface != nullptr && iface->restore != nullptr && store.size() > 0)
+    {
+        iface->restore (lilv_instance_get_handle (instance), LV2StateStore::retrieve, store.getHandle(),
+                        LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE, store.getFeatures());
+    }
+
+    store.clear();
+    priv->sendControlValues();
+    return true;
+}
+
 Result LV2Module::instantiate (double samplerate)
 {
     freeInstance();
@@ -380,6 +578,20 @@ Result LV2Module::instantiate (double samplerate)
     features.clearQuick();
     world.getFeatures (features);
 
+    // block lengths are per instance
+    if (auto* const worldOptions = world.getFeatures().getFeature (LV2_OPTIONS__options))
+        features.removeFirstMatchingValue (worldOptions->getFeature());
+    priv->updateBlockOptions();
+    features.add (&priv->optionsFeature);
+    if (priv->fixedBlockLength > 0)
+    {
+        features.add (&priv->fixedBlockLengthFeature);
+        if (isPowerOfTwo (priv->fixedBlockLength))
+            features.add (&priv->powerOf2BlockLengthFeature);
+    }
+    priv->blockLengthPending = false;
+    priv->lastTime.valid = false;
+
     // check for a worker interface
     LilvNodes* nodes = lilv_plugin_get_extension_data (plugin);
     LILV_FOREACH (nodes, iter, nodes)
@@ -417,6 +629,10 @@ Result LV2Module::instantiate (double samplerate)
         worker = nullptr;
     }
 
+    // a new instance has nothing connected
+    priv->connections.clear (numPorts);
+    priv->connectAllPending = true;
+
     loadDefaultState();
     startTimerHz (60);
     return Result::ok();
@@ -469,22 +685,114 @@ void LV2Module::freeInstance()
 
 void LV2Module::setSampleRate (double newSampleRate)
 {
-    if (newSampleRate == currentSampleRate)
+    if (newSampleRate == currentSampleRate && ! priv->blockLengthPending)
         return;
 
     if (instance != nullptr)
     {
+        // the plugin's state survives the new instance
+        MemoryBlock state;
+        getState (state);
+
         const bool wasActive = isActive();
         freeInstance();
-        instantiate (newSampleRate);
+        if (! instantiate (newSampleRate).wasOk())
+            return;
 
         jassert (currentSampleRate == newSampleRate);
+        setState (state.getData(), state.getSize());
 
         if (wasActive)
             activate();
     }
 }
 
+void LV2Module::setBlockLength (int maxLength, int fixedLength, int nominalLength)
+{
+    maxLength = jmax (1, maxLength);
+    fixedLength = jlimit (0, maxLength, fixedLength);
+    nominalLength = jlimit (0, maxLength, nominalLength);
+    if (maxLength == priv->maxBlockLength && fixedLength == priv->fixedBlockLength)
+    {
+        if (nominalLength != priv->nominalBlockLength)
+        {
+            priv->nominalBlockLength = nominalLength;
+            if (fixedLength == 0)
+                priv->publishNominalBlockLength();
+        }
+        return;
+    }
+
+    priv->nominalBlockLength = nominalLength;
+    priv->maxBlockLength = maxLength;
+    priv->fixedBlockLength = fixedLength;
+    priv->blockLengthPending = true;
+}
+
+void LV2Module::writeTimePosition (const AudioPlayHead::PositionInfo& pos, uint32 nframes)
+{
+    if (priv->timeInputs.isEmpty())
+        return;
+
+    const auto frame = pos.getTimeInSamples().orFallback (0);
+    const float speed = pos.getIsPlaying() ? 1.f : 0.f;
+    const auto bpm = (float) pos.getBpm().orFallback (120.0);
+    const auto sig = pos.getTimeSignature().orFallback (AudioPlayHead::TimeSignature());
+
+    // plugins follow the transport themselves between changes
+    auto& last = priv->lastTime;
+    const bool changed = ! last.valid || frame != last.nextFrame || speed != last.speed
+                         || bpm != last.beatsPerMinute || sig.numerator != last.beatsPerBar
+                         || sig.denominator != last.beatUnit;
+    last.valid = true;
+    last.nextFrame = frame + (speed > 0.f ? (int64) nframes : 0);
+    last.speed = speed;
+    last.beatsPerMinute = bpm;
+    last.beatsPerBar = sig.numerator;
+    last.beatUnit = sig.denominator;
+    if (! changed)
+        return;
+
+    alignas (LV2_Atom) uint8 buffer[256];
+    auto& forge = priv->forge;
+    const auto& t = priv->time;
+    lv2_atom_forge_set_buffer (&forge, buffer, sizeof (buffer));
+
+    LV2_Atom_Forge_Frame object;
+    lv2_atom_forge_object (&forge, &object, 0, t.Position);
+    lv2_atom_forge_key (&forge, t.frame);
+    lv2_atom_forge_long (&forge, frame);
+    lv2_atom_forge_key (&forge, t.speed);
+    lv2_atom_forge_float (&forge, speed);
+    lv2_atom_forge_key (&forge, t.beatsPerMinute);
+    lv2_atom_forge_float (&forge, bpm);
+    lv2_atom_forge_key (&forge, t.beatsPerBar);
+    lv2_atom_forge_float (&forge, (float) sig.numerator);
+    lv2_atom_forge_key (&forge, t.beatUnit);
+    lv2_atom_forge_int (&forge, sig.denominator);
+
+    if (const auto ppq = pos.getPpqPosition())
+    {
+        // ppq counts quarter notes, time:bar and time:barBeat count beat units
+        const double beats = *ppq * sig.denominator / 4.0;
+        const double beatsPerBar = (double) jmax (1, sig.numerator);
+        const auto bar = (int64) std::floor (beats / beatsPerBar);
+        lv2_atom_forge_key (&forge, t.bar);
+        lv2_atom_forge_long (&forge, bar);
+        lv2_atom_forge_key (&forge, t.barBeat);
+        lv2_atom_forge_float (&forge, (float) (beats - (double) bar * beatsPerBar));
+    }
+
+    lv2_atom_forge_pop (&forge, &object);
+
+    const auto* const atom = (const LV2_Atom*) buffer;
+    for (const auto port : priv->timeInputs)
+        if (auto* body = priv->buffers.getUnchecked ((int) port)->prepareEvent (0, atom->size, atom->type))
+            memcpy (body + 1, atom + 1, atom->size);
+}
+
+bool LV2Module::hasTimeInputs() const noexcept { return ! priv->timeInputs.isEmpty(); }
+
 void LV2Module::connectChannel (const PortType type, const int32 channel, void* data, const bool isInput)
 {
     connectPort (priv->channels.getPort (type, channel, isInput), data);
@@ -492,6 +800,8 @@ void LV2Module::connectChannel (const PortType type, const int32 channel, void*
 
 void LV2Module::connectPort (uint32 port, void* data)
 {
+    jassert (port < numPorts);
+    priv->connections[port] = data;
     lilv_instance_connect_port (instance, port, data);
 }
 
@@ -764,10 +1074,8 @@ PortBuffer* LV2Module::getPortBuffer (uint32 port) const
 
 uint32 LV2Module::getPortIndex (const String& symbol) const
 {
-    for (const auto* port : priv->ports.getPorts())
-        if (port->symbol == symbol)
-            return static_cast<uint32> (port->index);
-    return LV2UI_INVALID_PORT_INDEX;
+    const int index = priv->symbols[symbol];
+    return index > 0 ? static_cast<uint32> (index - 1) : LV2UI_INVALID_PORT_INDEX;
 }
 
 LV2ModuleUI* LV2Module::createEditor()
@@ -812,29 +1120,32 @@ bool LV2Module::isPortOutput (uint32 index) const
 
 void LV2Module::timerCallback()
 {
-    PortEvent ev;
+    controlNotifications.pop ([this] (uint32 port, float value) {
+        // the audio thread may report a value the UI already has
+        if (notifiedValues[port] == value)
+            return;
+        notifiedValues[port] = value;
 
-    static const uint32 pnsize = sizeof (PortEvent);
+        if (auto ui = priv->ui)
+            ui->portEvent (port, sizeof (float), 0, &value);
+        if (onPortNotify)
+            onPortNotify (port, sizeof (float), 0, &value);
+    });
 
-    for (;;)
+    static const uint32 pesize = sizeof (PortEvent);
+    PortEvent ev;
+    while (notifications->canRead (pesize))
     {
-        if (! notifications->canRead (pnsize))
-            break;
-
         notifications->read (ev, false);
-        if (ev.size > 0 && notifications->canRead (pnsize + ev.size))
-        {
-            notifications->advance (pnsize, false);
-            notifications->read (ntbuf, ev.size, true);
+        if (! notifications->canRead (pesize + ev.size))
+            break;
+        notifications->advance (pesize, false);
+        notifications->read (ntbuf, ev.size, true);
 
-            if (ev.protocol == 0)
-            {
-                if (auto ui = priv->ui)
-                    ui->portEvent (ev.index, ev.size, ev.protocol, ntbuf.getData());
-                if (onPortNotify)
-                    onPortNotify (ev.index, ev.size, ev.protocol, ntbuf.getData());
-            }
-        }
+        if (auto ui = priv->ui)
+            ui->portEvent (ev.index, ev.size, ev.protocol, ntbuf);
+        if (onPortNotify)
+            onPortNotify (ev.index, ev.size, ev.protocol, ntbuf);
     }
 }
 
@@ -863,54 +1174,109 @@ void LV2Module::referAudioReplacing (AudioSampleBuffer& audio, AudioSampleBuffer
             ->referTo (cv.getWritePointer (c));
 }
 
-void LV2Module::run (uint32 nframes)
+void LV2Module::resetInputEvents()
 {
-    PortEvent ev;
+    for (const auto port : priv->eventInputs)
+        priv->buffers.getUnchecked ((int) port)->reset();
 
     static const uint32 pesize = sizeof (PortEvent);
+    PortEvent ev;
+    LV2_Atom atom;
 
-    for (;;)
+    while (events->canRead (pesize))
     {
-        if (! events->canRead (pesize))
-            break;
         events->read (ev, false);
-        if (ev.size > 0 && events->canRead (pesize + ev.size))
+        if (! events->canRead (pesize + ev.size))
+            break;
+
+        events->advance (pesize, false);
+
+        auto* const buffer = ev.index < numPorts ? priv->buffers.getUnchecked ((int) ev.index) : nullptr;
+        LV2_Atom* body = nullptr;
+        if (buffer != nullptr && buffer->isInput() && buffer->isSequence()
+            && ev.protocol == eventTransfer && ev.size >= sizeof (LV2_Atom))
         {
-            events->advance (pesize, false);
-            events->read (evbuf, ev.size, true);
+            events->read (atom, false);
+            if (atom.size <= ev.size - (uint32) sizeof (LV2_Atom))
+                body = buffer->prepareEvent (0, atom.size, atom.type);
+        }
 
-            // DBG ("[element] lv2: read bytes: " << (int) ev.size);
+        if (body == nullptr)
+        {
+            events->advance (ev.size, false);
+            continue;
+        }
 
-            if (ev.protocol == 0)
-            {
-                auto* buffer = priv->buffers.getUnchecked (ev.index);
-                const float value = *((float*) evbuf.getData());
-                if (buffer->getValue() != value)
-                {
-                    buffer->setValue (value);
-                    if (notifications->canWrite (pesize + ev.size))
-                    {
-                        notifications->write (ev);
-                        notifications->write (evbuf.getData(), ev.size);
-                    }
-                }
-            }
+        // straight from the ring into the sequence
+        events->advance (sizeof (LV2_Atom), false);
+        events->read (body + 1, body->size, true);
+        events->advance (ev.size - (uint32) sizeof (LV2_Atom) - body->size, false);
+    }
+}
+
+void LV2Module::forwardOutputEvents()
+{
+    static const uint32 pesize = sizeof (PortEvent);
+    PortEvent ev;
+    zerostruct (ev);
+    ev.protocol = eventTransfer;
+
+    for (const auto port : priv->sequenceOutputs)
+    {
+        auto* const seq = (const LV2_Atom_Sequence*) priv->buffers.getUnchecked ((int) port)->getPortData();
+        LV2_ATOM_SEQUENCE_FOREACH (seq, aev)
+        {
+            // MIDI goes to the graph, everything else (patch:Set etc) to the UI
+            if (aev->body.type == midiEvent)
+                continue;
+
+            ev.index = port;
+            ev.size = lv2_atom_total_size (&aev->body);
+            if (! notifications->canWrite (pesize + ev.size))
+                return;
+            notifications->write (ev);
+            notifications->write (&aev->body, ev.size);
         }
     }
+}
+
+void LV2Module::run (uint32 nframes)
+{
+    controlChanges.pop ([this] (uint32 port, float value) {
+        auto* const buffer = priv->buffers.getUnchecked ((int) port);
+        if (! buffer->isControl() || buffer->getValue() == value)
+            return;
+        buffer->setValue (value);
+        controlNotifications.push (port, value);
+    });
 
-    for (int i = priv->buffers.size(); --i >= 0;)
+    // Control, atom and event ports use their own buffers which never move,
+    // so after the first run only audio and CV ports can need reconnecting.
+    if (priv->connectAllPending)
     {
-        auto buffer = priv->buffers.getUnchecked (i);
-        if (buffer->isSequence() && ! buffer->isInput())
-            buffer->reset();
-        connectPort (static_cast<uint32> (i), buffer->getPortData());
+        priv->connectAll();
     }
+    else
+    {
+        for (const auto port : priv->referredPorts)
+        {
+            auto* const data = priv->buffers.getUnchecked ((int) port)->getPortData();
+            if (data != priv->connections[port])
+                connectPort (port, data);
+        }
+    }
+
+    for (const auto port : priv->sequenceOutputs)
+        priv->buffers.getUnchecked ((int) port)->reset();
 
     if (worker)
         worker->processWorkResponses();
 
     lilv_instance_run (instance, nframes);
 
+    if (! priv->sequenceOutputs.isEmpty())
+        forwardOutputEvents();
+
     if (worker)
         worker->endRun();
 }
@@ -923,6 +1289,16 @@ uint32 LV2Module::map (const String& uri) const
 
 void LV2Module::write (uint32 port, uint32 size, uint32 protocol, const void* buffer)
 {
+    if (protocol == 0)
+    {
+        if (size == sizeof (float))
+            controlChanges.push (port, *(const float*) buffer);
+        return;
+    }
+
+    if (protocol != eventTransfer)
+        return;
+
     PortEvent event;
     zerostruct (event);
     event.index = port;
@@ -16,6 +16,7 @@
 #include <element/juce/core.hpp>
 #include <element/porttype.hpp>
 
+#include "engine/portvaluequeue.hpp"
 #include "ringbuffer.hpp"
 #include "lv2/portevent.hpp"
 #include "lv2/world.hpp"
@@ -195,10 +196,33 @@ public:
 
     /** Set the sample rate for this plugin
         @param newSampleRate The new rate to use
-        @note This will re-instantiate the plugin
+        @note This will re-instantiate the plugin, also if setBlockLength()
+              changed the block lengths. The plugin's state is kept.
      */
     void setSampleRate (double newSampleRate);
 
+    /** Set the block lengths the host promises, applied by the next
+        instantiate() or setSampleRate().
+        @param maxLength    The largest number of frames run() gets
+        @param fixedLength  If more than zero every run() gets exactly this
+                            many frames, and buf-size:fixedBlockLength (plus
+                            powerOf2BlockLength if it is one) is advertised
+        @param nominalLength The number of frames run() usually gets, e.g. the
+                            audio device's buffer size, 0 to use maxLength.
+                            A change alone is sent to a running instance
+                            through the options interface.
+     */
+    void setBlockLength (int maxLength, int fixedLength, int nominalLength = 0);
+
+    /** Returns true if an atom input accepts time:Position. */
+    bool hasTimeInputs() const noexcept;
+
+    /** Write a time:Position object to atom inputs that accept one, if the
+        transport's state differs from what the last call implied (realtime).
+        Call after resetInputEvents(), nframes is the length of this cycle.
+     */
+    void writeTimePosition (const AudioPlayHead::PositionInfo& pos, uint32 nframes);
+
     //=========================================================================
 
     /** Get the plugin's extension data
@@ -260,6 +284,12 @@ public:
       */
     void connectChannel (const PortType type, const int32 channel, void* data, const bool isInput);
 
+    /** Reset input event ports and write atom messages queued with write()
+        to them (realtime).  Call at the start of a cycle, before adding
+        host events to input ports and before run().
+     */
+    void resetInputEvents();
+
     /** Connect an audio buffer setup for in place processing (realtime)
         
         @param audio The buffer to use for audio ports.
@@ -283,10 +313,32 @@ public:
      */
     void setStateString (const String&);
 
+    /** Write port values and plugin properties in a compact binary form.
+        Much faster than getStateString(), which remains for export.
+     */
+    void getState (MemoryBlock&) const;
+
+    /** Restore state written by getState(). Returns false if the data
+        isn't binary state.
+     */
+    bool setState (const void* data, size_t size);
+
+    /** Set the directory files made with state:makePath go in, and which
+        saved paths are relative to.  Give every instance its own.
+     */
+    void setStateDirectory (const File& directory);
+
+    /** Returns true if the data was written by getState(). */
+    static bool isBinaryState (const void* data, size_t size);
+
     //=========================================================================
 
-    /** Write some data to a port
-        This will send a PortEvent to the audio thread
+    /** Write some data to a port.
+        Control values (protocol 0) are coalesced so run() only sees the
+        latest value of each port. Atom messages (atom:eventTransfer) are
+        queued in order and delivered by resetInputEvents().  Non-MIDI atoms
+        the plugin writes to its output sequences go the other way, to the
+        UI and onPortNotify with the atom:eventTransfer protocol.
      */
     void write (uint32 port, uint32 size, uint32 protocol, const void* buffer);
 
@@ -308,13 +360,16 @@ private:
     uint32 numPorts { 0 };
     Array<const LV2_Feature*> features;
 
-    std::unique_ptr<RingBuffer> events;
-    HeapBlock<uint8> evbuf;
-    uint32 evbufsize { 0 };
+    PortValueQueue controlChanges;
+    PortValueQueue controlNotifications;
+    HeapBlock<float> notifiedValues; // message thread
+
+    std::unique_ptr<RingBuffer> events; // atom messages only
+    uint32 eventTransfer { 0 };
+    uint32 midiEvent { 0 };
 
-    std::unique_ptr<RingBuffer> notifications;
-    HeapBlock<uint8> ntbuf;
-    uint32 ntbufsize { 0 };
+    std::unique_ptr<RingBuffer> notifications; // non-MIDI atoms from output ports
+    HeapBlock<uint8> ntbuf; // message thread
 
     OwnedArray<SupportedUI> supportedUIs;
     OwnedArray<ScalePoints> scalePoints;
@@ -322,6 +377,7 @@ private:
     void activatePorts();
     void freeInstance();
     void init();
+    void forwardOutputEvents();
 
     void timerCallback() override;
 
@@ -0,0 +1,213 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <algorithm>
+
+#include "lv2/pluginindex.hpp"
+
+using namespace juce;
+
+namespace element {
+
+static constexpr int indexVersion = 1;
+
+bool LV2PluginIndex::load (const File& file)
+{
+    bundles.clear();
+
+    auto xml = XmlDocument::parse (file);
+    if (xml == nullptr || ! xml->hasTagName ("lv2plugins")
+        || xml->getIntAttribute ("version") != indexVersion)
+        return false;
+
+    for (auto* b : xml->getChildWithTagNameIterator ("bundle"))
+    {
+        Bundle bundle;
+        bundle.path = b->getStringAttribute ("path");
+        bundle.modified = b->getStringAttribute ("modified").getLargeIntValue();
+        if (bundle.path.isEmpty())
+            continue;
+
+        for (auto* p : b->getChildWithTagNameIterator ("plugin"))
+        {
+            Plugin plugin;
+            plugin.uri = p->getStringAttribute ("uri");
+            plugin.name = p->getStringAttribute ("name");
+            plugin.author = p->getStringAttribute ("author");
+            plugin.classLabel = p->getStringAttribute ("class");
+            plugin.audioIns = p->getIntAttribute ("audioIns");
+            plugin.audioOuts = p->getIntAttribute ("audioOuts");
+            plugin.controlIns = p->getIntAttribute ("controlIns");
+            plugin.controlOuts = p->getIntAttribute ("controlOuts");
+            plugin.midiIn = p->getBoolAttribute ("midiIn");
+            plugin.midiOut = p->getBoolAttribute ("midiOut");
+            plugin.supported = p->getBoolAttribute ("supported", true);
+            if (plugin.uri.isNotEmpty())
+                bundle.plugins.push_back (std::move (plugin));
+        }
+
+        bundles.push_back (std::move (bundle));
+    }
+
+    return true;
+}
+
+bool LV2PluginIndex::save (const File& file) const
+{
+    XmlElement xml ("lv2plugins");
+    xml.setAttribute ("version", indexVersion);
+
+    for (const auto& bundle : bundles)
+    {
+        auto* b = xml.createNewChildElement ("bundle");
+        b->setAttribute ("path", bundle.path);
+        b->setAttribute ("modified", String (bundle.modified));
+
+        for (const auto& plugin : bundle.plugins)
+        {
+            auto* p = b->createNewChildElement ("plugin");
+            p->setAttribute ("uri", plugin.uri);
+            p->setAttribute ("name", plugin.name);
+            p->setAttribute ("author", plugin.author);
+            p->setAttribute ("class", plugin.classLabel);
+            p->setAttribute ("audioIns", plugin.audioIns);
+            p->setAttribute ("audioOuts", plugin.audioOuts);
+            p->setAttribute ("controlIns", plugin.controlIns);
+            p->setAttribute ("controlOuts", plugin.controlOuts);
+            p->setAttribute ("midiIn", plugin.midiIn);
+            p->setAttribute ("midiOut", plugin.midiOut);
+            p->setAttribute ("supported", plugin.supported);
+        }
+    }
+
+    file.getParentDirectory().createDirectory();
+    return xml.writeTo (file);
+}
+
+const LV2PluginIndex::Bundle* LV2PluginIndex::findBundle (const String& path) const
+{
+    for (const auto& bundle : bundles)
+        if (bundle.path == path)
+            return &bundle;
+    return nullptr;
+}
+
+const LV2PluginIndex::Bundle* LV2PluginIndex::findBundleForPlugin (const String& uri) const
+{
+    for (const auto& bundle : bundles)
+        for (const auto& plugin : bundle.plugins)
+            if (plugin.uri == uri)
+                return &bundle;
+    return nullptr;
+}
+
+const LV2PluginIndex::Plugin* LV2PluginIndex::findPlugin (const String& uri) const
+{
+    for (const auto& bundle : bundles)
+        for (const auto& plugin : bundle.plugins)
+            if (plugin.uri == uri)
+                return &plugin;
+    return nullptr;
+}
+
+void LV2PluginIndex::setBundle (Bundle bundle)
+{
+    for (auto& existing : bundles)
+    {
+        if (existing.path == bundle.path)
+        {
+            existing = std::move (bundle);
+            return;
+        }
+    }
+
+    bundles.push_back (std::move (bundle));
+}
+
+int LV2PluginIndex::removeBundlesNotIn (const StringArray& paths)
+{
+    const auto before = bundles.size();
+    bundles.erase (std::remove_if (bundles.begin(), bundles.end(), [&paths] (const Bundle& bundle) {
+                       return ! paths.contains (bundle.path);
+                   }),
+                   bundles.end());
+    return (int) (before - bundles.size());
+}
+
+void LV2PluginIndex::getSupportedPlugins (StringArray& uris) const
+{
+    for (const auto& bundle : bundles)
+        for (const auto& plugin : bundle.plugins)
+            if (plugin.supported)
+                uris.addIfNotAlreadyThere (plugin.uri);
+}
+
+//==============================================================================
+Array<File> LV2PluginIndex::getSearchPath()
+{
+    StringArray dirs;
+    const auto env = SystemStats::getEnvironmentVariable ("LV2_PATH", {});
+
+#if JUCE_WINDOWS
+    const String separator (";");
+#else
+    const String separator (":");
+#endif
+
+    if (env.isNotEmpty())
+    {
+        dirs.addTokens (env, separator, {});
+    }
+    else
+    {
+        // same defaults as lilv
+#if JUCE_MAC
+        dirs.add ("~/Library/Audio/Plug-Ins/LV2");
+        dirs.add ("~/.lv2");
+        dirs.add ("/usr/local/lib/lv2");
+        dirs.add ("/usr/lib/lv2");
+        dirs.add ("/Library/Audio/Plug-Ins/LV2");
+#elif JUCE_WINDOWS
+        dirs.add (File::getSpecialLocation (File::windowsLocalAppData).getChildFile ("LV2").getFullPathName());
+        dirs.add (File::getSpecialLocation (File::globalApplicationsDirectory).getChildFile ("Common Files/LV2").getFullPathName());
+#else
+        dirs.add ("~/.lv2");
+        dirs.add ("/usr/local/lib/lv2");
+        dirs.add ("/usr/lib/lv2");
+#endif
+    }
+
+    Array<File> result;
+    for (auto dir : dirs)
+    {
+        dir = dir.trim();
+        if (dir.startsWith ("~"))
+            dir = File::getSpecialLocation (File::userHomeDirectory).getFullPathName() + dir.substring (1);
+        if (File::isAbsolutePath (dir))
+            result.addIfNotAlreadyThere (File (dir));
+    }
+
+    return result;
+}
+
+Array<File> LV2PluginIndex::findBundles()
+{
+    Array<File> bundleDirs;
+    for (const auto& dir : getSearchPath())
+    {
+        if (! dir.isDirectory())
+            continue;
+        for (const auto& entry : RangedDirectoryIterator (dir, false, "*.lv2", File::findDirectories))
+            bundleDirs.add (entry.getFile());
+    }
+
+    return bundleDirs;
+}
+
+int64 LV2PluginIndex::getModificationTime (const File& bundle)
+{
+    return jmax (bundle.getLastModificationTime().toMilliseconds(),
+                 bundle.getChildFile ("manifest.ttl").getLastModificationTime().toMilliseconds());
+}
+
+} // namespace element
@@ -0,0 +1,100 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <vector>
+
+#include <element/juce/core.hpp>
+
+namespace element {
+
+/** A persisted summary of the installed LV2 bundles and their plugins.
+
+    The world uses it to list plugins and find a plugin's bundle without
+    parsing every bundle's Turtle.  A bundle's entry is valid while the
+    bundle's modification time is unchanged.  Bundles without plugins are
+    kept too, they hold the specifications plugins refer to.
+ */
+class LV2PluginIndex final
+{
+public:
+    /** Summary of a plugin. */
+    struct Plugin
+    {
+        juce::String uri;
+        juce::String name;
+        juce::String author;
+        juce::String classLabel;
+        int audioIns = 0;
+        int audioOuts = 0;
+        int controlIns = 0;
+        int controlOuts = 0;
+        bool midiIn = false;
+        bool midiOut = false;
+        bool supported = true;
+    };
+
+    /** An installed bundle. */
+    struct Bundle
+    {
+        juce::String path; ///< Absolute path of the bundle directory.
+        juce::int64 modified = 0; ///< See getModificationTime().
+        std::vector<Plugin> plugins;
+    };
+
+    LV2PluginIndex() = default;
+
+    /** Replace the index with one read from a file. Returns false if the
+        file is missing or invalid, the index is then empty.
+     */
+    bool load (const juce::File& file);
+
+    /** Write the index to a file. */
+    bool save (const juce::File& file) const;
+
+    /** Returns true if no bundles are indexed. */
+    bool isEmpty() const noexcept { return bundles.empty(); }
+
+    /** Returns the indexed bundles. */
+    const std::vector<Bundle>& getBundles() const noexcept { return bundles; }
+
+    /** Returns a bundle by path or nullptr. */
+    const Bundle* findBundle (const juce::String& path) const;
+
+    /** Returns the bundle containing a plugin or nullptr. */
+    const Bundle* findBundleForPlugin (const juce::String& uri) const;
+
+    /** Returns a plugin by URI or nullptr. */
+    const Plugin* findPlugin (const juce::String& uri) const;
+
+    /** Add or replace a bundle. */
+    void setBundle (Bundle bundle);
+
+    /** Remove every bundle not in paths. Returns the number removed. */
+    int removeBundlesNotIn (const juce::StringArray& paths);
+
+    /** Add the URIs of supported plugins to a list. */
+    void getSupportedPlugins (juce::StringArray& uris) const;
+
+    //==========================================================================
+    /** Returns the directories searched for bundles, from LV2_PATH or the
+        platform defaults.
+     */
+    static juce::Array<juce::File> getSearchPath();
+
+    /** Returns every bundle directory on the search path. Only directory
+        entries are read, no bundle is parsed.
+     */
+    static juce::Array<juce::File> findBundles();
+
+    /** Returns the time used to validate a bundle, the later of the
+        directory's and its manifest's modification times.
+     */
+    static juce::int64 getModificationTime (const juce::File& bundle);
+
+private:
+    std::vector<Bundle> bundles;
+};
+
+} // namespace element
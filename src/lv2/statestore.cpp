@@ -0,0 +1,158 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <cstdlib>
+#include <cstring>
+
+#include "lv2/statestore.hpp"
+
+using namespace juce;
+
+namespace element {
+namespace LV2Callbacks {
+
+static char* duplicatePath (const String& path)
+{
+    const auto* utf8 = path.toRawUTF8();
+    const auto size = std::strlen (utf8) + 1;
+    auto* result = static_cast<char*> (std::malloc (size));
+    if (result != nullptr)
+        std::memcpy (result, utf8, size);
+    return result;
+}
+
+static char* abstractPath (LV2_State_Map_Path_Handle handle, const char* absolutePath)
+{
+    return static_cast<const LV2StateStore*> (handle)->makeAbstractPath (absolutePath);
+}
+
+static char* absolutePath (LV2_State_Map_Path_Handle handle, const char* abstractPath)
+{
+    return static_cast<const LV2StateStore*> (handle)->makeAbsolutePath (abstractPath);
+}
+
+static char* makePath (LV2_State_Make_Path_Handle handle, const char* path)
+{
+    auto* store = static_cast<const LV2StateStore*> (handle);
+    const auto file = store->getDirectory().getChildFile (String::fromUTF8 (path));
+    file.getParentDirectory().createDirectory();
+    return duplicatePath (file.getFullPathName());
+}
+
+static void freePath (LV2_State_Free_Path_Handle, char* path)
+{
+    std::free (path);
+}
+
+} // namespace LV2Callbacks
+
+LV2StateStore::LV2StateStore (LV2_URID_Map& m, LV2_URID_Unmap& u, const File& dir)
+    : map (m), unmap (u), directory (dir)
+{
+    mapPath = { this, &LV2Callbacks::abstractPath, &LV2Callbacks::absolutePath };
+    makePath = { this, &LV2Callbacks::makePath };
+    freePath = { this, &LV2Callbacks::freePath };
+    mapPathFeature = { LV2_STATE__mapPath, &mapPath };
+    makePathFeature = { LV2_STATE__makePath, &makePath };
+    freePathFeature = { LV2_STATE__freePath, &freePath };
+    features[0] = &mapPathFeature;
+    features[1] = &makePathFeature;
+    features[2] = &freePathFeature;
+    features[3] = nullptr;
+}
+
+LV2StateStore::~LV2StateStore() {}
+
+LV2_State_Status LV2StateStore::store (LV2_State_Handle handle, uint32_t key, const void* value, size_t size, uint32_t type, uint32_t flags)
+{
+    auto& self = *static_cast<LV2StateStore*> (handle);
+    if (key == 0 || type == 0)
+        return LV2_STATE_ERR_UNKNOWN;
+
+    // kept whatever the flags, like lilv does. Paths arrive already mapped.
+    auto* property = self.properties.add (new Property());
+    property->key = String::fromUTF8 (self.unmap.unmap (self.unmap.handle, key));
+    property->type = String::fromUTF8 (self.unmap.unmap (self.unmap.handle, type));
+    property->flags = flags;
+    property->value.append (value, size);
+    property->keyURID = key;
+    property->typeURID = type;
+    return LV2_STATE_SUCCESS;
+}
+
+const void* LV2StateStore::retrieve (LV2_State_Handle handle, uint32_t key, size_t* size, uint32_t* type, uint32_t* flags)
+{
+    auto& self = *static_cast<LV2StateStore*> (handle);
+    for (const auto* property : self.properties)
+    {
+        if (property->keyURID != key)
+            continue;
+        *size = property->value.getSize();
+        *type = property->typeURID;
+        *flags = property->flags;
+        return property->value.getData();
+    }
+
+    return nullptr;
+}
+
+void LV2StateStore::clear()
+{
+    properties.clearQuick (true);
+}
+
+void LV2StateStore::write (OutputStream& out) const
+{
+    out.writeInt (properties.size());
+    for (const auto* property : properties)
+    {
+        out.writeString (property->key);
+        out.writeString (property->type);
+        out.writeInt ((int) property->flags);
+        out.writeInt ((int) property->value.getSize());
+        out.write (property->value.getData(), property->value.getSize());
+    }
+}
+
+bool LV2StateStore::read (InputStream& in)
+{
+    clear();
+    for (int i = jmax (0, in.readInt()); --i >= 0;)
+    {
+        if (in.isExhausted())
+            return false;
+
+        std::unique_ptr<Property> property (new Property());
+        property->key = in.readString();
+        property->type = in.readString();
+        property->flags = (uint32_t) in.readInt();
+        const auto valueSize = (size_t) jmax (0, in.readInt());
+        if (valueSize > (size_t) in.getNumBytesRemaining())
+            return false;
+        property->value.setSize (valueSize);
+        in.read (property->value.getData(), (int) valueSize);
+        property->keyURID = map.map (map.handle, property->key.toRawUTF8());
+        property->typeURID = map.map (map.handle, property->type.toRawUTF8());
+        properties.add (property.release());
+    }
+
+    return true;
+}
+
+char* LV2StateStore::makeAbstractPath (const char* absolutePath) const
+{
+    const File file (String::fromUTF8 (absolutePath));
+    if (file.isAChildOf (directory))
+        return LV2Callbacks::duplicatePath (file.getRelativePathFrom (directory));
+    return LV2Callbacks::duplicatePath (String::fromUTF8 (absolutePath));
+}
+
+char* LV2StateStore::makeAbsolutePath (const char* abstractPath) const
+{
+    const auto path = String::fromUTF8 (abstractPath);
+    if (File::isAbsolutePath (path))
+        return LV2Callbacks::duplicatePath (path);
+    return LV2Callbacks::duplicatePath (directory.getChildFile (path).getFullPathName());
+}
+
+} // namespace element
@@ -0,0 +1,95 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <lv2/core/lv2.h>
+#include <lv2/state/state.h>
+#include <lv2/urid/urid.h>
+
+#include <element/juce/core.hpp>
+
+namespace element {
+
+/** Properties a plugin saves through its LV2 state:interface.
+
+    Values are kept exactly as the plugin stores them, together with their
+    type and flags, the same as lilv does.  Keys and types are written as
+    URIs so the data doesn't depend on URID numbering.
+
+    The store also provides the state:mapPath, state:makePath and
+    state:freePath features.  Files a plugin creates with makePath go in the
+    store's directory, and paths inside it are saved relative to it.  Other
+    paths are saved as they are.
+ */
+class LV2StateStore final
+{
+public:
+    LV2StateStore (LV2_URID_Map& map, LV2_URID_Unmap& unmap, const juce::File& directory);
+    ~LV2StateStore();
+
+    /** Returns the directory files made by the plugin go in. */
+    const juce::File& getDirectory() const noexcept { return directory; }
+
+    /** Returns the path features, null terminated. Pass these to the
+        plugin's save() and restore().
+     */
+    const LV2_Feature* const* getFeatures() const noexcept { return features; }
+
+    /** The store function for state:interface save(), with getHandle(). */
+    static LV2_State_Status store (LV2_State_Handle handle, uint32_t key, const void* value, size_t size, uint32_t type, uint32_t flags);
+
+    /** The retrieve function for state:interface restore(), with getHandle(). */
+    static const void* retrieve (LV2_State_Handle handle, uint32_t key, size_t* size, uint32_t* type, uint32_t* flags);
+
+    /** Returns the handle to pass with store() and retrieve(). */
+    LV2_State_Handle getHandle() noexcept { return this; }
+
+    /** Remove all properties. */
+    void clear();
+
+    /** Returns the number of properties. */
+    int size() const noexcept { return properties.size(); }
+
+    /** Write all properties. */
+    void write (juce::OutputStream& out) const;
+
+    /** Replace the properties with ones written by write(). Returns false
+        if the data ended early.
+     */
+    bool read (juce::InputStream& in);
+
+    /** Returns the path saved for an absolute path. The result is allocated
+        with malloc.
+     */
+    char* makeAbstractPath (const char* absolutePath) const;
+
+    /** Returns the absolute path of a saved path. The result is allocated
+        with malloc.
+     */
+    char* makeAbsolutePath (const char* abstractPath) const;
+
+private:
+    struct Property
+    {
+        juce::String key, type;
+        uint32_t flags = 0;
+        juce::MemoryBlock value;
+        uint32_t keyURID = 0, typeURID = 0;
+    };
+
+    LV2_URID_Map& map;
+    LV2_URID_Unmap& unmap;
+    const juce::File directory;
+    juce::OwnedArray<Property> properties;
+
+    LV2_State_Map_Path mapPath;
+    LV2_State_Make_Path makePath;
+    LV2_State_Free_Path freePath;
+    LV2_Feature mapPathFeature, makePathFeature, freePathFeature;
+    const LV2_Feature* features[4];
+
+    JUCE_DECLARE_NON_COPYABLE (LV2StateStore)
+};
+
+} // namespace element
@@ -1,6 +1,7 @@
 // Copyright 2014-2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include "engine/threadscheduler.hpp"
 #include "lv2/workthread.hpp"
 
 using namespace juce;
@@ -64,85 +65,113 @@ void WorkThread::removeWorker (WorkerBase* worker)
 void WorkThread::run()
 {
     HeapBlock<uint8> buffer;
-    int32 readBufferSize = 0;
+    uint32_t readBufferSize = 0;
+    int scheduleGeneration = -1;
 
     while (true)
     {
+        ThreadScheduler::updateCurrentThread (ThreadScheduler::Worker, scheduleGeneration);
         this->wait (-1);
 
+        // a notify may cover several requests, handle all that are ready.
+        while (! (doExit || threadShouldExit()))
+            if (! processNextRequest (buffer, readBufferSize))
+                break;
+
         if (doExit || threadShouldExit())
             break;
+    }
 
-        while (! validateMessage (*requests))
-            Thread::sleep (6);
+    buffer.free();
+}
 
-        if (doExit || threadShouldExit())
-            break;
+bool WorkThread::processNextRequest (HeapBlock<uint8>& buffer, uint32_t& readBufferSize)
+{
+    if (! validateMessage (*requests))
+        return false;
 
-        uint32_t size = 0;
-        if (requests->read (&size, sizeof (size)) < sizeof (size))
-        {
-            WORKER_LOG ("error reading request: message size");
-            continue;
-        }
+    uint32_t size = 0;
+    if (requests->read (&size, sizeof (size)) < sizeof (size))
+    {
+        WORKER_LOG ("error reading request: message size");
+        return false;
+    }
 
-        uint32_t workId;
-        if (requests->read (&workId, sizeof (workId)) < sizeof (workId))
-        {
-            WORKER_LOG ("error reading request: worker id");
-            continue;
-        }
+    uint32_t workId;
+    if (requests->read (&workId, sizeof (workId)) < sizeof (workId))
+    {
+        WORKER_LOG ("error reading request: worker id");
+        return false;
+    }
 
-        if (workId == 0)
-            continue;
+    int64 scheduled = 0;
+    if (requests->read (&scheduled, sizeof (scheduled)) < sizeof (scheduled))
+    {
+        WORKER_LOG ("error reading request: timestamp");
+        return false;
+    }
 
-        if (size > static_cast<uint32_t> (readBufferSize))
-        {
-            readBufferSize = nextPowerOfTwo (size);
-            buffer.realloc (readBufferSize);
-        }
+    if (size > readBufferSize)
+    {
+        readBufferSize = (uint32_t) nextPowerOfTwo ((int) size);
+        buffer.realloc (readBufferSize);
+    }
 
-        if (requests->read (buffer.getData(), size) < size)
+    if (requests->read (buffer.getData(), size) < size)
+    {
+        WORKER_LOG ("error reading request: message body");
+        return false;
+    }
+
+    --pending;
+
+    const auto started = Time::getHighResolutionTicks();
+    const auto latency = 1000.0 * Time::highResolutionTicksToSeconds (started - scheduled);
+    lastLatency.store (latency);
+    if (latency > maxLatency.load())
+        maxLatency.store (latency);
+    totalLatency.store (totalLatency.load() + latency);
+
+    if (WorkerBase* const worker = getWorker (workId))
+    {
+        while (! worker->flag.setWorking (true))
         {
-            WORKER_LOG ("error reading request: message body");
-            continue;
         }
-
+        worker->processRequest (size, buffer.getData());
+        while (! worker->flag.setWorking (false))
         {
-            if (WorkerBase* const worker = getWorker (workId))
-            {
-                while (! worker->flag.setWorking (true))
-                {
-                }
-                worker->processRequest (size, buffer.getData());
-                while (! worker->flag.setWorking (false))
-                {
-                }
-            }
         }
-
-        if (threadShouldExit() || doExit)
-            break;
     }
 
-    buffer.free();
+    busyTime.store (busyTime.load() + 1000.0 * Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - started));
+    ++processed;
+    return true;
 }
 
 bool WorkThread::scheduleWork (WorkerBase* worker, uint32_t size, const void* data)
 {
     jassert (size > 0 && worker && worker->workId != 0);
-    if (! requests->canWrite (getRequiredSpace (size)))
-        return false;
+    const int64 scheduled = Time::getHighResolutionTicks();
 
-    if (requests->write (&size, sizeof (size)) < sizeof (uint32_t))
-        return false;
+    {
+        const SpinLock::ScopedLockType sl (writeLock);
+        if (! requests->canWrite (getRequiredSpace (size)))
+            return false;
 
-    if (requests->write (&worker->workId, sizeof (worker->workId)) < sizeof (worker->workId))
-        return false;
+        if (requests->write (&size, sizeof (size)) < sizeof (uint32_t))
+            return false;
 
-    if (requests->write (data, size) < size)
-        return false;
+        if (requests->write (&worker->workId, sizeof (worker->workId)) < sizeof (worker->workId))
+            return false;
+
+        if (requests->write (&scheduled, sizeof (scheduled)) < sizeof (scheduled))
+            return false;
+
+        if (requests->write (data, size) < size)
+            return false;
+    }
 
+    ++pending;
     notify();
     return true;
 }
@@ -150,16 +179,32 @@ bool WorkThread::scheduleWork (WorkerBase* worker, uint32_t size, const void* da
 bool WorkThread::validateMessage (RingBuffer& ring)
 {
     uint32_t size = 0;
+    if (! ring.canRead (sizeof (size)))
+        return false;
     ring.peak (&size, sizeof (size));
     return ring.canRead (getRequiredSpace (size));
 }
 
+WorkThread::Stats WorkThread::getStats() const
+{
+    Stats stats;
+    stats.numWorkers = workers.size();
+    stats.pending = jmax (0, pending.load());
+    stats.processed = processed.load();
+    stats.lastLatencyMs = lastLatency.load();
+    stats.maxLatencyMs = maxLatency.load();
+    stats.averageLatencyMs = stats.processed > 0 ? totalLatency.load() / (double) stats.processed : 0.0;
+    stats.busyMs = busyTime.load();
+    return stats;
+}
+
 WorkerBase::WorkerBase (WorkThread& thread, uint32_t bufsize)
     : owner (thread)
 {
     bufsize = juce::nextPowerOfTwo (bufsize);
     responses = std::make_unique<RingBuffer> (bufsize);
     response.calloc (bufsize);
+    responseSize = bufsize;
     thread.addWorker (this);
 }
 
@@ -182,15 +227,45 @@ bool WorkerBase::scheduleWork (uint32_t size, const void* data)
 
 bool WorkerBase::respondToWork (uint32_t size, const void* data)
 {
-    if (! responses->canWrite (sizeof (size) + size))
-        return false;
+    if (size <= responseSize && sizeof (size) + size < responses->size())
+    {
+        if (! responses->canWrite (sizeof (size) + size))
+            return false;
+
+        if (responses->write (&size, sizeof (size)) < sizeof (size))
+            return false;
 
-    if (responses->write (&size, sizeof (size)) < sizeof (size))
+        if (responses->write (data, size) < size)
+            return false;
+
+        return true;
+    }
+
+    if ((size & largeResponseFlag) != 0)
         return false;
 
-    if (responses->write (data, size) < size)
+    // wait for the realtime thread to take the previous large response
+    for (int i = 0; largeResponsePending.load (std::memory_order_acquire); ++i)
+    {
+        if (i >= 500)
+            return false;
+        Thread::sleep (2);
+    }
+
+    if (size > largeResponseSize)
+    {
+        largeResponseSize = (uint32_t) nextPowerOfTwo ((int) size);
+        largeResponse.realloc (largeResponseSize);
+    }
+
+    if (! responses->canWrite (sizeof (size)))
         return false;
 
+    std::memcpy (largeResponse.getData(), data, size);
+    largeResponsePending.store (true, std::memory_order_release);
+
+    const uint32_t header = size | largeResponseFlag;
+    responses->write (&header, sizeof (header));
     return true;
 }
 
@@ -206,6 +281,15 @@ void WorkerBase::processWorkResponses()
             return;
 
         responses->read (&size, sizeof (size));
+
+        if ((size & largeResponseFlag) != 0)
+        {
+            processResponse (size & ~largeResponseFlag, largeResponse.getData());
+            largeResponsePending.store (false, std::memory_order_release);
+            remaining -= sizeof (uint32_t);
+            continue;
+        }
+
         responses->read (response.getData(), size);
         processResponse (size, response.getData());
         remaining -= (sizeof (uint32_t) + size);
@@ -217,6 +301,8 @@ bool WorkerBase::validateMessage (RingBuffer& ring)
     // the worker only validates message size
     uint32_t size = 0;
     ring.peak (&size, sizeof (size));
+    if ((size & largeResponseFlag) != 0)
+        return true;
     return ring.canRead (size + sizeof (size));
 }
 
@@ -224,6 +310,7 @@ void WorkerBase::setSize (uint32_t newSize)
 {
     responses = std::make_unique<RingBuffer> (newSize);
     response.realloc (newSize);
+    responseSize = newSize;
 }
 
 } // namespace element
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include <element/juce/core.hpp>
@@ -15,6 +16,9 @@ class WorkerBase;
 
 /** A worker thread
     Capable of scheduling non-realtime work from a realtime context.
+
+    Requests are handled in the order they were scheduled, so the requests
+    of one worker never overtake each other.
  */
 class WorkThread : public juce::Thread
 {
@@ -23,7 +27,25 @@ public:
     WorkThread (const juce::String& name, uint32_t bufsize, Priority priority = Priority::normal);
     ~WorkThread();
 
-    inline static uint32_t getRequiredSpace (uint32_t msgSize) { return msgSize + (2 * sizeof (uint32_t)); }
+    /** Queue and timing statistics. */
+    struct Stats
+    {
+        int numWorkers = 0; ///< Workers registered with the thread.
+        int pending = 0; ///< Requests waiting to be processed.
+        juce::int64 processed = 0; ///< Requests processed.
+        double lastLatencyMs = 0.0; ///< Time the last request waited in the queue.
+        double maxLatencyMs = 0.0; ///< Longest time a request waited in the queue.
+        double averageLatencyMs = 0.0; ///< Mean time requests waited in the queue.
+        double busyMs = 0.0; ///< Total time spent processing requests.
+    };
+
+    /** Returns queue and timing statistics. Safe to call from any thread. */
+    Stats getStats() const;
+
+    /** Returns the number of registered workers. */
+    int getNumWorkers() const { return workers.size(); }
+
+    inline static uint32_t getRequiredSpace (uint32_t msgSize) { return msgSize + (2 * sizeof (uint32_t)) + sizeof (juce::int64); }
 
 protected:
     friend class WorkerBase;
@@ -48,10 +70,19 @@ private:
     bool doExit = false;
 
     std::unique_ptr<RingBuffer> requests; ///< requests to process
+    juce::SpinLock writeLock; ///< more than one audio thread may schedule
+
+    std::atomic<int> pending { 0 };
+    std::atomic<juce::int64> processed { 0 };
+    std::atomic<double> lastLatency { 0.0 }, maxLatency { 0.0 },
+        totalLatency { 0.0 }, busyTime { 0.0 };
 
     /** @internal Validate a ringbuffer for message completeness */
     bool validateMessage (RingBuffer& ring);
 
+    /** @internal Process one queued request, returns false if none was ready */
+    bool processNextRequest (juce::HeapBlock<uint8_t>& buffer, uint32_t& bufferSize);
+
     /** @internal The work thread function */
     void run();
 };
@@ -88,6 +119,9 @@ public:
 
     /** Respond from work (worker thread). Call this during processRequest if you
         need to send a response into the realtime thread.
+
+        Responses too large for the response ring are copied to a separate
+        buffer which grows as needed, only one of these can be in flight.
         @see processWorkResponses, @see processResponse */
     bool respondToWork (uint32_t size, const void* data);
 
@@ -113,6 +147,12 @@ private:
 
     std::unique_ptr<RingBuffer> responses; ///< responses from work
     juce::HeapBlock<uint8_t> response; ///< buffer to write a response
+    uint32_t responseSize = 0;
+
+    juce::HeapBlock<uint8_t> largeResponse; ///< responses bigger than the ring
+    uint32_t largeResponseSize = 0;
+    std::atomic<bool> largeResponsePending { false };
+    static constexpr uint32_t largeResponseFlag = 0x80000000u;
 
     bool validateMessage (RingBuffer& ring);
 
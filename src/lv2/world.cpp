@@ -1,8 +1,11 @@
 // Copyright 2014-2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include <map>
+
 #include <lv2/event/event.h>
 #include <lv2/midi/midi.h>
+#include <lv2/time/time.h>
 #include <lv2/ui/ui.h>
 
 #include <lvtk/symbols.hpp>
@@ -16,9 +19,11 @@
 #include "lv2/workerfeature.hpp"
 #include "lv2/world.hpp"
 #include "lv2/logfeature.hpp"
+#include "datapath.hpp"
 
+// Number of LV2 worker threads, 0 sizes the pool to the machine.
 #ifndef EL_LV2_NUM_WORKERS
-#define EL_LV2_NUM_WORKERS 1
+#define EL_LV2_NUM_WORKERS 0
 #endif
 
 namespace element {
@@ -133,6 +138,7 @@ World::World()
     lv2_CVPort = lilv_new_uri (world, LV2_CORE__CVPort);
     lv2_enumeration = lilv_new_uri (world, LV2_CORE__enumeration);
     midi_MidiEvent = lilv_new_uri (world, LV2_MIDI__MidiEvent);
+    time_Position = lilv_new_uri (world, LV2_TIME__Position);
     work_schedule = lilv_new_uri (world, LV2_WORKER__schedule);
     work_interface = lilv_new_uri (world, LV2_WORKER__interface);
     options_options = lilv_new_uri (world, LV2_OPTIONS__options);
@@ -150,7 +156,9 @@ World::World()
 
     lilv_world_set_option (world, LILV_OPTION_DYN_MANIFEST, trueNode);
 
-    lilv_world_load_all (world);
+    // nothing is parsed here, bundles load when their plugins are needed
+    indexFile = DataPath::applicationDataDir().getChildFile ("cache/lv2/plugins.xml");
+    index.load (indexFile);
 #if JLV2_SUIL_INIT
     suil_init (nullptr, nullptr, SUIL_ARG_NONE);
 #endif
@@ -160,8 +168,9 @@ World::World()
                           LV2ModuleUI::portUnsubscribe);
     suil_host_set_touch_func (suil, LV2ModuleUI::touch);
 
-    currentThread = 0;
     numThreads = EL_LV2_NUM_WORKERS;
+    if (numThreads <= 0)
+        numThreads = jlimit (1, 8, SystemStats::getNumCpus() / 2);
     for (int i = 0; i < numThreads; ++i)
     {
         threads.add (new WorkThread ("lv2_worker_" + String (i + 1), EL_LV2_RING_BUFFER_SIZE));
@@ -188,6 +197,7 @@ World::~World()
     _node_free (lv2_CVPort);
     _node_free (lv2_enumeration);
     _node_free (midi_MidiEvent);
+    _node_free (time_Position);
     _node_free (work_schedule);
     _node_free (work_interface);
     _node_free (options_options);
@@ -215,29 +225,26 @@ LV2Module* World::createModule (const String& uri)
 
 void World::fillPluginDescription (const String& uri, PluginDescription& desc) const
 {
-    jassertfalse;
-#if 0
-    if (const LilvPlugin* plugin = getPlugin (uri))
-    {
-        LV2PluginModel model (*const_cast<World*> (this), plugin);
-        desc.category = model.getClassLabel();
-        desc.descriptiveName = String();
-        desc.fileOrIdentifier = uri;
-        desc.hasSharedContainer = false;
-        desc.isInstrument = model.getMidiPort() != LV2UI_INVALID_PORT_INDEX;
-        desc.lastFileModTime = Time();
-        desc.manufacturerName = model.getAuthorName();
-        desc.name = model.getName();
-        desc.numInputChannels  = model.getNumPorts (PortType::Audio, true);
-        desc.numOutputChannels = model.getNumPorts (PortType::Audio, false);
-        desc.pluginFormatName = String ("LV2");
-        desc.uid = desc.fileOrIdentifier.hashCode();
-        desc.version = String();
-    }
-#endif
+    const auto* info = index.findPlugin (uri);
+    if (info == nullptr)
+        return;
+
+    desc.category = info->classLabel;
+    desc.descriptiveName = String();
+    desc.fileOrIdentifier = uri;
+    desc.hasSharedContainer = false;
+    desc.isInstrument = info->midiIn && info->audioOuts > 0 && info->audioIns == 0;
+    desc.lastFileModTime = Time();
+    desc.manufacturerName = info->author;
+    desc.name = info->name;
+    desc.numInputChannels = info->audioIns;
+    desc.numOutputChannels = info->audioOuts;
+    desc.pluginFormatName = String ("LV2");
+    desc.uniqueId = desc.fileOrIdentifier.hashCode();
+    desc.version = String();
 }
 
-const LilvPlugin* World::getPlugin (const String& uri) const
+const LilvPlugin* World::findLoadedPlugin (const String& uri) const
 {
     LilvNode* p (lilv_new_uri (world, uri.toUTF8()));
     const LilvPlugin* plugin = lilv_plugins_get_by_uri (getAllPlugins(), p);
@@ -246,14 +253,171 @@ const LilvPlugin* World::getPlugin (const String& uri) const
     return plugin;
 }
 
+const LilvPlugin* World::getPlugin (const String& uri) const
+{
+    if (const auto* plugin = findLoadedPlugin (uri))
+        return plugin;
+    return const_cast<World*> (this)->loadPlugin (uri) ? findLoadedPlugin (uri) : nullptr;
+}
+
+bool World::loadPlugin (const String& uri)
+{
+    if (findLoadedPlugin (uri) != nullptr)
+        return true;
+
+    if (! allLoaded)
+    {
+        if (index.findBundleForPlugin (uri) == nullptr)
+            refreshPluginIndex();
+
+        if (const auto* bundle = index.findBundleForPlugin (uri))
+        {
+            loadSpecifications();
+            loadBundle (bundle->path);
+        }
+
+        // not indexed, e.g. from a dynamic manifest
+        if (findLoadedPlugin (uri) == nullptr)
+        {
+            lilv_world_load_all (world);
+            allLoaded = true;
+        }
+    }
+
+    return findLoadedPlugin (uri) != nullptr;
+}
+
+void World::loadBundle (const String& path)
+{
+    if (allLoaded || loadedBundles.contains (path))
+        return;
+
+    const auto dir = File (path).getFullPathName() + File::getSeparatorString();
+    if (auto* node = lilv_new_file_uri (world, nullptr, dir.toRawUTF8()))
+    {
+        lilv_world_load_bundle (world, node);
+        lilv_node_free (node);
+    }
+
+    loadedBundles.add (path);
+}
+
+void World::loadSpecifications()
+{
+    if (specificationsLoaded)
+        return;
+    specificationsLoaded = true;
+
+    // bundles without plugins hold the specifications plugins refer to
+    for (const auto& bundle : index.getBundles())
+        if (bundle.plugins.empty())
+            loadBundle (bundle.path);
+
+    lilv_world_load_specifications (world);
+    lilv_world_load_plugin_classes (world);
+}
+
+void World::refreshPluginIndex()
+{
+    loadSpecifications();
+
+    StringArray paths, changed;
+    for (const auto& dir : LV2PluginIndex::findBundles())
+    {
+        const auto path = dir.getFullPathName();
+        paths.add (path);
+        const auto* existing = index.findBundle (path);
+        if (existing == nullptr || existing->modified != LV2PluginIndex::getModificationTime (dir))
+            changed.add (path);
+    }
+
+    const int removed = index.removeBundlesNotIn (paths);
+    if (changed.isEmpty())
+    {
+        if (removed > 0)
+            index.save (indexFile);
+        return;
+    }
+
+    for (const auto& path : changed)
+        loadBundle (path);
+
+    lilv_world_load_specifications (world);
+    lilv_world_load_plugin_classes (world);
+
+    std::map<String, LV2PluginIndex::Bundle> bundles;
+    for (const auto& path : changed)
+    {
+        auto& bundle = bundles[path];
+        bundle.path = path;
+        bundle.modified = LV2PluginIndex::getModificationTime (File (path));
+    }
+
+    const LilvPlugins* plugins (lilv_world_get_all_plugins (world));
+    LILV_FOREACH (plugins, iter, plugins)
+    {
+        const LilvPlugin* plugin = lilv_plugins_get (plugins, iter);
+        auto* bundlePath = lilv_file_uri_parse (lilv_node_as_uri (lilv_plugin_get_bundle_uri (plugin)), nullptr);
+        const auto path = File (String::fromUTF8 (bundlePath)).getFullPathName();
+        lilv_free (bundlePath);
+
+        auto found = bundles.find (path);
+        if (found != bundles.end())
+            found->second.plugins.push_back (describePlugin (plugin));
+    }
+
+    for (auto& entry : bundles)
+        index.setBundle (std::move (entry.second));
+    index.save (indexFile);
+}
+
+LV2PluginIndex::Plugin World::describePlugin (const LilvPlugin* plugin) const
+{
+    LV2PluginIndex::Plugin info;
+    info.uri = String::fromUTF8 (lilv_node_as_uri (lilv_plugin_get_uri (plugin)));
+
+    if (auto* node = lilv_plugin_get_name (plugin))
+    {
+        info.name = String::fromUTF8 (lilv_node_as_string (node));
+        lilv_node_free (node);
+    }
+
+    if (auto* node = lilv_plugin_get_author_name (plugin))
+    {
+        info.author = String::fromUTF8 (lilv_node_as_string (node));
+        lilv_node_free (node);
+    }
+
+    if (const auto* klass = lilv_plugin_get_class (plugin))
+        if (const auto* label = lilv_plugin_class_get_label (klass))
+            info.classLabel = String::fromUTF8 (lilv_node_as_string (label));
+
+    const uint32 numPorts = lilv_plugin_get_num_ports (plugin);
+    for (uint32 i = 0; i < numPorts; ++i)
+    {
+        const auto* port = lilv_plugin_get_port_by_index (plugin, i);
+        const bool input = lilv_port_is_a (plugin, port, lv2_InputPort);
+
+        if (lilv_port_is_a (plugin, port, lv2_AudioPort))
+            ++(input ? info.audioIns : info.audioOuts);
+        else if (lilv_port_is_a (plugin, port, lv2_ControlPort))
+            ++(input ? info.controlIns : info.controlOuts);
+        else if ((lilv_port_is_a (plugin, port, lv2_AtomPort) || lilv_port_is_a (plugin, port, lv2_EventPort))
+                 && lilv_port_supports_event (plugin, port, midi_MidiEvent))
+            (input ? info.midiIn : info.midiOut) = true;
+    }
+
+    info.supported = isPluginSupported (plugin);
+    return info;
+}
+
 String World::getPluginName (const String& uri) const
 {
-    auto* uriNode = lilv_new_uri (world, uri.toRawUTF8());
-    const auto* plugin = lilv_plugins_get_by_uri (
-        lilv_world_get_all_plugins (world), uriNode);
-    lilv_node_free (uriNode);
-    uriNode = nullptr;
+    if (const auto* info = index.findPlugin (uri))
+        if (info->name.isNotEmpty())
+            return info->name;
 
+    const auto* plugin = getPlugin (uri);
     String name;
 
     if (plugin != nullptr)
@@ -266,16 +430,11 @@ String World::getPluginName (const String& uri) const
     return name;
 }
 
-void World::getSupportedPlugins (StringArray& list) const
+void World::getSupportedPlugins (StringArray& list, bool refresh)
 {
-    const LilvPlugins* plugins (lilv_world_get_all_plugins (world));
-    LILV_FOREACH (plugins, iter, plugins)
-    {
-        const LilvPlugin* plugin = lilv_plugins_get (plugins, iter);
-        const String uri = String::fromUTF8 (lilv_node_as_uri (lilv_plugin_get_uri (plugin)));
-        if (isPluginSupported (uri))
-            list.add (uri);
-    }
+    if (refresh || index.isEmpty())
+        refreshPluginIndex();
+    index.getSupportedPlugins (list);
 }
 
 const LilvPlugins* World::getAllPlugins() const
@@ -287,14 +446,24 @@ WorkThread& World::getWorkThread()
 {
     while (threads.size() < numThreads)
     {
-        threads.add (new WorkThread ("LV2 Worker " + String (threads.size()), EL_LV2_RING_BUFFER_SIZE));
+        threads.add (new WorkThread ("lv2_worker_" + String (threads.size() + 1), EL_LV2_RING_BUFFER_SIZE));
     }
 
-    const int threadIndex = currentThread;
-    if (++currentThread >= numThreads)
-        currentThread = 0;
+    // A worker stays on one thread, which keeps its requests in order.
+    // Spread workers so one plugin's loading doesn't hold up another's.
+    auto* best = threads.getFirst();
+    for (auto* thread : threads)
+        if (thread->getNumWorkers() < best->getNumWorkers())
+            best = thread;
 
-    return *threads.getUnchecked (threadIndex);
+    return *best;
+}
+
+WorkThread::Stats World::getWorkThreadStats (int index) const
+{
+    if (auto* thread = threads[index])
+        return thread->getStats();
+    return {};
 }
 
 bool World::isFeatureSupported (const String& featureURI) const
@@ -9,6 +9,8 @@
 #include <lvtk/host/node.hpp>
 
 #include "lv2/lv2features.hpp"
+#include "lv2/pluginindex.hpp"
+#include "lv2/workthread.hpp"
 
 #ifndef ELEMENT_PREFIX
 #define ELEMENT_PREFIX "https://lvtk.org/ns/jlv2#"
@@ -18,10 +20,13 @@
 namespace element {
 
 class LV2Module;
-class WorkThread;
 
 /** Slim wrapper around LilvWorld.  Publishes commonly used LilvNodes and
     manages heavy weight features (like LV2 Worker)
+
+    Bundles are loaded lazily.  Plugins are listed from a persisted
+    LV2PluginIndex, and a plugin's bundle is only loaded when the plugin is
+    first needed.
  */
 class World
 {
@@ -38,6 +43,7 @@ public:
     const LilvNode* lv2_CVPort;
     const LilvNode* lv2_enumeration;
     const LilvNode* midi_MidiEvent;
+    const LilvNode* time_Position;
     const LilvNode* work_schedule;
     const LilvNode* work_interface;
     const LilvNode* options_options;
@@ -56,12 +62,26 @@ public:
     /** Create an LV2Module for a uri string */
     LV2Module* createModule (const String& uri);
 
-    /** Fill a PluginDescription for a plugin uri */
+    /** Fill a PluginDescription for a plugin uri from the index, without
+        loading its bundle */
     void fillPluginDescription (const String& uri, PluginDescription& desc) const;
 
-    /** Get an LilvPlugin for a uri string */
+    /** Get an LilvPlugin for a uri string, loading its bundle if needed */
     const LilvPlugin* getPlugin (const String& uri) const;
 
+    /** Load the bundle containing a plugin if it isn't loaded yet.
+        Returns true if the plugin is available.
+     */
+    bool loadPlugin (const String& uri);
+
+    /** Update the plugin index from the installed bundles. Only new and
+        modified bundles are parsed.
+     */
+    void refreshPluginIndex();
+
+    /** Returns the plugin index. */
+    const LV2PluginIndex& getPluginIndex() const noexcept { return index; }
+
     /** Get all Available Plugins */
     const LilvPlugins* getAllPlugins() const;
 
@@ -92,16 +112,22 @@ public:
         to a plugin instance */
     inline void getFeatures (Array<const LV2_Feature*>& feats) const { features.getFeatures (feats); }
 
-    /** Get a worker thread */
+    /** Get the worker thread with the fewest workers */
     WorkThread& getWorkThread();
 
     /** Returns the total number of available worker threads */
     inline int32 getNumWorkThreads() const { return numThreads; }
 
+    /** Returns queue depth and latency of a worker thread */
+    WorkThread::Stats getWorkThreadStats (int index) const;
+
     /** Returns a plugin's name by URI, or empty if not found */
     String getPluginName (const String& uri) const;
 
-    void getSupportedPlugins (StringArray&) const;
+    /** Add the URIs of supported plugins to a list.
+        @param refresh  If false and an index exists, it is used unchecked.
+     */
+    void getSupportedPlugins (StringArray&, bool refresh = true);
 
     inline SuilHost* getSuilHost() const { return suil; }
 
@@ -128,8 +154,20 @@ private:
     lvtk::Symbols symbolMap;
     LV2FeatureArray features;
 
-    // a simple rotating thread pool
-    int currentThread, numThreads;
+    // lazy loading, see loadPlugin
+    LV2PluginIndex index;
+    File indexFile;
+    StringArray loadedBundles;
+    bool specificationsLoaded = false;
+    bool allLoaded = false;
+
+    const LilvPlugin* findLoadedPlugin (const String& uri) const;
+    void loadBundle (const String& path);
+    void loadSpecifications();
+    LV2PluginIndex::Plugin describePlugin (const LilvPlugin* plugin) const;
+
+    // worker thread pool, see getWorkThread
+    int numThreads;
     OwnedArray<WorkThread> threads;
 };
 
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL3-or-later
 
 #include "nodes/baseprocessor.hpp" // for internal id macros
+#include <element/datapath.hpp>
 #include <element/node.hpp>
 #include <element/session.hpp>
 #include <element/script.hpp>
@@ -350,6 +351,7 @@ void Node::sanitizeProperties (ValueTree node, const bool recursive)
 {
     node.removeProperty (tags::updater, nullptr);
     node.removeProperty (tags::object, nullptr);
+    node.removeProperty (tags::stateDirectory, nullptr);
 
     if (node.hasType (types::Node))
     {
@@ -775,6 +777,14 @@ MidiChannels Node::getMidiChannels() const
     return chans;
 }
 
+File Node::getStateDirectory() const
+{
+    const auto path = objectData.getRoot().getProperty (tags::stateDirectory).toString();
+    const auto base = path.isNotEmpty() ? File (path)
+                                        : DataPath::applicationDataDir().getChildFile ("State");
+    return base.getChildFile (getUuid().toString());
+}
+
 void Node::restorePluginState()
 {
     if (! isValid())
@@ -782,6 +792,7 @@ void Node::restorePluginState()
 
     if (ProcessorPtr obj = getObject())
     {
+        obj->setStateDirectory (getStateDirectory());
         if (auto* const proc = obj->getAudioProcessor())
         {
             const int wantedProgram = objectData.getProperty (tags::program, -1);
@@ -897,6 +908,7 @@ void Node::savePluginState()
     ProcessorPtr obj = getObject();
     if (obj && obj->isPrepared)
     {
+        obj->setStateDirectory (getStateDirectory());
         MemoryBlock state;
 
         if (auto* proc = obj->getAudioProcessor())
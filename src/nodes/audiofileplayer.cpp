@@ -376,6 +376,7 @@ void AudioFilePlayerNode::openFile (const File& file)
 
 void AudioFilePlayerNode::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
 {
+    thread.addTimeSliceClient (&scheduling);
     thread.startThread();
     formats.registerBasicFormats();
     player.prepareToPlay (maximumExpectedSamplesPerBlock, sampleRate);
@@ -408,6 +409,7 @@ void AudioFilePlayerNode::releaseResources()
     player.releaseResources();
     player.setSource (nullptr);
     formats.clearFormats();
+    thread.removeTimeSliceClient (&scheduling);
     thread.stopThread (14);
 }
 
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "engine/threadscheduler.hpp"
 #include "nodes/baseprocessor.hpp"
 #include <element/signals.hpp>
 
@@ -140,6 +141,7 @@ protected:
 
 private:
     TimeSliceThread thread { "MediaPlayer" };
+    ThreadScheduler::TimeSliceClient scheduling { ThreadScheduler::Disk };
     std::unique_ptr<AudioFormatReaderSource> reader;
     AudioFormatManager formats;
     AudioTransportSource player;
@@ -10,21 +10,18 @@ namespace element {
 
 //=============================================================================
 class AudioProcessorNodeParameter : public Parameter,
-                                    private AudioProcessorParameter::Listener,
-                                    private Parameter::Listener
+                                    private AudioProcessorParameter::Listener
 {
 public:
     AudioProcessorNodeParameter (AudioProcessorParameter& p)
         : param (p)
     {
         param.addListener (this);
-        addListener (this);
     }
 
     ~AudioProcessorNodeParameter()
     {
         param.removeListener (this);
-        removeListener (this);
     }
 
     int getPortIndex() const noexcept override { return portIndex; }
@@ -52,7 +49,8 @@ private:
     int portIndex = -1;
     bool ignoreChanges { false };
 
-    void controlValueChanged (int /*index*/, float value) override
+    // forwards without taking the listener lock, this runs on the audio thread
+    void handleValueChanged (float value) override
     {
         if (ignoreChanges)
             return;
@@ -60,7 +58,7 @@ private:
         param.sendValueChangedMessageToListeners (value);
     }
 
-    void controlTouched (int /*index*/, bool grabbed) override
+    void handleGestureChanged (bool grabbed) override
     {
         if (ignoreChanges)
             return;
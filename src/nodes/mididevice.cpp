@@ -194,34 +194,25 @@ void MidiDeviceProcessor::setDevice (const MidiDeviceInfo& newDevice)
 
     if (inputDevice)
     {
-        midi.removeMidiInputCallback (this);
-        if (deviceWanted.identifier.isNotEmpty())
-        {
-            midi.addMidiInputCallback (deviceWanted, this, true);
+        auto* const newHub = midi.acquireInputHub (deviceWanted);
+        auto* const oldHub = inputHub.exchange (newHub);
+        waitForRendering();
+        midi.releaseInputHub (oldHub);
+        if (newHub != nullptr)
             device = deviceWanted;
-        }
+        else
+            DBG ("[element] could not open MIDI input: " << deviceWanted.name);
     }
     else
     {
-        if (output)
-        {
-            output->stopBackgroundThread();
-            output->clearAllPendingMessages();
-            output.reset();
-        }
-
-        output = MidiOutput::openDevice (deviceWanted.identifier);
-
-        if (output)
-        {
-            output->clearAllPendingMessages();
-            output->startBackgroundThread();
+        auto* const newHub = midi.acquireOutputHub (deviceWanted);
+        auto* const oldHub = outputHub.exchange (newHub);
+        waitForRendering();
+        midi.releaseOutputHub (oldHub);
+        if (newHub != nullptr)
             device = deviceWanted;
-        }
         else
-        {
             DBG ("[element] could not open MIDI output: " << deviceWanted.name);
-        }
     }
 
     if (! isDeviceOpen())
@@ -244,23 +235,12 @@ Result MidiDeviceProcessor::closeDevice()
     const bool wasSuspended = isSuspended();
     suspendProcessing (true);
 
-    if (inputDevice)
-    {
-        midi.removeMidiInputCallback (this);
-    }
-    else
-    {
-        if (output)
-        {
-            output->clearAllPendingMessages();
-            std::unique_ptr<MidiOutput> closer;
-            {
-                ScopedLock sl (getCallbackLock());
-                std::swap (output, closer);
-            }
-            closer.reset();
-        }
-    }
+    auto* const oldInput = inputHub.exchange (nullptr);
+    auto* const oldOutput = outputHub.exchange (nullptr);
+    waitForRendering();
+
+    midi.releaseInputHub (oldInput);
+    midi.releaseOutputHub (oldOutput);
 
     suspendProcessing (wasSuspended);
     device.identifier.clear();
@@ -270,13 +250,15 @@ Result MidiDeviceProcessor::closeDevice()
 
 bool MidiDeviceProcessor::isDeviceOpen() const
 {
-    if (inputDevice)
-    {
-        return device.identifier.isNotEmpty() && deviceWanted.identifier == device.identifier;
-    }
+    return inputDevice ? inputHub.load() != nullptr : outputHub.load() != nullptr;
+}
 
-    ScopedLock sl (getCallbackLock());
-    return output != nullptr;
+void MidiDeviceProcessor::waitForRendering() const
+{
+    // a block that started before the swap may still hold the old hub, any
+    // later one sees the new hub. Blocks are short, so is the wait.
+    while (numRendering.load() > 0)
+        Thread::yield();
 }
 
 void MidiDeviceProcessor::reload()
@@ -291,7 +273,6 @@ String MidiDeviceProcessor::getDeviceName() const noexcept
 
 void MidiDeviceProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
 {
-    inputMessages.reset (sampleRate);
     if (prepared)
         return;
 
@@ -309,32 +290,35 @@ void MidiDeviceProcessor::prepareToPlay (double sampleRate, int maximumExpectedS
 void MidiDeviceProcessor::processBlock (AudioBuffer<float>& audio, MidiBuffer& midi)
 {
     const auto nframes = audio.getNumSamples();
+
+    // counted while a hub is in use, so a swapped out hub is only released
+    // after this block. Nothing here waits on the message thread.
+    numRendering.fetch_add (1);
+
     if (inputDevice)
     {
-        midi.clear (0, nframes);
-        inputMessages.removeNextBlockOfMessages (midi, nframes);
+        midi.clear();
+        if (auto* const hub = inputHub.load())
+            midi.addEvents (hub->getBlock (nframes), 0, nframes, 0);
     }
     else
     {
-        if (output && ! midi.isEmpty())
+        auto* const hub = outputHub.load();
+        if (hub != nullptr && ! midi.isEmpty())
         {
             const auto delayMs = midiOutLatency.get();
-#if JUCE_WINDOWS
-            output->sendBlockOfMessagesNow (midi);
-#else
-            output->sendBlockOfMessages (
-                midi, delayMs + Time::getMillisecondCounterHiRes(), getSampleRate());
-#endif
+            hub->send (midi, nframes, delayMs + Time::getMillisecondCounterHiRes(), getSampleRate());
         }
 
         midi.clear (0, nframes);
     }
+
+    numRendering.fetch_sub (1);
 }
 
 void MidiDeviceProcessor::releaseResources()
 {
     prepared = false;
-    inputMessages.reset (getSampleRate());
 }
 
 AudioProcessorEditor* MidiDeviceProcessor::createEditor()
@@ -377,21 +361,9 @@ void MidiDeviceProcessor::setStateInformation (const void* data, int size)
     setDevice (info);
 }
 
-void MidiDeviceProcessor::handleIncomingMidiMessage (MidiInput* source, const MidiMessage& message)
-{
-    if (message.isActiveSense())
-        return;
-    inputMessages.addMessageToQueue (message);
-}
-
-void MidiDeviceProcessor::handlePartialSysexMessage (MidiInput* source, const uint8* messageData, int numBytesSoFar, double timestamp)
-{
-    ignoreUnused (source, messageData, numBytesSoFar, timestamp);
-}
-
 Array<MidiDeviceInfo> MidiDeviceProcessor::getAvailableDevices() const noexcept
 {
-    const auto devlist = input ? MidiInput::getAvailableDevices()
+    const auto devlist = inputDevice ? MidiInput::getAvailableDevices()
                                : MidiOutput::getAvailableDevices();
     return devlist;
 }
@@ -3,15 +3,23 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <element/signals.hpp>
 #include "nodes/baseprocessor.hpp"
 
 namespace element {
 
 class MidiEngine;
+class MidiInputHub;
+class MidiOutputHub;
+
+/** A MIDI input or output device in a graph.
 
+    Nodes don't open devices themselves, they subscribe to the device's hub
+    in MidiEngine.  Any number of nodes may share one device.
+ */
 class MidiDeviceProcessor : public BaseProcessor,
-                            public MidiInputCallback,
                             private Timer
 {
 public:
@@ -92,14 +100,6 @@ public:
     }
     void changeProgramName (int index, const String& newName) override { ignoreUnused (index, newName); }
 
-    void handleIncomingMidiMessage (MidiInput* source,
-                                    const MidiMessage& message) override;
-
-    void handlePartialSysexMessage (MidiInput* source,
-                                    const uint8* messageData,
-                                    int numBytesSoFar,
-                                    double timestamp) override;
-
     inline bool canAddBus (bool isInput) const override
     {
         ignoreUnused (isInput);
@@ -152,11 +152,14 @@ private:
     bool prepared = false;
     MidiDeviceInfo device; // actual device name in use;
     MidiDeviceInfo deviceWanted; // The device as saved in Stage and chosen by users.
-    MidiMessageCollector inputMessages;
-    std::unique_ptr<MidiInput> input;
-    std::unique_ptr<MidiOutput> output;
+    // swapped on the message thread, released once no block is rendering
+    std::atomic<MidiInputHub*> inputHub { nullptr };
+    std::atomic<MidiOutputHub*> outputHub { nullptr };
+    std::atomic<int> numRendering { 0 };
     Atomic<double> midiOutLatency { 0.0 };
 
+    void waitForRendering() const;
+
     void waitForDevice() {}
     void timerCallback() override;
     bool deviceIsAvailable (const String& name);
@@ -8,113 +8,47 @@ namespace element {
 MidiMonitorNode::MidiMonitorNode()
     : MidiFilterNode (0)
 {
-    midiTemp.ensureSize (3 * 32);
 }
 
-MidiMonitorNode::~MidiMonitorNode()
-{
-    stopTimer();
-    clearMessages();
-}
+MidiMonitorNode::~MidiMonitorNode() {}
 
 void MidiMonitorNode::prepareToRender (double sampleRate, int maxBufferSize)
 {
-    inputMessages.reset (sampleRate);
+    ignoreUnused (maxBufferSize);
     currentSampleRate = sampleRate;
-    numSamples = 0;
-    startTimerHz (refreshRateHz);
 };
 
-void MidiMonitorNode::releaseResources()
-{
-    stopTimer();
-}
+void MidiMonitorNode::releaseResources() {}
 
 void MidiMonitorNode::render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampleBuffer&)
 {
-    auto timestamp = Time::getMillisecondCounterHiRes();
     const auto nframes = audio.getNumSamples();
-
     if (nframes == 0)
         return;
 
-    auto* const midiIn = midi.getWriteBuffer (0);
-
-    for (auto m : *midiIn)
-    {
-        auto msg = m.getMessage();
-        msg.setTimeStamp (timestamp + (1000.0 * (static_cast<double> (m.samplePosition) / currentSampleRate)));
-        inputMessages.addMessageToQueue (msg);
-    }
-
-    ScopedLock sl (lock);
-    numSamples += nframes;
-}
-
-void MidiMonitorNode::getMessages (MidiBuffer& destBuffer)
-{
-    ScopedLock sl (lock);
-    if (numSamples <= 0)
+    const auto* const midiIn = midi.getReadBuffer (0);
+    if (midiIn->isEmpty())
         return;
-    inputMessages.removeNextBlockOfMessages (destBuffer, numSamples);
-    numSamples = 0;
+
+    const auto timestamp = Time::getMillisecondCounterHiRes();
+    const auto msPerSample = 1000.0 / currentSampleRate;
+    for (const auto m : *midiIn)
+        capture.capture (timestamp + msPerSample * (double) m.samplePosition, m.data, m.numBytes);
 }
 
-void MidiMonitorNode::clearMessages()
+void MidiMonitorNode::getState (MemoryBlock& block)
 {
-    midiLog.clearQuick();
-    {
-        ScopedLock sl (lock);
-        inputMessages.reset (currentSampleRate);
-        numSamples = 0;
-    }
-    messagesLogged();
+    ValueTree state ("state");
+    state.setProperty ("captureTypes", (int) capture.getTypeMask(), nullptr);
+    MemoryOutputStream stream (block, false);
+    state.writeToStream (stream);
 }
 
-void MidiMonitorNode::timerCallback()
+void MidiMonitorNode::setState (const void* data, int size)
 {
-    midiTemp.clear();
-    getMessages (midiTemp);
-    if (midiTemp.getNumEvents() <= 0)
-        return;
-
-    int numLogged = 0;
-    String text;
-    for (auto m : midiTemp)
-    {
-        auto msg = m.getMessage();
-        if (msg.isMidiClock())
-        {
-            text.clear();
-            continue;
-        }
-
-        if (msg.isMidiStart())
-            text << "Start";
-        else if (msg.isMidiStop())
-            text << "Stop";
-        else if (msg.isMidiContinue())
-            text << "Continue";
-
-        if (msg.isNoteOn())
-        {
-            text << "NOTE ON: " << msg.getNoteNumber();
-        }
-        else if (msg.isNoteOff())
-        {
-            text << "NOTE OFF: " << msg.getNoteNumber();
-        }
-
-        midiLog.add (text.isNotEmpty() ? text : msg.getDescription());
-        text.clear();
-        ++numLogged;
-    }
-
-    if (midiLog.size() > maxLoggedMessages)
-        midiLog.removeRange (0, midiLog.size() - maxLoggedMessages);
-
-    if (numLogged > 0)
-        messagesLogged();
+    const auto state = ValueTree::readFromData (data, (size_t) size);
+    if (state.isValid())
+        capture.setTypeMask ((uint32) (int) state.getProperty ("captureTypes", (int) MidiCaptureRing::defaultTypes));
 }
 
 }; // namespace element
@@ -6,12 +6,14 @@
 #include <element/midipipe.hpp>
 #include "nodes/baseprocessor.hpp"
 #include "nodes/midifilter.hpp"
-#include <element/signals.hpp>
+#include "engine/midicapturering.hpp"
 
 namespace element {
 
-class MidiMonitorNode : public MidiFilterNode,
-                        private Timer
+/** Captures MIDI passing through for display. The editor reads the
+    capture ring at its own rate, the audio thread never waits on it.
+ */
+class MidiMonitorNode : public MidiFilterNode
 {
 public:
     MidiMonitorNode();
@@ -50,30 +52,18 @@ public:
     void releaseResources() override;
 
     void render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampleBuffer&) override;
+    bool isMidiReadOnly() const override { return true; }
 
-    void setState (const void* data, int size) override {};
-    void getState (MemoryBlock& block) override {};
+    void setState (const void* data, int size) override;
+    void getState (MemoryBlock& block) override;
 
-    void clearMessages();
-
-    const StringArray& logger() const { return midiLog; }
+    /** Returns the ring messages are captured in. */
+    MidiCaptureRing& getCaptureRing() noexcept { return capture; }
 
 private:
-    friend class MidiMonitorNodeEditor;
-    Signal<void()> messagesLogged;
     double currentSampleRate = 44100.0;
-    int numSamples = 0;
-    MidiMessageCollector inputMessages;
     bool createdPorts = false;
-    CriticalSection lock;
-
-    MidiBuffer midiTemp;
-    StringArray midiLog;
-    int maxLoggedMessages { 100 };
-    float refreshRateHz { 60.0 };
-
-    void getMessages (MidiBuffer& destBuffer);
-    void timerCallback() override;
+    MidiCaptureRing capture { 1024 };
 };
 
 } // namespace element
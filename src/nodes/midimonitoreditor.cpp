@@ -10,52 +10,109 @@ namespace element {
 
 using MidiMonitorNodePtr = ReferenceCountedObjectPtr<MidiMonitorNode>;
 
+namespace detail {
+static String describeCapturedMessage (const MidiCaptureRing::Message& captured)
+{
+    if (captured.data[0] == 0xf0)
+        return "SysEx: " + String (captured.size) + " bytes";
+
+    const MidiMessage msg (captured.data, captured.getNumStoredBytes(), captured.time);
+    if (msg.isMidiStart())
+        return "Start";
+    if (msg.isMidiStop())
+        return "Stop";
+    if (msg.isMidiContinue())
+        return "Continue";
+    if (msg.isNoteOn())
+        return "NOTE ON: " + String (msg.getNoteNumber());
+    if (msg.isNoteOff())
+        return "NOTE OFF: " + String (msg.getNoteNumber());
+    return msg.getDescription();
+}
+} // namespace detail
+
 class MidiMonitorNodeEditor::Logger : public ListBox,
-                                      public ListBoxModel,
-                                      public AsyncUpdater
+                                      public ListBoxModel
 {
 public:
+    /** Most lines added per display update, the rest are summarized. */
+    static constexpr int maxLinesPerUpdate = 32;
+
     /** Constructor */
     Logger (MidiMonitorNodePtr n)
         : node (n)
     {
         jassert (node != nullptr);
         setModel (this);
-        connection = node->messagesLogged.connect (
-            std::bind (&Logger::triggerAsyncUpdate, this));
+        position = node->getCaptureRing().getWritePosition();
+        lastTotal = node->getCaptureRing().getTotalCount();
     }
 
     /** Destructor */
     ~Logger()
     {
-        connection.disconnect();
         node = nullptr;
     }
 
-    int getNumRows() override { return node->logger().size(); }
+    int getNumRows() override { return midiLog.size(); }
 
     void paintListBoxItem (int row, Graphics& g, int width, int height, bool rowIsSelected) override
     {
-        const auto& logList = node->logger();
         ignoreUnused (rowIsSelected);
         g.setFont (Font (Font::getDefaultMonospacedFontName(),
                          g.getCurrentFont().getHeight(),
                          Font::plain));
-        if (isPositiveAndBelow (row, logList.size()))
-            ViewHelpers::drawBasicTextRow (logList[row], g, width, height, false);
+        if (isPositiveAndBelow (row, midiLog.size()))
+            ViewHelpers::drawBasicTextRow (midiLog[row], g, width, height, false);
+    }
+
+    /** Read new messages from the ring. Returns the message rate per second. */
+    double update (double elapsedSeconds)
+    {
+        auto& ring = node->getCaptureRing();
+
+        pending.clearQuick();
+        const auto missed = ring.read (position, [this] (const MidiCaptureRing::Message& m) {
+            pending.add (m);
+        });
+
+        const auto skipped = (int64) missed + jmax (0, pending.size() - maxLinesPerUpdate);
+        if (skipped > 0)
+            midiLog.add ("... " + String (skipped) + " messages");
+        for (int i = jmax (0, pending.size() - maxLinesPerUpdate); i < pending.size(); ++i)
+            midiLog.add (detail::describeCapturedMessage (pending.getReference (i)));
+
+        if (midiLog.size() > maxLoggedMessages)
+            midiLog.removeRange (0, midiLog.size() - maxLoggedMessages);
+
+        if (skipped > 0 || ! pending.isEmpty())
+        {
+            updateContent();
+            scrollToEnsureRowIsOnscreen (midiLog.size() - 1);
+            repaint();
+        }
+
+        const auto total = ring.getTotalCount();
+        const auto rate = elapsedSeconds > 0.0 ? (double) (total - lastTotal) / elapsedSeconds : 0.0;
+        lastTotal = total;
+        return rate;
     }
 
-    void handleAsyncUpdate() override
+    void clear()
     {
-        const auto& logList = node->logger();
+        position = node->getCaptureRing().getWritePosition();
+        midiLog.clearQuick();
         updateContent();
-        scrollToEnsureRowIsOnscreen (logList.size() - 1);
         repaint();
     }
 
 private:
     MidiMonitorNodePtr node;
-    SignalConnection connection;
+    uint64 position = 0;
+    uint64 lastTotal = 0;
+    Array<MidiCaptureRing::Message> pending;
+    StringArray midiLog;
+    int maxLoggedMessages { 100 };
 };
 
 MidiMonitorNodeEditor::MidiMonitorNodeEditor (const Node& node)
@@ -67,25 +124,71 @@ MidiMonitorNodeEditor::MidiMonitorNodeEditor (const Node& node)
 
     addAndMakeVisible (clearButton);
     clearButton.setButtonText ("Clear");
-    clearButton.onClick = [this]() {
-        if (auto* n = getNodeObjectOfType<MidiMonitorNode>())
-            n->clearMessages();
-    };
+    clearButton.onClick = [this]() { logger->clear(); };
+
+    addAndMakeVisible (filterButton);
+    filterButton.setButtonText ("Filter");
+    filterButton.onClick = [this]() { showFilterMenu(); };
+
+    addAndMakeVisible (rateLabel);
+    rateLabel.setFont (Font (12.f));
+    rateLabel.setJustificationType (Justification::centredRight);
 
     setSize (320, 160);
+    lastTickMs = Time::getMillisecondCounterHiRes();
+    startTimerHz (30);
 }
 
 MidiMonitorNodeEditor::~MidiMonitorNodeEditor()
 {
+    stopTimer();
     logger.reset();
 }
 
+void MidiMonitorNodeEditor::timerCallback()
+{
+    // timers run late under load, so use the time that really passed
+    const auto nowMs = Time::getMillisecondCounterHiRes();
+    const auto rate = logger->update ((nowMs - lastTickMs) * 0.001);
+    lastTickMs = nowMs;
+    rateLabel.setText (String (roundToInt (rate)) + " msg/s", dontSendNotification);
+}
+
+void MidiMonitorNodeEditor::showFilterMenu()
+{
+    auto* const node = getNodeObjectOfType<MidiMonitorNode>();
+    if (node == nullptr)
+        return;
+
+    static const char* const names[] = { "Notes", "Controllers", "Programs", "Pitch Bend", "Pressure", "SysEx", "Clock", "System" };
+    static_assert (numElementsInArray (names) == MidiCaptureRing::numTypes, "missing type names");
+
+    auto& ring = node->getCaptureRing();
+    const auto mask = ring.getTypeMask();
+    PopupMenu menu;
+    for (int i = 0; i < MidiCaptureRing::numTypes; ++i)
+        menu.addItem (i + 1, names[i], true, (mask & (1u << i)) != 0);
+
+    menu.showMenuAsync (PopupMenu::Options().withTargetComponent (&filterButton),
+                        [node = MidiMonitorNodePtr (node)] (int result) {
+                            if (result <= 0)
+                                return;
+                            auto& r = node->getCaptureRing();
+                            r.setTypeMask (r.getTypeMask() ^ (1u << (result - 1)));
+                        });
+}
+
 void MidiMonitorNodeEditor::resized()
 {
     auto r1 = getLocalBounds().reduced (4);
+    auto top = r1.removeFromTop (24);
     clearButton.changeWidthToFitText (24);
-    clearButton.setBounds (r1.getX(), r1.getY(), clearButton.getWidth(), clearButton.getHeight());
-    r1.removeFromTop (24 + 2);
+    clearButton.setBounds (top.removeFromLeft (clearButton.getWidth()));
+    top.removeFromLeft (4);
+    filterButton.changeWidthToFitText (24);
+    filterButton.setBounds (top.removeFromLeft (filterButton.getWidth()));
+    rateLabel.setBounds (top);
+    r1.removeFromTop (2);
     logger->setBounds (r1);
 }
 
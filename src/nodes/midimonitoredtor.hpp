@@ -8,7 +8,8 @@
 
 namespace element {
 
-class MidiMonitorNodeEditor : public NodeEditor
+class MidiMonitorNodeEditor : public NodeEditor,
+                              private Timer
 {
 public:
     MidiMonitorNodeEditor (const Node& node);
@@ -20,6 +21,12 @@ private:
     class Logger;
     std::unique_ptr<Logger> logger;
     TextButton clearButton;
+    TextButton filterButton;
+    Label rateLabel;
+    double lastTickMs = 0.0;
+
+    void showFilterMenu();
+    void timerCallback() override;
 };
 
 } // namespace element
@@ -8,29 +8,46 @@
 namespace element {
 
 MidiProgramMapNode::MidiProgramMapNode()
-    : MidiFilterNode (0) {}
+    : MidiFilterNode (0)
+{
+    publishTable();
+}
 
 MidiProgramMapNode::~MidiProgramMapNode() {}
 
 void MidiProgramMapNode::clear()
 {
     entries.clearQuick (true);
-    ScopedLock sl (lock);
-    for (int i = 0; i < 128; ++i)
-        programMap[i] = -1;
+    publishTable();
 }
 
-void MidiProgramMapNode::prepareToRender (double sampleRate, int maxBufferSize)
+void MidiProgramMapNode::publishTable()
 {
-    ignoreUnused (sampleRate, maxBufferSize);
+    auto next = std::make_unique<ProgramTable>();
+    std::memset (next->programs, -1, sizeof (next->programs));
 
+    // omni entries first so channel specific ones override them
+    for (int pass = 0; pass < 2; ++pass)
     {
-        ScopedLock sl (lock);
-        for (int i = 0; i < 128; ++i)
-            programMap[i] = -1;
         for (const auto* const entry : entries)
-            programMap[entry->in] = entry->out;
+        {
+            if ((entry->channel > 0) != (pass == 1))
+                continue;
+            if (! isPositiveAndBelow (entry->in, 128) || ! isPositiveAndBelow (entry->out, 128))
+                continue;
+
+            for (int ch = 0; ch < 16; ++ch)
+                if (entry->channel <= 0 || entry->channel == ch + 1)
+                    next->programs[ch][entry->in] = (int8) entry->out;
+        }
     }
+
+    table.publish (std::move (next));
+}
+
+void MidiProgramMapNode::prepareToRender (double sampleRate, int maxBufferSize)
+{
+    ignoreUnused (sampleRate, maxBufferSize);
 }
 
 void MidiProgramMapNode::releaseResources() {}
@@ -51,55 +68,60 @@ void MidiProgramMapNode::render (AudioSampleBuffer& audio, MidiPipe& midi, Audio
 
     auto* const midiIn = midi.getWriteBuffer (0);
 
-    ScopedLock sl (lock);
-    MidiMessage msg;
-
-    if (! toSendMidi.isEmpty())
+    if (sendFifo.getNumReady() > 0)
     {
-        for (auto m : toSendMidi)
-            midiIn->addEvent (m.data, m.numBytes, m.samplePosition);
-        toSendMidi.clear();
+        const auto scope = sendFifo.read (sendFifo.getNumReady());
+        scope.forEach ([this, midiIn] (int index) {
+            const auto packed = sendQueue[(size_t) index];
+            const uint8 data[2] = { (uint8) (0xc0 | ((packed >> 8) & 0x0f)), (uint8) (packed & 0x7f) };
+            midiIn->addEvent (data, 2, 0);
+        });
     }
 
+    if (midiIn->isEmpty())
+        return;
+
     int program = -1;
 
-    for (auto m : *midiIn)
+    const SharedTable<ProgramTable>::ScopedReader reader (table);
+    if (const auto* const programs = reader.get())
     {
-        msg = m.getMessage();
-        if (msg.isProgramChange() && programMap[msg.getProgramChangeNumber()] >= 0)
+        // only program changes are touched, rewritten in place
+        for (const auto m : *midiIn)
         {
-            program = msg.getProgramChangeNumber();
-            tempMidi.addEvent (MidiMessage::programChange (
-                                   msg.getChannel(), programMap[msg.getProgramChangeNumber()]),
-                               m.samplePosition);
-        }
-        else
-        {
-            tempMidi.addEvent (msg, m.samplePosition);
+            if (m.numBytes < 2 || (m.data[0] & 0xf0) != 0xc0)
+                continue;
+
+            const auto in = (int) (m.data[1] & 0x7f);
+            const auto out = programs->programs[m.data[0] & 0x0f][in];
+            if (out < 0)
+                continue;
+
+            program = in;
+            const_cast<uint8*> (m.data)[1] = (uint8) out;
         }
     }
 
-    if (program >= 0 && program != lastProgram)
+    if (program >= 0 && program != lastProgram.load (std::memory_order_relaxed))
     {
-        lastProgram = program;
+        lastProgram.store (program, std::memory_order_relaxed);
         triggerAsyncUpdate();
     }
-
-    midiIn->swapWith (tempMidi);
-    // traceMidi (*midiIn);
-    tempMidi.clear();
 }
 
 void MidiProgramMapNode::sendProgramChange (int program, int channel)
 {
-    const auto msg (MidiMessage::programChange (channel, program));
-    ScopedLock sl (lock);
-    toSendMidi.addEvent (msg, 0);
+    if (! isPositiveAndBelow (program, 128) || channel < 1 || channel > 16)
+        return;
+
+    const auto scope = sendFifo.write (1);
+    if (scope.blockSize1 > 0) // dropped when full
+        sendQueue[(size_t) scope.startIndex1] = (uint16) (((channel - 1) << 8) | program);
 }
 
 int MidiProgramMapNode::getNumProgramEntries() const { return entries.size(); }
 
-void MidiProgramMapNode::addProgramEntry (const String& name, int programIn, int programOut)
+void MidiProgramMapNode::addProgramEntry (const String& name, int programIn, int programOut, int channel)
 {
     if (programIn < 0)
         programIn = 0;
@@ -109,11 +131,12 @@ void MidiProgramMapNode::addProgramEntry (const String& name, int programIn, int
         programOut = programIn;
     if (programOut > 127)
         programOut = 127;
+    channel = jlimit (0, 16, channel);
 
     ProgramEntry* entry = nullptr;
     for (auto* e : entries)
     {
-        if (e->in == programIn)
+        if (e->in == programIn && e->channel == channel)
         {
             entry = e;
             break;
@@ -128,10 +151,9 @@ void MidiProgramMapNode::addProgramEntry (const String& name, int programIn, int
     entry->name = name;
     entry->in = programIn;
     entry->out = programOut;
+    entry->channel = channel;
+    publishTable();
     sendChangeMessage();
-
-    ScopedLock sl (lock);
-    programMap[entry->in] = entry->out;
 }
 
 void MidiProgramMapNode::editProgramEntry (int index, const String& name, int inProgram, int outProgram)
@@ -141,8 +163,7 @@ void MidiProgramMapNode::editProgramEntry (int index, const String& name, int in
         entry->name = name.isNotEmpty() ? name : entry->name;
         entry->in = inProgram;
         entry->out = outProgram;
-        ScopedLock sl (lock);
-        programMap[entry->in] = entry->out;
+        publishTable();
         sendChangeMessage();
     }
 }
@@ -154,8 +175,7 @@ void MidiProgramMapNode::removeProgramEntry (int index)
     {
         entries.remove (index, false);
         deleter.reset (entry);
-        ScopedLock sl (lock);
-        programMap[entry->in] = -1;
+        publishTable();
         sendChangeMessage();
     }
 }
@@ -6,6 +6,7 @@
 #include "nodes/midifilter.hpp"
 #include <element/midipipe.hpp>
 #include "nodes/baseprocessor.hpp"
+#include "engine/sharedtable.hpp"
 #include <element/signals.hpp>
 
 namespace element {
@@ -20,6 +21,7 @@ public:
         String name;
         int in;
         int out;
+        int channel = 0; ///< MIDI channel 1-16 the entry applies to, or 0 for all.
     };
 
     MidiProgramMapNode();
@@ -46,9 +48,14 @@ public:
     void releaseResources() override;
 
     void render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampleBuffer&) override;
+
+    /** Queue a program change to send at the start of the next block. Call
+        from a single thread, normally the message thread.
+     */
     void sendProgramChange (int program, int channel);
+
     int getNumProgramEntries() const;
-    void addProgramEntry (const String& name, int programIn, int programOut = -1);
+    void addProgramEntry (const String& name, int programIn, int programOut = -1, int channel = 0);
     void removeProgramEntry (int index);
     void editProgramEntry (int index, const String& name, int inProgram, int outProgram);
     ProgramEntry getProgramEntry (int index) const;
@@ -68,11 +75,7 @@ public:
         fontSize = jlimit (9.f, 72.f, newSize);
     }
 
-    inline int getLastProgram() const
-    {
-        ScopedLock sl (lock);
-        return lastProgram;
-    }
+    inline int getLastProgram() const { return lastProgram.load (std::memory_order_relaxed); }
 
     void setState (const void* data, int size) override
     {
@@ -93,14 +96,10 @@ public:
             entry->name = e["name"].toString();
             entry->in = (int) e["in"];
             entry->out = (int) e["out"];
+            entry->channel = jlimit (0, 16, (int) e.getProperty ("channel", 0));
         }
 
-        {
-            ScopedLock sl (lock);
-            for (const auto* const entry : entries)
-                programMap[entry->in] = entry->out;
-        }
-
+        publishTable();
         sendChangeMessage();
     }
 
@@ -116,6 +115,8 @@ public:
             e.setProperty ("name", entry->name, nullptr)
                 .setProperty ("in", entry->in, nullptr)
                 .setProperty ("out", entry->out, nullptr);
+            if (entry->channel > 0)
+                e.setProperty ("channel", entry->channel, nullptr);
             tree.appendChild (e, nullptr);
         }
 
@@ -131,20 +132,31 @@ public:
     Signal<void()> lastProgramChanged;
 
 protected:
-    CriticalSection lock;
     OwnedArray<ProgramEntry> entries;
-    int programMap[128];
+
+    /** Entries compiled to an output program per channel and input program,
+        -1 where unmapped. Immutable once published.
+     */
+    struct ProgramTable
+    {
+        int8 programs[16][128];
+    };
+
+    SharedTable<ProgramTable> table;
+    void publishTable();
+
+    // program changes from sendProgramChange(), packed as channel << 8 | program
+    static constexpr int sendQueueSize = 64;
+    AbstractFifo sendFifo { sendQueueSize };
+    std::array<uint16, sendQueueSize> sendQueue {};
 
     bool assertedLowChannels = false;
     bool createdPorts = false;
-    MidiBuffer* buffers[16];
-    MidiBuffer tempMidi;
-    MidiBuffer toSendMidi;
 
     int width = 360;
     int height = 540;
     float fontSize = 15.f;
-    int lastProgram = -1;
+    std::atomic<int> lastProgram { -1 };
 
     inline void refreshPorts() override
     {
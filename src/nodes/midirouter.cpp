@@ -1,6 +1,7 @@
 // Copyright 2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include "engine/graphnode.hpp"
 #include "nodes/baseprocessor.hpp"
 #include "nodes/midirouter.hpp"
 #include <element/midipipe.hpp>
@@ -14,10 +15,11 @@ MidiRouterNode::MidiRouterNode (int ins, int outs)
     : Processor (0),
       numSources (ins),
       numDestinations (outs),
-      state (ins, outs),
-      toggles (ins, outs),
-      nextToggles (ins, outs)
+      state (ins, outs)
 {
+    sourceCursors.allocate ((size_t) ins, true);
+    sourceEnds.allocate ((size_t) ins, true);
+    filters.resize (ins * outs);
     clearPatches();
     initMidiOuts (midiOuts);
 
@@ -65,23 +67,97 @@ void MidiRouterNode::setCurrentProgram (int index)
 void MidiRouterNode::setMatrixState (const MatrixState& matrix)
 {
     jassert (state.sameSizeAs (matrix));
-    state = matrix;
-    ToggleGrid newPatches (state);
-
     {
         ScopedLock sl (getLock());
-        toggles.swapWith (newPatches);
-        togglesChanged = true; // initiate the crossfade
+        state = matrix;
     }
 
+    publishRoutes();
     sendChangeMessage();
 }
 
+void MidiRouterNode::setRouteFilter (int src, int dst, const RouteFilter& filter)
+{
+    jassert (isPositiveAndBelow (src, numSources) && isPositiveAndBelow (dst, numDestinations));
+    {
+        ScopedLock sl (getLock());
+        filters.set (src * numDestinations + dst, filter);
+    }
+
+    publishRoutes();
+}
+
+MidiRouterNode::RouteFilter MidiRouterNode::getRouteFilter (int src, int dst) const
+{
+    ScopedLock sl (lock);
+    return filters[src * numDestinations + dst];
+}
+
+void MidiRouterNode::publishRoutes()
+{
+    auto table = std::make_unique<RoutingTable>();
+    table->starts.allocate ((size_t) numSources + 1, true);
+
+    {
+        ScopedLock sl (getLock());
+        for (int src = 0; src < numSources; ++src)
+        {
+            table->starts[src] = table->routes.size();
+            for (int dst = 0; dst < numDestinations; ++dst)
+            {
+                if (! state.connected (src, dst))
+                    continue;
+
+                const auto& filter = filters.getReference (src * numDestinations + dst);
+                int filterIndex = -1;
+                if (! filter.passesAll())
+                {
+                    filterIndex = table->filters.size();
+                    table->filters.add (filter);
+                }
+
+                table->routes.add (RoutingTable::Route { dst, filterIndex });
+            }
+        }
+
+        table->starts[numSources] = table->routes.size();
+    }
+
+    routing.publish (std::move (table));
+}
+
 MatrixState MidiRouterNode::getMatrixState() const
 {
     return state;
 }
 
+void MidiRouterNode::prepareToRender (double sampleRate, int maxBufferSize)
+{
+    ignoreUnused (sampleRate, maxBufferSize);
+    if (auto* graph = getParentGraph())
+    {
+        midiOutEvents = graph->getMidiEventCapacity();
+        midiOutBytes = graph->getMidiByteCapacity();
+    }
+
+    for (auto* out : midiOuts)
+        out->ensureSize (MidiEventBuffer::getMidiBufferSize (midiOutEvents, midiOutBytes));
+}
+
+namespace {
+constexpr int midiHeaderSize = (int) (sizeof (int32) + sizeof (uint16));
+
+/** Append an event to a MidiBuffer whose events are all at or before sampleOffset. */
+inline void appendMidiEvent (MidiBuffer& dest, const uint8* data, int size, int sampleOffset) noexcept
+{
+    uint8 header[midiHeaderSize];
+    writeUnaligned<int32> (header, sampleOffset);
+    writeUnaligned<uint16> (header + sizeof (int32), (uint16) size);
+    dest.data.addArray (header, midiHeaderSize);
+    dest.data.addArray (data, size);
+}
+} // namespace
+
 void MidiRouterNode::render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampleBuffer&)
 {
     jassert (midi.getNumBuffers() >= numDestinations);
@@ -90,30 +166,108 @@ void MidiRouterNode::render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSamp
     const auto nbuffers = midi.getNumBuffers();
     audio.clear();
 
-    ScopedLock sl (getLock());
-    for (int src = 0; src < numSources; ++src)
+    for (auto* out : midiOuts)
+        out->clear();
+
+    int numEvents = 0, numBytes = 0;
+    const SharedTable<RoutingTable>::ScopedReader reader (routing);
+    if (const auto* const table = reader.get())
     {
-        if (src >= nbuffers)
-            break;
+        const auto* const routes = table->routes.begin();
+        const auto* const routeFilters = table->filters.begin();
+        const int nsources = jmin (numSources, nbuffers);
 
-        const auto& rb = *midi.getReadBuffer (src);
-        for (int dst = 0; dst < numDestinations; ++dst)
-            if (toggles.get (src, dst))
-                midiOuts.getUnchecked (dst)->addEvents (rb, 0, nsamples, 0);
+        for (int src = 0; src < nsources; ++src)
+        {
+            const auto& data = midi.getReadBuffer (src)->data;
+            sourceCursors[src] = data.begin();
+            sourceEnds[src] = table->starts[src] < table->starts[src + 1] ? data.end() : data.begin();
+        }
+
+        // take events from the sources in time order, so every output is
+        // appended to in order.  Ties go to the lower source.
+        for (;;)
+        {
+            int src = -1, position = 0;
+            for (int s = 0; s < nsources; ++s)
+            {
+                if (sourceCursors[s] >= sourceEnds[s])
+                    continue;
+                const auto time = readUnaligned<int32> (sourceCursors[s]);
+                if (src < 0 || time < position)
+                {
+                    src = s;
+                    position = time;
+                }
+            }
+
+            if (src < 0 || position >= nsamples)
+                break;
+
+            auto& cursor = sourceCursors[src];
+            const auto size = (int) readUnaligned<uint16> (cursor + sizeof (int32));
+            const auto* const bytes = cursor + midiHeaderSize;
+            cursor += midiHeaderSize + size;
+            if (position < 0)
+                continue;
+
+            for (int r = table->starts[src]; r < table->starts[src + 1]; ++r)
+            {
+                const auto& route = routes[r];
+                if (route.filter < 0 || routeFilters[route.filter].accepts (bytes, size))
+                {
+                    appendMidiEvent (*midiOuts.getUnchecked (route.destination), bytes, size, position);
+                    ++numEvents;
+                    numBytes += size;
+                }
+            }
+        }
     }
 
-    for (int i = midiOuts.size(); --i >= 0;)
+    // MidiBuffer grows rather than dropping events, tell the graph so it
+    // can size its buffers for this much traffic.
+    const auto reserved = (int) MidiEventBuffer::getMidiBufferSize (midiOutEvents, midiOutBytes);
+    for (const auto* out : midiOuts)
     {
-        auto* const ob = midiOuts.getUnchecked (i);
-        ob->swapWith (*midi.getWriteBuffer (i));
-        ob->clear();
+        if (out->data.size() > reserved)
+        {
+            if (auto* graph = getParentGraph())
+                graph->reportMidiOverflow (jmax (1, numEvents - midiOutEvents), numEvents, numBytes);
+            break;
+        }
     }
+
+    for (int i = jmin (midiOuts.size(), nbuffers); --i >= 0;)
+        midiOuts.getUnchecked (i)->swapWith (*midi.getWriteBuffer (i));
 }
 
 void MidiRouterNode::getState (MemoryBlock& block)
 {
+    ValueTree tree;
+    {
+        ScopedLock sl (getLock());
+        tree = state.createValueTree();
+        for (int src = 0; src < numSources; ++src)
+        {
+            for (int dst = 0; dst < numDestinations; ++dst)
+            {
+                const auto& filter = filters.getReference (src * numDestinations + dst);
+                if (filter.passesAll())
+                    continue;
+                ValueTree child ("filter");
+                child.setProperty ("source", src, nullptr)
+                    .setProperty ("destination", dst, nullptr)
+                    .setProperty ("channels", (int) filter.channels, nullptr)
+                    .setProperty ("lowNote", (int) filter.lowNote, nullptr)
+                    .setProperty ("highNote", (int) filter.highNote, nullptr)
+                    .setProperty ("types", (int) filter.types, nullptr);
+                tree.appendChild (child, nullptr);
+            }
+        }
+    }
+
     MemoryOutputStream stream (block, false);
-    state.createValueTree().writeToStream (stream);
+    tree.writeToStream (stream);
 }
 
 void MidiRouterNode::setState (const void* data, int sizeInBytes)
@@ -125,44 +279,59 @@ void MidiRouterNode::setState (const void* data, int sizeInBytes)
         MatrixState matrix;
         matrix.restoreFromValueTree (tree);
         jassert (matrix.getNumRows() == numSources && matrix.getNumColumns() == numDestinations);
+
+        {
+            ScopedLock sl (getLock());
+            filters.fill (RouteFilter());
+            for (const auto& child : tree)
+            {
+                if (! child.hasType ("filter"))
+                    continue;
+                const int src = child.getProperty ("source", -1);
+                const int dst = child.getProperty ("destination", -1);
+                if (! isPositiveAndBelow (src, numSources) || ! isPositiveAndBelow (dst, numDestinations))
+                    continue;
+
+                RouteFilter filter;
+                filter.channels = (uint16) (int) child.getProperty ("channels", 0xffff);
+                filter.lowNote = (uint8) jlimit (0, 127, (int) child.getProperty ("lowNote", 0));
+                filter.highNote = (uint8) jlimit (0, 127, (int) child.getProperty ("highNote", 127));
+                filter.types = (uint32) (int) child.getProperty ("types", (int) RouteFilter::allMessages);
+                filters.set (src * numDestinations + dst, filter);
+            }
+        }
+
         setMatrixState (matrix);
     }
 }
 
-void MidiRouterNode::setWithoutLocking (int src, int dst, bool set)
+void MidiRouterNode::setPatch (int src, int dst, bool patched)
 {
     jassert (src >= 0 && src < numSources && dst >= 0 && dst < numDestinations);
-    toggles.set (src, dst, set);
-    state.set (src, dst, set);
-}
+    {
+        ScopedLock sl (getLock());
+        state.set (src, dst, patched);
+    }
 
-void MidiRouterNode::set (int src, int dst, bool patched)
-{
-    jassert (src >= 0 && src < numSources && dst >= 0 && numDestinations < 4);
-    toggles.set (src, dst, patched);
-    state.set (src, dst, patched);
+    publishRoutes();
 }
 
 void MidiRouterNode::clearPatches()
 {
     {
         ScopedLock sl (getLock());
-        toggles.clear();
-        nextToggles.clear();
+        for (int r = 0; r < state.getNumRows(); ++r)
+            for (int c = 0; c < state.getNumColumns(); ++c)
+                state.set (r, c, false);
     }
 
-    for (int r = 0; r < state.getNumRows(); ++r)
-        for (int c = 0; c < state.getNumColumns(); ++c)
-            state.set (r, c, false);
+    publishRoutes();
 }
 
 void MidiRouterNode::initMidiOuts (OwnedArray<MidiBuffer>& outs)
 {
     while (outs.size() < numDestinations)
-    {
-        auto* const buf = outs.add (new MidiBuffer());
-        buf->ensureSize (16 * 3);
-    }
+        outs.add (new MidiBuffer())->ensureSize (MidiEventBuffer::getMidiBufferSize (midiOutEvents, midiOutBytes));
 }
 
 } // namespace element
@@ -5,8 +5,9 @@
 
 #include "nodes/nodetypes.hpp"
 #include <element/processor.hpp>
-#include "engine/linearfade.hpp"
-#include "engine/togglegrid.hpp"
+#include "engine/midieventbuffer.hpp"
+#include "engine/sharedtable.hpp"
+#include "matrixstate.hpp"
 
 namespace element {
 
@@ -14,10 +15,81 @@ class MidiRouterNode : public Processor,
                        public ChangeBroadcaster
 {
 public:
+    /** Limits which messages pass through a route. The default passes all. */
+    struct RouteFilter
+    {
+        enum MessageTypes
+        {
+            noteMessages = 1 << 0,       ///< Note on and off.
+            controllerMessages = 1 << 1, ///< Control change.
+            programMessages = 1 << 2,    ///< Program change.
+            pitchBendMessages = 1 << 3,  ///< Pitch bend.
+            pressureMessages = 1 << 4,   ///< Poly and channel aftertouch.
+            sysexMessages = 1 << 5,      ///< System exclusive.
+            systemMessages = 1 << 6,     ///< Other system messages, e.g. clock.
+            allMessages = (1 << 7) - 1
+        };
+
+        uint16 channels = 0xffff; ///< Bit n passes MIDI channel n + 1.
+        uint8 lowNote = 0;        ///< Lowest note passed by note and poly pressure messages.
+        uint8 highNote = 127;     ///< Highest note passed by note and poly pressure messages.
+        uint32 types = allMessages;
+
+        /** Returns true if this filter passes everything. */
+        bool passesAll() const noexcept
+        {
+            return channels == 0xffff && lowNote == 0 && highNote == 127 && (types & allMessages) == allMessages;
+        }
+
+        /** Returns true if the message passes. */
+        bool accepts (const uint8* data, int size) const noexcept
+        {
+            if (size <= 0)
+                return false;
+
+            const auto status = data[0];
+            if (status >= 0xf0)
+                return (types & (status == 0xf0 ? sysexMessages : systemMessages)) != 0;
+            if (((channels >> (status & 0x0f)) & 1) == 0)
+                return false;
+
+            switch (status & 0xf0)
+            {
+                case 0x80:
+                case 0x90:
+                    return (types & noteMessages) != 0 && size >= 2 && acceptsNote (data[1]);
+                case 0xa0:
+                    return (types & pressureMessages) != 0 && size >= 2 && acceptsNote (data[1]);
+                case 0xb0:
+                    return (types & controllerMessages) != 0;
+                case 0xc0:
+                    return (types & programMessages) != 0;
+                case 0xd0:
+                    return (types & pressureMessages) != 0;
+                case 0xe0:
+                    return (types & pitchBendMessages) != 0;
+                default:
+                    break;
+            }
+
+            return false;
+        }
+
+        bool operator== (const RouteFilter& o) const noexcept
+        {
+            return channels == o.channels && lowNote == o.lowNote && highNote == o.highNote && types == o.types;
+        }
+
+        bool operator!= (const RouteFilter& o) const noexcept { return ! operator== (o); }
+
+    private:
+        bool acceptsNote (uint8 note) const noexcept { return note >= lowNote && note <= highNote; }
+    };
+
     explicit MidiRouterNode (int ins = 4, int outs = 4);
     ~MidiRouterNode();
 
-    void prepareToRender (double sampleRate, int maxBufferSize) override { ignoreUnused (sampleRate, maxBufferSize); }
+    void prepareToRender (double sampleRate, int maxBufferSize) override;
     void releaseResources() override {}
 
     inline bool wantsMidiPipe() const override { return true; }
@@ -27,9 +99,16 @@ public:
 
     void setMatrixState (const MatrixState&);
     MatrixState getMatrixState() const;
-    void setWithoutLocking (int src, int dst, bool set);
+    /** Patch or unpatch a route and publish the new routes. */
+    void setPatch (int src, int dst, bool patched);
     CriticalSection& getLock() { return lock; }
 
+    /** Set the filter of a route. Takes effect whether or not the route is patched. */
+    void setRouteFilter (int src, int dst, const RouteFilter& filter);
+
+    /** Returns the filter of a route. */
+    RouteFilter getRouteFilter (int src, int dst) const;
+
     int getNumPrograms() const override { return jmax (1, programs.size()); }
     int getCurrentProgram() const override { return currentProgram; }
     void setCurrentProgram (int index) override;
@@ -74,6 +153,7 @@ public:
     }
 
 private:
+    // guards state and filters, render doesn't lock.
     CriticalSection lock;
     const int numSources;
     const int numDestinations;
@@ -90,17 +170,34 @@ private:
     OwnedArray<Program> programs;
     int currentProgram = -1;
 
-    void set (int src, int dst, bool patched);
     void clearPatches();
 
     // used by the UI, but not the rendering
     MatrixState state;
+    Array<RouteFilter> filters;
+
+    /** The patched routes compiled to a destination list per source. */
+    struct RoutingTable
+    {
+        struct Route
+        {
+            int destination;
+            int filter; // index in filters, or -1 to pass everything
+        };
+
+        HeapBlock<int> starts; // routes of source s are [starts[s], starts[s + 1])
+        Array<Route> routes;
+        Array<RouteFilter> filters;
+    };
 
-    ToggleGrid toggles;
-    ToggleGrid nextToggles;
-    bool togglesChanged { false };
+    SharedTable<RoutingTable> routing;
+    void publishRoutes();
 
+    /** Outputs are built here in time order, then swapped into the pipe. */
     OwnedArray<MidiBuffer> midiOuts;
+    int midiOutEvents = MidiEventBuffer::defaultMaxEvents;
+    int midiOutBytes = MidiEventBuffer::defaultMaxBytes;
+    HeapBlock<const uint8*> sourceCursors, sourceEnds;
     void initMidiOuts (OwnedArray<MidiBuffer>& outs);
 };
 
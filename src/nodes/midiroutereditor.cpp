@@ -64,11 +64,26 @@ public:
 
             g.fillRect (0, 0, width - gridPadding, height - gridPadding);
         }
+
+        // filtered routes get a corner mark
+        if (editor.hasRouteFilter (row, column))
+        {
+            const auto size = (float) jmin (width, height) * 0.3f;
+            Path corner;
+            corner.addTriangle ((float) (width - gridPadding) - size, 0.f, (float) (width - gridPadding), 0.f, (float) (width - gridPadding), size);
+            g.setColour (Colors::textColor.withAlpha (0.7f));
+            g.fillPath (corner);
+        }
     }
 
     void matrixCellClicked (const int row, const int col, const MouseEvent& ev) override
     {
-        ignoreUnused (ev);
+        if (ev.mods.isPopupMenu())
+        {
+            editor.showRouteFilterMenu (row, col);
+            return;
+        }
+
         auto& matrix = editor.getMatrixState();
         matrix.toggleCell (row, col);
         editor.applyMatrix();
@@ -186,6 +201,71 @@ void MidiRouterEditor::applyMatrix()
         node->setMatrixState (matrix);
 }
 
+bool MidiRouterEditor::hasRouteFilter (int src, int dst)
+{
+    if (auto* const node = getNodeObjectOfType<MidiRouterNode>())
+        return ! node->getRouteFilter (src, dst).passesAll();
+    return false;
+}
+
+void MidiRouterEditor::showRouteFilterMenu (int src, int dst)
+{
+    using Filter = MidiRouterNode::RouteFilter;
+    auto* const node = getNodeObjectOfType<MidiRouterNode>();
+    if (node == nullptr)
+        return;
+
+    enum
+    {
+        passAllId = 1,
+        typeIdBase = 100,
+        channelIdBase = 200
+    };
+
+    static const std::pair<uint32, const char*> types[] = {
+        { Filter::noteMessages, "Notes" },
+        { Filter::controllerMessages, "Controllers" },
+        { Filter::programMessages, "Program Changes" },
+        { Filter::pitchBendMessages, "Pitch Bend" },
+        { Filter::pressureMessages, "Pressure" },
+        { Filter::sysexMessages, "SysEx" },
+        { Filter::systemMessages, "System" }
+    };
+
+    const auto filter = node->getRouteFilter (src, dst);
+    PopupMenu menu;
+    menu.addSectionHeader ("Route Ch. " + String (src + 1) + " to Ch. " + String (dst + 1));
+    menu.addItem (passAllId, "Pass Everything", ! filter.passesAll(), filter.passesAll());
+    menu.addSeparator();
+    for (int i = 0; i < numElementsInArray (types); ++i)
+        menu.addItem (typeIdBase + i, types[i].second, true, (filter.types & types[i].first) != 0);
+
+    PopupMenu channels;
+    for (int ch = 0; ch < 16; ++ch)
+        channels.addItem (channelIdBase + ch, "Channel " + String (ch + 1), true, ((filter.channels >> ch) & 1) != 0);
+    menu.addSubMenu ("Channels", channels);
+
+    Component::SafePointer<MidiRouterEditor> safeThis (this);
+    menu.showMenuAsync (PopupMenu::Options(), [safeThis, src, dst] (int result) {
+        if (safeThis == nullptr || result <= 0)
+            return;
+        auto* const node = safeThis->getNodeObjectOfType<MidiRouterNode>();
+        if (node == nullptr)
+            return;
+
+        auto newFilter = node->getRouteFilter (src, dst);
+        if (result == passAllId)
+            newFilter = {};
+        else if (result >= channelIdBase)
+            newFilter.channels ^= (uint16) (1 << (result - channelIdBase));
+        else if (result >= typeIdBase)
+            newFilter.types ^= types[result - typeIdBase].first;
+
+        node->setRouteFilter (src, dst, newFilter);
+        safeThis->content->matrix->repaint();
+    });
+}
+
 void MidiRouterEditor::changeListenerCallback (ChangeBroadcaster*)
 {
     if (auto* const node = getNodeObjectOfType<MidiRouterNode>())
@@ -35,6 +35,12 @@ public:
 
     MatrixState& getMatrixState() { return matrix; }
     void applyMatrix();
+
+    /** Returns true if a route doesn't pass every message. */
+    bool hasRouteFilter (int src, int dst);
+
+    /** Show a menu to edit which messages a route passes. */
+    void showRouteFilterMenu (int src, int dst);
     void changeListenerCallback (ChangeBroadcaster*) override;
 
 private:
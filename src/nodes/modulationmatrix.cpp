@@ -0,0 +1,302 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <element/midipipe.hpp>
+#include "nodes/modulationmatrix.hpp"
+
+namespace element {
+
+namespace {
+/** A Control port choosing between named values. */
+class ChoiceParameter : public RangedParameter
+{
+public:
+    ChoiceParameter (const PortDescription& port, const StringArray& names)
+        : RangedParameter (port), choices (names) {}
+
+    String getText (float normalisedValue, int maxLength) const override
+    {
+        return choices[roundToInt (convertFrom0to1 (normalisedValue))].substring (0, maxLength);
+    }
+
+    float getValueForText (const String& text) const override
+    {
+        const auto index = choices.indexOf (text);
+        return index >= 0 ? convertTo0to1 ((float) index) : RangedParameter::getValueForText (text);
+    }
+
+    int getNumSteps() const override { return choices.size(); }
+    bool isDiscrete() const override { return true; }
+
+private:
+    const StringArray choices;
+};
+
+StringArray getNames (int count, String (*nameOf) (int))
+{
+    StringArray names;
+    for (int i = 0; i < count; ++i)
+        names.add (nameOf (i));
+    return names;
+}
+
+float shapeLfo (int shape, float phase) noexcept
+{
+    switch (shape)
+    {
+        case ModulationMatrixNode::triangle:
+            return 1.f - std::abs (2.f * phase - 1.f);
+        case ModulationMatrixNode::saw:
+            return phase;
+        case ModulationMatrixNode::square:
+            return phase < 0.5f ? 1.f : 0.f;
+        default:
+            break;
+    }
+
+    return 0.5f + 0.5f * std::sin (MathConstants<float>::twoPi * phase);
+}
+} // namespace
+
+ModulationMatrixNode::ModulationMatrixNode()
+    : Processor (0)
+{
+    sources[pitchBend] = 0.5f;
+    FloatVectorOperations::fill (lastLaneValue, -1.f, numLanes);
+}
+
+ModulationMatrixNode::~ModulationMatrixNode() {}
+
+String ModulationMatrixNode::getSourceName (int source)
+{
+    switch (source)
+    {
+        case lfo1:
+            return "LFO 1";
+        case lfo2:
+            return "LFO 2";
+        case envelope:
+            return "Envelope";
+        case modWheel:
+            return "Mod Wheel";
+        case velocity:
+            return "Velocity";
+        case pressure:
+            return "Pressure";
+        case pitchBend:
+            return "Pitch Bend";
+        default:
+            break;
+    }
+
+    return {};
+}
+
+String ModulationMatrixNode::getShapeName (int shape)
+{
+    switch (shape)
+    {
+        case sine:
+            return "Sine";
+        case triangle:
+            return "Triangle";
+        case saw:
+            return "Saw";
+        case square:
+            return "Square";
+        default:
+            break;
+    }
+
+    return {};
+}
+
+void ModulationMatrixNode::refreshPorts()
+{
+    if (getNumPorts() > 0)
+        return;
+
+    int index = 0;
+    PortList newPorts;
+    newPorts.add (PortType::Audio, index++, 0, "audio_in_1", "Input 1", true);
+    newPorts.add (PortType::Audio, index++, 1, "audio_in_2", "Input 2", true);
+    newPorts.add (PortType::Midi, index++, 0, "midi_in", "MIDI In", true);
+
+    for (int i = 0; i < numLfos; ++i)
+    {
+        const String n (i + 1);
+        newPorts.addControl (index++, lfoRateChannel (i), "lfo" + n + "_rate", "LFO " + n + " Rate", 0.01f, 20.f, 1.f, true);
+        newPorts.addControl (index++, lfoShapeChannel (i), "lfo" + n + "_shape", "LFO " + n + " Shape", 0.f, (float) numShapes - 1, (float) sine, true);
+    }
+
+    newPorts.addControl (index++, attackChannel(), "attack", "Attack", 0.1f, 500.f, 10.f, true);
+    newPorts.addControl (index++, releaseChannel(), "release", "Release", 1.f, 2000.f, 200.f, true);
+
+    for (int l = 0; l < numLanes; ++l)
+    {
+        const String n (l + 1);
+        newPorts.addControl (index++, laneSourceChannel (l), "lane" + n + "_source", "Lane " + n + " Source", 0.f, (float) numSources - 1, (float) (l % numSources), true);
+        newPorts.addControl (index++, laneDepthChannel (l), "lane" + n + "_depth", "Lane " + n + " Depth", -1.f, 1.f, 1.f, true);
+        newPorts.addControl (index++, laneOffsetChannel (l), "lane" + n + "_offset", "Lane " + n + " Offset", 0.f, 1.f, 0.f, true);
+    }
+
+    for (int l = 0; l < numLanes; ++l)
+    {
+        const String n (l + 1);
+        newPorts.addControl (index++, l, "lane" + n, "Lane " + n, 0.f, 1.f, 0.f, false);
+    }
+
+    setPorts (newPorts);
+
+    // render reads the parameters directly, they live as long as the ports
+    controls.clearQuick();
+    for (auto* param : getParameters (true))
+        controls.add (dynamic_cast<RangedParameter*> (param));
+    lanes.clearQuick();
+    for (auto* param : getParameters (false))
+        lanes.add (dynamic_cast<RangedParameter*> (param));
+}
+
+ParameterPtr ModulationMatrixNode::getParameter (const PortDescription& port)
+{
+    if (port.type != PortType::Control || ! port.input)
+        return nullptr;
+
+    for (int i = 0; i < numLfos; ++i)
+        if (port.channel == lfoShapeChannel (i))
+            return new ChoiceParameter (port, getNames (numShapes, &ModulationMatrixNode::getShapeName));
+
+    for (int l = 0; l < numLanes; ++l)
+        if (port.channel == laneSourceChannel (l))
+            return new ChoiceParameter (port, getNames (numSources, &ModulationMatrixNode::getSourceName));
+
+    return nullptr;
+}
+
+void ModulationMatrixNode::prepareToRender (double sampleRate, int maxBufferSize)
+{
+    ignoreUnused (maxBufferSize);
+    rate = sampleRate > 0.0 ? sampleRate : 44100.0;
+    FloatVectorOperations::clear (lfoPhase, numLfos);
+    envelopeLevel = 0.f;
+    FloatVectorOperations::fill (lastLaneValue, -1.f, numLanes);
+}
+
+void ModulationMatrixNode::updateSources (const MidiBuffer& midi, const AudioSampleBuffer& audio, int numSamples)
+{
+    for (const auto m : midi)
+    {
+        const auto* const data = m.data;
+        if (m.numBytes < 2)
+            continue;
+
+        switch (data[0] & 0xf0)
+        {
+            case 0x90:
+                if (m.numBytes >= 3 && data[2] > 0)
+                    sources[velocity] = (float) data[2] / 127.f;
+                break;
+            case 0xb0:
+                if (m.numBytes >= 3 && data[1] == 1)
+                    sources[modWheel] = (float) data[2] / 127.f;
+                break;
+            case 0xd0:
+                sources[pressure] = (float) data[1] / 127.f;
+                break;
+            case 0xe0:
+                if (m.numBytes >= 3)
+                    sources[pitchBend] = (float) ((data[2] << 7) | data[1]) / 16383.f;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // fixed sub-blocks keep attack and release independent of the block size
+    const float attack = controls.getUnchecked (attackChannel())->get() * 0.001f * (float) rate;
+    const float release = controls.getUnchecked (releaseChannel())->get() * 0.001f * (float) rate;
+    const int numChannels = jmin (2, audio.getNumChannels());
+    for (int start = 0; start < numSamples; start += subBlockSize)
+    {
+        const int n = jmin ((int) subBlockSize, numSamples - start);
+        float peak = 0.f;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto range = FloatVectorOperations::findMinAndMax (audio.getReadPointer (ch, start), n);
+            peak = jmax (peak, -range.getStart(), range.getEnd());
+        }
+
+        const float coef = std::exp (-(float) n / (peak > envelopeLevel ? attack : release));
+        envelopeLevel = peak + coef * (envelopeLevel - peak);
+    }
+
+    sources[envelope] = jmin (1.f, envelopeLevel);
+}
+
+void ModulationMatrixNode::render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampleBuffer&)
+{
+    if (lanes.size() < numLanes)
+        return;
+
+    const auto numSamples = audio.getNumSamples();
+    updateSources (*midi.getReadBuffer (0), audio, numSamples);
+
+    for (int i = 0; i < numLfos; ++i)
+        lfoRate[i] = controls.getUnchecked (lfoRateChannel (i))->get();
+    // lanes update once per block, keep at least four updates per cycle
+    FloatVectorOperations::min (lfoRate, lfoRate, (float) (rate / (4.0 * jmax (1, numSamples))), numLfos);
+    FloatVectorOperations::addWithMultiply (lfoPhase, lfoRate, (float) (numSamples / rate), numLfos);
+    for (int i = 0; i < numLfos; ++i)
+    {
+        lfoPhase[i] -= std::floor (lfoPhase[i]);
+        const auto shape = roundToInt (controls.getUnchecked (lfoShapeChannel (i))->get());
+        sources[lfo1 + i] = shapeLfo (shape, lfoPhase[i]);
+    }
+
+    for (int l = 0; l < numLanes; ++l)
+    {
+        laneSource[l] = jlimit (0, numSources - 1, roundToInt (controls.getUnchecked (laneSourceChannel (l))->get()));
+        laneInput[l] = sources[laneSource[l]];
+        laneDepth[l] = controls.getUnchecked (laneDepthChannel (l))->get();
+        laneOffset[l] = controls.getUnchecked (laneOffsetChannel (l))->get();
+    }
+
+    // every lane at once
+    FloatVectorOperations::multiply (laneValue, laneInput, laneDepth, numLanes);
+    FloatVectorOperations::add (laneValue, laneOffset, numLanes);
+    FloatVectorOperations::clip (laneValue, laneValue, 0.f, 1.f, numLanes);
+
+    for (int l = 0; l < numLanes; ++l)
+    {
+        if (laneValue[l] == lastLaneValue[l])
+            continue;
+        lastLaneValue[l] = laneValue[l];
+        lanes.getUnchecked (l)->setValueNotifyingHost (laneValue[l]);
+    }
+}
+
+void ModulationMatrixNode::getState (MemoryBlock& block)
+{
+    ValueTree tree ("ModulationMatrix");
+    for (auto* param : controls)
+        tree.setProperty (param->getPort().symbol, param->get(), nullptr);
+
+    MemoryOutputStream stream (block, false);
+    tree.writeToStream (stream);
+}
+
+void ModulationMatrixNode::setState (const void* data, int sizeInBytes)
+{
+    const auto tree = ValueTree::readFromData (data, (size_t) sizeInBytes);
+    if (! tree.hasType ("ModulationMatrix"))
+        return;
+
+    for (auto* param : controls)
+    {
+        const auto symbol = param->getPort().symbol;
+        if (tree.hasProperty (symbol))
+            param->set ((float) tree.getProperty (symbol));
+    }
+}
+
+} // namespace element
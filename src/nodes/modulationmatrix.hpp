@@ -0,0 +1,144 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include "nodes/nodetypes.hpp"
+#include <element/processor.hpp>
+
+namespace element {
+
+/** Drives many parameters from a few modulation sources.
+
+    Sources are two LFOs, an envelope follower on the audio inputs and
+    MIDI mod wheel, velocity, channel pressure and pitch bend, all ranged
+    0 to 1.  Each lane picks a source and outputs offset + depth * source
+    on a Control output.  Connect lanes to the Control inputs of other
+    nodes, one lane can feed any number of them.
+
+    Lanes are evaluated together with vector operations once per block,
+    after the envelope follower has run over the block in fixed size
+    sub-blocks so its response doesn't depend on the block size.  A lane
+    output's parameter is only written when its value changes.
+
+    Since lanes only change once per block, LFO rates are capped at a
+    quarter of the block rate, e.g. 5 Hz with 2048 samples at 44.1 kHz,
+    so a fast LFO slows down instead of aliasing.
+ */
+class ModulationMatrixNode : public Processor
+{
+public:
+    enum
+    {
+        numLfos = 2,
+        numLanes = 8,
+        subBlockSize = 32
+    };
+
+    enum Source
+    {
+        lfo1 = 0,
+        lfo2,
+        envelope,
+        modWheel,
+        velocity,
+        pressure,
+        pitchBend,
+        numSources
+    };
+
+    enum Shape
+    {
+        sine = 0,
+        triangle,
+        saw,
+        square,
+        numShapes
+    };
+
+    ModulationMatrixNode();
+    ~ModulationMatrixNode();
+
+    /** Returns the Control input channel of an LFO's rate in Hz. */
+    static int lfoRateChannel (int lfo) noexcept { return lfo * 2; }
+    /** Returns the Control input channel of an LFO's shape. */
+    static int lfoShapeChannel (int lfo) noexcept { return lfo * 2 + 1; }
+    /** Returns the Control input channel of the envelope attack in ms. */
+    static int attackChannel() noexcept { return numLfos * 2; }
+    /** Returns the Control input channel of the envelope release in ms. */
+    static int releaseChannel() noexcept { return numLfos * 2 + 1; }
+    /** Returns the Control input channel of a lane's source. */
+    static int laneSourceChannel (int lane) noexcept { return numLfos * 2 + 2 + lane * 3; }
+    /** Returns the Control input channel of a lane's depth, -1 to 1. */
+    static int laneDepthChannel (int lane) noexcept { return laneSourceChannel (lane) + 1; }
+    /** Returns the Control input channel of a lane's offset, 0 to 1. */
+    static int laneOffsetChannel (int lane) noexcept { return laneSourceChannel (lane) + 2; }
+
+    /** Returns the name of a source. */
+    static String getSourceName (int source);
+
+    /** Returns the name of an LFO shape. */
+    static String getShapeName (int shape);
+
+    void prepareToRender (double sampleRate, int maxBufferSize) override;
+    void releaseResources() override {}
+
+    inline bool wantsMidiPipe() const override { return true; }
+    inline bool isMidiReadOnly() const override { return true; }
+    void render (AudioSampleBuffer&, MidiPipe&, AudioSampleBuffer&) override;
+    void renderBypassed (AudioSampleBuffer&, MidiPipe&, AudioSampleBuffer&) override {}
+
+    void getState (MemoryBlock&) override;
+    void setState (const void*, int sizeInBytes) override;
+
+    int getNumPrograms() const override { return 1; }
+    int getCurrentProgram() const override { return 0; }
+    void setCurrentProgram (int index) override { ignoreUnused (index); }
+    const String getProgramName (int index) const override
+    {
+        ignoreUnused (index);
+        return "Modulation Matrix";
+    }
+
+    void getPluginDescription (PluginDescription& desc) const override
+    {
+        desc.fileOrIdentifier = EL_NODE_ID_MODULATION_MATRIX;
+        desc.uniqueId = EL_NODE_UID_MODULATION_MATRIX;
+        desc.name = "Modulation Matrix";
+        desc.descriptiveName = "LFO, envelope and MIDI modulation for Control ports";
+        desc.numInputChannels = 2;
+        desc.numOutputChannels = 0;
+        desc.hasSharedContainer = false;
+        desc.isInstrument = false;
+        desc.manufacturerName = EL_NODE_FORMAT_AUTHOR;
+        desc.pluginFormatName = "Element";
+        desc.version = "1.0.0";
+    }
+
+    void refreshPorts() override;
+
+protected:
+    ParameterPtr getParameter (const PortDescription& port) override;
+
+private:
+    Array<RangedParameter*> controls;
+    Array<RangedParameter*> lanes;
+
+    double rate = 44100.0;
+    float lfoPhase[numLfos] {};
+    float lfoRate[numLfos] {};
+    float sources[numSources] {};
+    float envelopeLevel = 0.f;
+
+    // lane settings and values, laid out for vector operations
+    float laneInput[numLanes] {};
+    float laneDepth[numLanes] {};
+    float laneOffset[numLanes] {};
+    float laneValue[numLanes] {};
+    float lastLaneValue[numLanes] {};
+    int laneSource[numLanes] {};
+
+    void updateSources (const MidiBuffer& midi, const AudioSampleBuffer& audio, int numSamples);
+};
+
+} // namespace element
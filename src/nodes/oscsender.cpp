@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL3-or-later
 // Author: Eliot Akira <me@eliotakira.com>
 
+#include "engine/threadscheduler.hpp"
 #include "nodes/oscsender.hpp"
 #include "utils.hpp"
 
@@ -62,8 +63,10 @@ void OSCSenderNode::getState (MemoryBlock& block)
 
 void OSCSenderNode::run()
 {
+    int scheduleGeneration = -1;
     while (! threadShouldExit())
     {
+        ThreadScheduler::updateCurrentThread (ThreadScheduler::Network, scheduleGeneration);
         sem.wait();
 
         if (threadShouldExit())
@@ -132,13 +135,11 @@ void OSCSenderNode::prepareToRender (double sampleRate, int maxBufferSize)
 void OSCSenderNode::render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampleBuffer&)
 {
     const auto nframes = audio.getNumSamples();
-    auto* const midiIn = midi.getWriteBuffer (0);
+    // the input may be shared with other nodes, read it only
+    auto* const midiIn = midi.getReadBuffer (0);
 
     if (nframes == 0 || ! connected || paused)
-    {
-        midiIn->clear();
         return;
-    }
 
     MidiMessage msg;
     auto timestamp = Time::getMillisecondCounterHiRes();
@@ -151,7 +152,6 @@ void OSCSenderNode::render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampl
 
     numSamples += nframes;
     sem.post();
-    midiIn->clear();
 }
 
 /** For node editor */
@@ -48,6 +48,7 @@ public:
 
     void prepareToRender (double sampleRate, int maxBufferSize) override;
     void render (AudioSampleBuffer& audio, MidiPipe& midi, AudioSampleBuffer&) override;
+    bool isMidiReadOnly() const override { return true; }
     void releaseResources() override {};
 
     void refreshPorts() override;
@@ -39,7 +39,9 @@ public:
     inline uint32
         read (void* dest, uint32 size, bool advance = true)
     {
-        buffer = block.getData();
+        // locals: the reader and writer may run on different threads
+        Vec vec1, vec2;
+        auto* const buffer = block.getData();
         fifo.prepareToRead (size, vec1.index, vec1.size, vec2.index, vec2.size);
 
         if (vec1.size > 0)
@@ -68,7 +70,8 @@ public:
     inline uint32
         write (const void* src, uint32 bytes)
     {
-        buffer = block.getData();
+        Vec vec1, vec2;
+        auto* const buffer = block.getData();
         fifo.prepareToWrite (bytes, vec1.index, vec1.size, vec2.index, vec2.size);
 
         if (vec1.size > 0)
@@ -100,10 +103,8 @@ private:
         int32 index;
     };
 
-    Vec vec1, vec2;
     juce::AbstractFifo fifo;
     juce::HeapBlock<uint8> block;
-    uint8* buffer;
 };
 
 } // namespace element
@@ -36,6 +36,7 @@ extern int luaopen_el_midi (lua_State*);
 extern int luaopen_el_round (lua_State*);
 extern int luaopen_el_AudioBuffer32 (lua_State*);
 extern int luaopen_el_AudioBuffer64 (lua_State*);
+extern int luaopen_el_AudioEngine (lua_State*);
 extern int luaopen_el_Bounds (lua_State*);
 extern int luaopen_el_TextButton (lua_State*);
 extern int luaopen_el_Widget (lua_State*);
@@ -274,6 +275,10 @@ static int searchInternalModules (lua_State* L)
         sol::stack::push (L, load_el_color);
     }
 
+    else if (mod == "el.AudioEngine")
+    {
+        sol::stack::push (L, luaopen_el_AudioEngine);
+    }
     else if (mod == "el.Commands")
     {
         sol::stack::push (L, luaopen_el_Commands);
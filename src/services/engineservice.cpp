@@ -780,6 +780,7 @@ void EngineService::setRootNode (const Node& newRootNode)
         proc->setMidiChannels (newRootNode.getMidiChannels().get());
         proc->setVelocityCurveMode ((VelocityCurve::Mode) (int) newRootNode.getProperty (
             tags::velocityCurveMode, (int) VelocityCurve::Linear));
+        proc->setControlSmoothing ((double) newRootNode.getProperty (tags::controlSmoothing, 0.0));
     }
     else
     {
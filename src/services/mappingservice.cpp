@@ -95,7 +95,7 @@ public:
     int parameter = -1;
 
 private:
-    class Mappable : public Parameter::Listener
+    class Mappable : public Parameter::AsyncListener
     {
     public:
         Mappable (AudioProcessorParameterCapture& c, const Node& n)
@@ -112,7 +112,7 @@ private:
         void clear()
         {
             for (auto* const param : object->getParameters())
-                param->removeListener (this);
+                param->removeAsyncListener (this);
             for (auto& c : connections)
                 c.disconnect();
         }
@@ -130,10 +130,10 @@ private:
                 &Mappable::onMuteChanged, this, std::placeholders::_1)));
 
             for (auto* const param : object->getParameters())
-                param->addListener (this);
+                param->addAsyncListener (this);
         }
 
-        void controlValueChanged (int index, float) override
+        void parameterValueChanged (Parameter& param, float) override
         {
             if (capture.capture.get() == false)
                 return;
@@ -142,12 +142,10 @@ private:
             capture.node = node;
             capture.object = object;
             capture.processor = object->getAudioProcessor();
-            capture.parameter = index;
+            capture.parameter = param.getParameterIndex();
             capture.triggerAsyncUpdate();
         }
 
-        void controlTouched (int, bool) override {}
-
         void onEnablementChanged (Processor*)
         {
             if (capture.capture.get() == false)
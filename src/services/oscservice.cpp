@@ -13,6 +13,8 @@
 
 #define EL_OSC_ADDRESS_COMMAND "/element/command"
 #define EL_OSC_ADDRESS_ENGINE "/element/engine"
+#define EL_OSC_ADDRESS_ENGINE_STATS "/element/engine/stats"
+#define EL_OSC_ADDRESS_ENGINE_CLOCK "/element/engine/clock"
 
 namespace element {
 
@@ -43,8 +45,8 @@ private:
 //=============================================================================
 struct EngineOSCListener final : OSCReceiver::ListenerWithOSCAddress<>
 {
-    EngineOSCListener (Context& g)
-        : globals (g)
+    EngineOSCListener (Context& g, OSCSender& s)
+        : globals (g), sender (s)
     {
     }
 
@@ -54,12 +56,97 @@ struct EngineOSCListener final : OSCReceiver::ListenerWithOSCAddress<>
         if (! slug.isString())
             return;
 
-        if (message.size() >= 2 && slug.getString().toLowerCase().trim() == "samplerate")
+        const auto cmd = slug.getString().toLowerCase().trim();
+        if (message.size() >= 2 && cmd == "samplerate")
             handleSampleRate (message[1]);
+        else if (message.size() >= 3 && cmd == "stats")
+            handleStats (message[1], message[2]);
+        else if (cmd == "resetstats")
+            handleResetStats();
+        else if (message.size() >= 2 && cmd == "loadalarm")
+            handleLoadAlarm (message[1]);
+        else if (message.size() >= 2 && cmd == "clockmeasure")
+            handleClockMeasure (message[1], message.size() >= 3 ? message[2] : OSCArgument (0.f));
+        else if (message.size() >= 3 && cmd == "clockstats")
+            handleClockStats (message[1], message[2]);
     }
 
 private:
     Context& globals;
+    OSCSender& sender;
+
+    /** Replies to host:port with the engine's statistics as
+        load, average load, peak load, callbacks, xruns and page faults.
+     */
+    void handleStats (const OSCArgument& host, const OSCArgument& port)
+    {
+        auto engine = globals.audio();
+        if (engine == nullptr || ! host.isString() || ! port.isInt32())
+            return;
+
+        const auto stats = engine->getStatistics();
+        OSCMessage reply (EL_OSC_ADDRESS_ENGINE_STATS);
+        reply.addFloat32 ((float) stats.load);
+        reply.addFloat32 ((float) stats.averageLoad);
+        reply.addFloat32 ((float) stats.peakLoad);
+        reply.addInt32 ((int32) stats.numCallbacks);
+        reply.addInt32 ((int32) stats.numXruns);
+        reply.addInt32 ((int32) stats.numPageFaults);
+        if (sender.connect (host.getString(), port.getInt32()))
+            sender.send (reply);
+    }
+
+    void handleResetStats()
+    {
+        if (auto engine = globals.audio())
+            engine->resetStatistics();
+    }
+
+    void handleLoadAlarm (const OSCArgument& arg)
+    {
+        auto engine = globals.audio();
+        if (engine == nullptr)
+            return;
+        if (arg.isFloat32())
+            engine->setLoadAlarmThreshold ((double) arg.getFloat32());
+        else if (arg.isInt32())
+            engine->setLoadAlarmThreshold ((double) arg.getInt32() * 0.01);
+    }
+
+    /** Starts (non-zero) or stops (zero) measuring the incoming MIDI clock,
+        with an optional reference tempo for drift.
+     */
+    void handleClockMeasure (const OSCArgument& enabled, const OSCArgument& tempo)
+    {
+        auto engine = globals.audio();
+        if (engine == nullptr || ! (enabled.isInt32() || enabled.isFloat32()))
+            return;
+        const bool measure = enabled.isInt32() ? enabled.getInt32() != 0 : enabled.getFloat32() != 0.f;
+        const double reference = tempo.isFloat32() ? (double) tempo.getFloat32()
+                                                   : (tempo.isInt32() ? (double) tempo.getInt32() : 0.0);
+        engine->setClockMeasurement (measure, reference);
+    }
+
+    /** Replies to host:port with the MIDI clock measurement as locked, ticks,
+        tempo, drift (ppm), RMS jitter (ms) and peak jitter (ms).
+     */
+    void handleClockStats (const OSCArgument& host, const OSCArgument& port)
+    {
+        auto engine = globals.audio();
+        if (engine == nullptr || ! host.isString() || ! port.isInt32())
+            return;
+
+        const auto clock = engine->getClockMeasurement();
+        OSCMessage reply (EL_OSC_ADDRESS_ENGINE_CLOCK);
+        reply.addInt32 (clock.locked ? 1 : 0);
+        reply.addInt32 ((int32) clock.numTicks);
+        reply.addFloat32 ((float) clock.tempo);
+        reply.addFloat32 ((float) clock.driftPpm);
+        reply.addFloat32 ((float) clock.jitterRms);
+        reply.addFloat32 ((float) clock.jitterPeak);
+        if (sender.connect (host.getString(), port.getInt32()))
+            sender.send (reply);
+    }
 
     void handleSampleRate (const OSCArgument& arg)
     {
@@ -137,7 +224,7 @@ public:
         application.reset (new CommandOSCListener (owner.context()));
         receiver.addListener (application.get(), EL_OSC_ADDRESS_COMMAND);
 
-        engine.reset (new EngineOSCListener (owner.context()));
+        engine.reset (new EngineOSCListener (owner.context(), sender));
         receiver.addListener (engine.get(), EL_OSC_ADDRESS_ENGINE);
 
         listenersReady = true;
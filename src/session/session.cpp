@@ -187,7 +187,7 @@ void Session::notifyChanged()
 
 void Session::valueTreePropertyChanged (ValueTree& tree, const Identifier& property)
 {
-    if (property == tags::object || (tree.hasType (types::Node) && (property == tags::state || property == tags::updater)))
+    if (property == tags::object || property == tags::stateDirectory || (tree.hasType (types::Node) && (property == tags::state || property == tags::updater)))
     {
         return;
     }
@@ -247,6 +247,16 @@ void Session::saveGraphState()
         getGraph (i).savePluginState();
 }
 
+void Session::setStateDirectory (const File& directory)
+{
+    objectData.setProperty (tags::stateDirectory, directory.getFullPathName(), nullptr);
+}
+
+File Session::getStateDirectoryFor (const File& sessionFile)
+{
+    return sessionFile.getSiblingFile (sessionFile.getFileNameWithoutExtension() + ".state");
+}
+
 void Session::restoreGraphState()
 {
     for (int i = 0; i < getNumGraphs(); ++i)
@@ -38,6 +38,9 @@ const char* Settings::clockSourceKey = "clockSource";
 const char* Settings::updateChannelKey = "updateChannel";
 const char* Settings::updateKeyTypeKey = "updateKeyType";
 const char* Settings::updateKeyKey = "updateKey";
+const char* Settings::threadPriorityPrefix = "threadPriority_";
+const char* Settings::threadAffinityPrefix = "threadAffinity_";
+const char* Settings::realtimeMemoryKey = "realtimeMemory";
 
 //=============================================================================
 enum OptionsMenuItemId
@@ -409,6 +412,53 @@ void Settings::setClockSource (const juce::String& src)
         p->setValue (clockSourceKey, src);
 }
 
+//=============================================================================
+int Settings::getThreadPriority (const juce::String& threadClass) const
+{
+    if (auto* p = getProps())
+        return jlimit (0, 99, p->getIntValue (threadPriorityPrefix + threadClass, 0));
+    return 0;
+}
+
+void Settings::setThreadPriority (const juce::String& threadClass, int priority)
+{
+    priority = jlimit (0, 99, priority);
+    if (priority == getThreadPriority (threadClass))
+        return;
+    if (auto* p = getProps())
+        p->setValue (threadPriorityPrefix + threadClass, priority);
+}
+
+juce::String Settings::getThreadAffinity (const juce::String& threadClass) const
+{
+    if (auto* p = getProps())
+        return p->getValue (threadAffinityPrefix + threadClass, {});
+    return {};
+}
+
+void Settings::setThreadAffinity (const juce::String& threadClass, const juce::String& cpus)
+{
+    if (cpus == getThreadAffinity (threadClass))
+        return;
+    if (auto* p = getProps())
+        p->setValue (threadAffinityPrefix + threadClass, cpus.trim());
+}
+
+bool Settings::isRealtimeMemoryEnabled() const
+{
+    if (auto* p = getProps())
+        return p->getBoolValue (realtimeMemoryKey, false);
+    return false;
+}
+
+void Settings::setRealtimeMemoryEnabled (bool enabled)
+{
+    if (enabled == isRealtimeMemoryEnabled())
+        return;
+    if (auto* p = getProps())
+        p->setValue (realtimeMemoryKey, enabled);
+}
+
 juce::String Settings::getUpdateKeyType() const
 {
     if (auto* p = getProps())
@@ -311,6 +311,15 @@ public:
             if (strText.isEmpty())
                 strText = "Running";
             text << "Engine: " << strText << ":  CPU: " << String (devices.getCpuUsage() * 100.f, 1) << "%";
+            if (engine != nullptr)
+            {
+                const auto stats = engine->getStatistics();
+                text << ":  Load: " << String (stats.averageLoad * 100.0, 1) << "%"
+                     << " (peak " << String (stats.peakLoad * 100.0, 1) << "%)"
+                     << ":  Xruns: " << stats.numXruns;
+                if (stats.numPageFaults > 0)
+                    text << ":  Faults: " << stats.numPageFaults;
+            }
             streamingStatusLabel.setText (text, dontSendNotification);
 
             statusLabel.setText (String ("Device: ") + dev->getName(), dontSendNotification);
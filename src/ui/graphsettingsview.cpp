@@ -126,6 +126,33 @@ private:
     int index;
 };
 
+class ControlSmoothingPropertyComponent : public SliderPropertyComponent
+{
+public:
+    ControlSmoothingPropertyComponent (const Node& g)
+        : SliderPropertyComponent ("Control Smoothing", 0.0, 500.0, 1.0, 1.0, false),
+          graph (g)
+    {
+        slider.setTextValueSuffix (" ms");
+        slider.updateText();
+    }
+
+    void setValue (double v) override
+    {
+        graph.setProperty (tags::controlSmoothing, v);
+        if (auto* root = dynamic_cast<RootGraph*> (graph.getObject()))
+            root->setControlSmoothing (v);
+    }
+
+    double getValue() const override
+    {
+        return (double) graph.getProperty (tags::controlSmoothing, 0.0);
+    }
+
+private:
+    Node graph;
+};
+
 class RootGraphMidiChannels : public MidiMultiChannelPropertyComponent
 {
 public:
@@ -482,6 +509,7 @@ private:
 
         props.add (new RenderModePropertyComponent (g));
         props.add (new VelocityCurvePropertyComponent (g));
+        props.add (new ControlSmoothingPropertyComponent (g));
         props.add (new RootGraphMidiChannels (g, getWidth() - 100));
         props.add (new MidiProgramPropertyComponent (g));
         props.add (new KeyMapPropertyComponent (g));
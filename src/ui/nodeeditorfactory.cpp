@@ -95,6 +95,10 @@ private:
         {
             return new ScriptNodeEditor (gui.context().scripting(), node);
         }
+        else if (NID == EL_NODE_ID_MODULATION_MATRIX)
+        {
+            return new GenericNodeEditor (node);
+        }
         else if (NID == EL_NODE_ID_MIDI_PROGRAM_MAP)
         {
             auto* const pgced = new MidiProgramMapEditor (node);
@@ -169,6 +173,10 @@ private:
             se->setToolbarVisible (false);
             return se;
         }
+        else if (node.getIdentifier() == EL_NODE_ID_MODULATION_MATRIX)
+        {
+            return new GenericNodeEditor (node);
+        }
 
         ProcessorPtr object = node.getObject();
         auto* const proc = (object != nullptr) ? object->getAudioProcessor() : nullptr;
@@ -16,6 +16,7 @@
 #include "ui/viewhelpers.hpp"
 #include "services/oscservice.hpp"
 #include "engine/midiengine.hpp"
+#include "engine/threadscheduler.hpp"
 
 namespace element {
 
@@ -198,6 +199,121 @@ private:
     }
 };
 
+//==============================================================================
+class ThreadSettingsPage : public SettingsPage
+{
+public:
+    ThreadSettingsPage (Context& w)
+        : world (w)
+    {
+        auto& settings = world.settings();
+
+        addAndMakeVisible (infoLabel);
+        infoLabel.setFont (Font (12.0));
+        infoLabel.setJustificationType (Justification::topLeft);
+#if JUCE_LINUX
+        infoLabel.setText ("Priority is the SCHED_FIFO priority. Default uses normal scheduling, "
+                           "threads made realtime go back to SCHED_OTHER. "
+                           "CPUs is a list like \"2-3\", empty for any CPU. "
+                           "Locked memory applies on the next device start.",
+                           dontSendNotification);
+#else
+        infoLabel.setText ("CPUs is a list like \"2-3\", empty for any CPU. "
+                           "Realtime priority and locked memory are only supported on Linux.",
+                           dontSendNotification);
+#endif
+
+        for (int i = 0; i < ThreadScheduler::numClasses; ++i)
+        {
+            const auto threadClass = static_cast<ThreadScheduler::Class> (i);
+            const String slug = ThreadScheduler::getClassSlug (threadClass);
+            auto* row = rows.add (new Row());
+
+            addAndMakeVisible (row->label);
+            row->label.setFont (Font (12.0, Font::bold));
+            row->label.setText (ThreadScheduler::getClassName (threadClass), dontSendNotification);
+
+            addAndMakeVisible (row->priority);
+            row->priority.textFromValueFunction = [] (double value) -> String {
+                return value <= 0.0 ? String ("Default") : String (roundToInt (value));
+            };
+            row->priority.setRange (0.0, 99.0, 1.0);
+            row->priority.setValue ((double) settings.getThreadPriority (slug), dontSendNotification);
+            row->priority.setSliderStyle (Slider::IncDecButtons);
+            row->priority.setTextBoxStyle (Slider::TextBoxLeft, false, 62, 22);
+#if ! JUCE_LINUX
+            row->priority.setEnabled (false);
+#endif
+            row->priority.onValueChange = [this, slug, row]() {
+                world.settings().setThreadPriority (slug, roundToInt (row->priority.getValue()));
+                applySettings();
+            };
+
+            addAndMakeVisible (row->cpus);
+            row->cpus.setText (settings.getThreadAffinity (slug), false);
+            row->cpus.setTextToShowWhenEmpty ("Any", Colors::textColor.darker());
+            row->cpus.setInputRestrictions (0, "0123456789,-");
+            row->cpus.onFocusLost = row->cpus.onReturnKey = [this, slug, row]() {
+                const auto mask = ThreadScheduler::parseCpuList (row->cpus.getText());
+                row->cpus.setText (ThreadScheduler::toCpuList (mask), false);
+                world.settings().setThreadAffinity (slug, row->cpus.getText());
+                applySettings();
+            };
+        }
+
+        addAndMakeVisible (memoryLabel);
+        memoryLabel.setFont (Font (12.0, Font::bold));
+        memoryLabel.setText ("Lock memory (RT memory)", dontSendNotification);
+        addAndMakeVisible (memoryButton);
+        memoryButton.setYesNoText ("Yes", "No");
+        memoryButton.setClickingTogglesState (true);
+        memoryButton.setToggleState (settings.isRealtimeMemoryEnabled(), dontSendNotification);
+#if ! JUCE_LINUX
+        memoryButton.setEnabled (false);
+#endif
+        memoryButton.onClick = [this]() {
+            world.settings().setRealtimeMemoryEnabled (memoryButton.getToggleState());
+            if (auto engine = world.audio())
+                engine->applySettings (world.settings());
+        };
+    }
+
+    void resized() override
+    {
+        auto r = getLocalBounds();
+        infoLabel.setBounds (r.removeFromTop (48));
+        layoutSetting (r, memoryLabel, memoryButton);
+        for (auto* row : rows)
+        {
+            r.removeFromTop (6);
+            auto r2 = r.removeFromTop (22);
+            row->label.setBounds (r2.removeFromLeft (getWidth() / 3));
+            row->priority.setBounds (r2.removeFromLeft (getWidth() / 4));
+            r2.removeFromLeft (8);
+            row->cpus.setBounds (r2.removeFromLeft (getWidth() / 4));
+        }
+    }
+
+private:
+    Context& world;
+    Label infoLabel;
+    Label memoryLabel;
+    SettingButton memoryButton;
+
+    struct Row
+    {
+        Label label;
+        Slider priority;
+        TextEditor cpus;
+    };
+    OwnedArray<Row> rows;
+
+    void applySettings()
+    {
+        ThreadScheduler::applySettings (world.settings());
+    }
+};
+
 //==============================================================================
 class PluginSettingsComponent : public SettingsPage,
                                 public Button::Listener
@@ -1686,6 +1802,10 @@ Component* Preferences::createPageForName (const String& name)
     {
         return new OSCSettingsPage (_context, _ui);
     }
+    else if (name == EL_THREADS_SETTINGS_NAME)
+    {
+        return new ThreadSettingsPage (_context);
+    }
     else if (name == EL_REPOSITORY_PREFERENCE_NAME)
     {
         return new UpdatesSettingsPage (_ui);
@@ -1703,6 +1823,7 @@ void Preferences::addDefaultPages()
     addPage (EL_AUDIO_SETTINGS_NAME);
     addPage (EL_MIDI_SETTINGS_NAME);
     addPage (EL_OSC_SETTINGS_NAME);
+    addPage (EL_THREADS_SETTINGS_NAME);
 #if EL_UPDATER
     addPage (EL_REPOSITORY_PREFERENCE_NAME);
 #endif
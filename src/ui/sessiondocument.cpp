@@ -49,6 +49,8 @@ Result SessionDocument::loadDocument (const File& file)
 
         if (error.isEmpty() && ! session->loadData (newData))
             error = "Could not load session data";
+        if (error.isEmpty())
+            session->setStateDirectory (Session::getStateDirectoryFor (file));
     }
     else
     {
@@ -73,6 +75,8 @@ Result SessionDocument::saveDocument (const File& file)
     if (! session)
         return Result::fail ("Nil session");
 
+    // files plugins make while saving go next to the session file
+    session->setStateDirectory (Session::getStateDirectoryFor (file));
     session->saveGraphState();
     if (auto e = session->createXml())
     {
@@ -6,6 +6,28 @@
 
 using namespace element;
 
+namespace {
+/** Copies its control input to its control output. */
+class ControlNode : public TestNode
+{
+public:
+    ControlNode() : TestNode (0, 0, 0, 0) { ControlNode::refreshPorts(); }
+
+    void render (AudioSampleBuffer&, MidiPipe&, AudioSampleBuffer&) override
+    {
+        getParameter (0, false)->setValue (getParameter (0, true)->getValue());
+    }
+
+    void refreshPorts() override
+    {
+        PortList newPorts;
+        newPorts.add (PortType::Control, 0, 0, "in", "In", true);
+        newPorts.add (PortType::Control, 1, 0, "out", "Out", false);
+        setPorts (newPorts);
+    }
+};
+} // namespace
+
 BOOST_AUTO_TEST_SUITE (GraphNodeTests)
 
 BOOST_AUTO_TEST_CASE (IO)
@@ -74,4 +96,54 @@ BOOST_AUTO_TEST_CASE (AddRemove)
     BOOST_REQUIRE (graph.removeNode (node->nodeId));
 }
 
+BOOST_AUTO_TEST_CASE (FixedBlockSize)
+{
+    GraphNode graph;
+    BOOST_REQUIRE_EQUAL (graph.getFixedBlockSize(), 0);
+
+    auto* subgraph = new GraphNode();
+    graph.addNode (subgraph);
+    graph.setFixedBlockSize (256);
+    BOOST_REQUIRE_EQUAL (graph.getFixedBlockSize(), 256);
+    BOOST_REQUIRE_EQUAL (subgraph->getFixedBlockSize(), 256);
+
+    subgraph->setFixedBlockSize (64);
+    BOOST_REQUIRE_EQUAL (subgraph->getFixedBlockSize(), 64);
+
+    graph.setFixedBlockSize (-1);
+    BOOST_REQUIRE_EQUAL (graph.getFixedBlockSize(), 0);
+    graph.clear();
+}
+
+BOOST_AUTO_TEST_CASE (ControlChain)
+{
+    PreparedGraph fix (44100.0, 441);
+    GraphNode& graph = fix.graph;
+    ProcessorPtr a = graph.addNode (new ControlNode());
+    ProcessorPtr b = graph.addNode (new ControlNode());
+    ProcessorPtr c = graph.addNode (new ControlNode());
+    BOOST_REQUIRE (graph.addConnection (b->nodeId, 1, c->nodeId, 0));
+    BOOST_REQUIRE (graph.addConnection (a->nodeId, 1, b->nodeId, 0));
+    MessageManager::getInstance()->runDispatchLoopUntil (10);
+
+    AudioSampleBuffer audio (2, 441), cv (1, 441);
+    MidiBuffer midi;
+    MidiBuffer* midiBuffers[] = { &midi };
+    MidiPipe pipe (midiBuffers, 1);
+
+    // the whole chain settles in one block
+    a->getParameter (0, true)->setValue (0.75f);
+    graph.render (audio, pipe, cv);
+    BOOST_REQUIRE_EQUAL (b->getParameter (0, true)->getValue(), 0.75f);
+    BOOST_REQUIRE_EQUAL (c->getParameter (0, false)->getValue(), 0.75f);
+
+    // 20 ms is two blocks
+    graph.setControlSmoothing (20.0);
+    a->getParameter (0, true)->setValue (0.25f);
+    graph.render (audio, pipe, cv);
+    BOOST_REQUIRE_CLOSE (b->getParameter (0, true)->getValue(), 0.5f, 0.001f);
+    graph.render (audio, pipe, cv);
+    BOOST_REQUIRE_EQUAL (b->getParameter (0, true)->getValue(), 0.25f);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
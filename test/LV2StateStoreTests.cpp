@@ -0,0 +1,138 @@
+#include <cstring>
+
+#include <boost/test/unit_test.hpp>
+#include <lv2/atom/atom.h>
+#include "lv2/statestore.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+/** A minimal URID map for the store. */
+struct TestURIDs
+{
+    TestURIDs()
+    {
+        map = { &uris, &TestURIDs::mapURI };
+        unmap = { &uris, &TestURIDs::unmapURID };
+    }
+
+    LV2_URID operator() (const char* uri) { return mapURI (&uris, uri); }
+
+    static LV2_URID mapURI (LV2_URID_Map_Handle handle, const char* uri)
+    {
+        auto& uris = *static_cast<StringArray*> (handle);
+        if (! uris.contains (uri))
+            uris.add (uri);
+        return (LV2_URID) uris.indexOf (uri) + 1;
+    }
+
+    static const char* unmapURID (LV2_URID_Unmap_Handle handle, LV2_URID urid)
+    {
+        auto& uris = *static_cast<StringArray*> (handle);
+        return urid > 0 && (int) urid <= uris.size() ? uris[(int) urid - 1].toRawUTF8() : nullptr;
+    }
+
+    StringArray uris;
+    LV2_URID_Map map;
+    LV2_URID_Unmap unmap;
+};
+
+template <typename FeatureType>
+const FeatureType* findFeature (const LV2_Feature* const* features, const char* uri)
+{
+    for (; *features != nullptr; ++features)
+        if (std::strcmp ((*features)->URI, uri) == 0)
+            return static_cast<const FeatureType*> ((*features)->data);
+    return nullptr;
+}
+
+String takePath (const LV2_State_Free_Path* freePath, char* path)
+{
+    const auto result = String::fromUTF8 (path);
+    freePath->free_path (freePath->handle, path);
+    return result;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (LV2StateStoreTests)
+
+BOOST_AUTO_TEST_CASE (PathRoundTrip)
+{
+    TestURIDs urids;
+    const auto dir = File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("lv2state", "");
+    const auto outside = File::getSpecialLocation (File::tempDirectory).getChildFile ("outside.wav").getFullPathName();
+    const auto pathType = urids (LV2_ATOM__Path);
+    const auto stringType = urids (LV2_ATOM__String);
+
+    MemoryBlock saved;
+    String madePath;
+
+    {
+        // what a plugin's save() does with the features it gets
+        LV2StateStore store (urids.map, urids.unmap, dir);
+        const auto* features = store.getFeatures();
+        const auto* mapPath = findFeature<LV2_State_Map_Path> (features, LV2_STATE__mapPath);
+        const auto* makePath = findFeature<LV2_State_Make_Path> (features, LV2_STATE__makePath);
+        const auto* freePath = findFeature<LV2_State_Free_Path> (features, LV2_STATE__freePath);
+        BOOST_REQUIRE (mapPath != nullptr && makePath != nullptr && freePath != nullptr);
+
+        madePath = takePath (freePath, makePath->path (makePath->handle, "samples/kick.wav"));
+        BOOST_REQUIRE (File (madePath).isAChildOf (dir));
+        BOOST_REQUIRE (File (madePath).getParentDirectory().isDirectory());
+
+        const auto inside = takePath (freePath, mapPath->abstract_path (mapPath->handle, madePath.toRawUTF8()));
+        BOOST_REQUIRE_EQUAL (inside, String ("samples/kick.wav"));
+        const auto other = takePath (freePath, mapPath->abstract_path (mapPath->handle, outside.toRawUTF8()));
+        BOOST_REQUIRE_EQUAL (other, outside);
+
+        const auto podFlags = (uint32_t) (LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE);
+        auto* handle = store.getHandle();
+        BOOST_REQUIRE_EQUAL (LV2StateStore::store (handle, urids ("urn:test:sample"), inside.toRawUTF8(), inside.getNumBytesAsUTF8() + 1, pathType, podFlags), LV2_STATE_SUCCESS);
+        BOOST_REQUIRE_EQUAL (LV2StateStore::store (handle, urids ("urn:test:other"), other.toRawUTF8(), other.getNumBytesAsUTF8() + 1, pathType, podFlags), LV2_STATE_SUCCESS);
+
+        // non-POD values are kept too, with their flags
+        const char blob[] = "blob";
+        BOOST_REQUIRE_EQUAL (LV2StateStore::store (handle, urids ("urn:test:blob"), blob, sizeof (blob), stringType, 0), LV2_STATE_SUCCESS);
+        BOOST_REQUIRE_EQUAL (store.size(), 3);
+
+        MemoryOutputStream out (saved, false);
+        store.write (out);
+    }
+
+    {
+        // and what its restore() does
+        LV2StateStore store (urids.map, urids.unmap, dir);
+        MemoryInputStream in (saved, false);
+        BOOST_REQUIRE (store.read (in));
+        BOOST_REQUIRE_EQUAL (store.size(), 3);
+
+        const auto* features = store.getFeatures();
+        const auto* mapPath = findFeature<LV2_State_Map_Path> (features, LV2_STATE__mapPath);
+        const auto* freePath = findFeature<LV2_State_Free_Path> (features, LV2_STATE__freePath);
+
+        size_t size = 0;
+        uint32_t type = 0, flags = 0;
+        auto* handle = store.getHandle();
+        const auto* value = LV2StateStore::retrieve (handle, urids ("urn:test:sample"), &size, &type, &flags);
+        BOOST_REQUIRE (value != nullptr);
+        BOOST_REQUIRE_EQUAL (type, pathType);
+        BOOST_REQUIRE_EQUAL (takePath (freePath, mapPath->absolute_path (mapPath->handle, (const char*) value)), madePath);
+
+        value = LV2StateStore::retrieve (handle, urids ("urn:test:other"), &size, &type, &flags);
+        BOOST_REQUIRE (value != nullptr);
+        BOOST_REQUIRE_EQUAL (takePath (freePath, mapPath->absolute_path (mapPath->handle, (const char*) value)), outside);
+
+        value = LV2StateStore::retrieve (handle, urids ("urn:test:blob"), &size, &type, &flags);
+        BOOST_REQUIRE (value != nullptr);
+        BOOST_REQUIRE_EQUAL (type, stringType);
+        BOOST_REQUIRE_EQUAL (flags, (uint32_t) 0);
+        BOOST_REQUIRE_EQUAL (String::fromUTF8 ((const char*) value), String ("blob"));
+
+        BOOST_REQUIRE (LV2StateStore::retrieve (handle, urids ("urn:test:missing"), &size, &type, &flags) == nullptr);
+    }
+
+    dir.deleteRecursively();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
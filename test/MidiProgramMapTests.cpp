@@ -100,4 +100,42 @@ BOOST_AUTO_TEST_CASE (Basics)
     graph.clear();
 }
 
+BOOST_AUTO_TEST_CASE (ChannelsAndSends)
+{
+    MidiProgramMapNode node;
+    node.addProgramEntry ("All", 1, 2);
+    node.addProgramEntry ("Channel 3", 1, 9, 3);
+    BOOST_REQUIRE_EQUAL (node.getNumProgramEntries(), 2);
+
+    OwnedArray<MidiBuffer> buffers;
+    Array<int> channels;
+    buffers.add (new MidiBuffer());
+    channels.add (0);
+    MidiPipe pipe (buffers, channels);
+    AudioSampleBuffer audio (1, 256), cv;
+
+    auto* midi = pipe.getWriteBuffer (0);
+    midi->addEvent (MidiMessage::programChange (1, 1), 10);
+    midi->addEvent (MidiMessage::programChange (3, 1), 20);
+    midi->addEvent (MidiMessage::noteOn (3, 60, 1.f), 30);
+    node.sendProgramChange (1, 5);
+    node.render (audio, pipe, cv);
+
+    Array<int> programs;
+    for (const auto m : *midi)
+    {
+        const auto msg = m.getMessage();
+        if (msg.isProgramChange())
+            programs.add (msg.getProgramChangeNumber());
+    }
+
+    // the queued send comes first at offset 0
+    BOOST_REQUIRE_EQUAL (programs.size(), 3);
+    BOOST_REQUIRE_EQUAL (programs[0], 2);
+    BOOST_REQUIRE_EQUAL (programs[1], 2);
+    BOOST_REQUIRE_EQUAL (programs[2], 9);
+    BOOST_REQUIRE_EQUAL (midi->getNumEvents(), 4);
+    BOOST_REQUIRE_EQUAL (node.getLastProgram(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+#include <boost/test/unit_test.hpp>
+
+#include <element/processor.hpp>
+#include <element/midipipe.hpp>
+
+#include "engine/midieventbuffer.hpp"
+#include "nodes/midirouter.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+struct RouterFixture
+{
+    RouterFixture()
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            buffers.add (new MidiBuffer());
+            channels.add (i);
+        }
+        audio.setSize (1, 512, false, true, false);
+    }
+
+    void render (MidiRouterNode& router)
+    {
+        MidiPipe pipe (buffers, channels);
+        router.render (audio, pipe, cv);
+    }
+
+    int count (int buffer) const { return buffers[buffer]->getNumEvents(); }
+
+    OwnedArray<MidiBuffer> buffers;
+    Array<int> channels;
+    AudioSampleBuffer audio, cv;
+};
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (MidiRouterTests)
+
+BOOST_AUTO_TEST_CASE (Routes)
+{
+    MidiRouterNode router (4, 4);
+    RouterFixture fix;
+
+    MatrixState matrix (4, 4);
+    matrix.set (0, 1, true);
+    matrix.set (0, 2, true);
+    matrix.set (3, 2, true);
+    router.setMatrixState (matrix);
+
+    fix.buffers[0]->addEvent (MidiMessage::noteOn (1, 60, 1.f), 10);
+    fix.buffers[3]->addEvent (MidiMessage::noteOn (1, 61, 1.f), 5);
+    fix.buffers[1]->addEvent (MidiMessage::noteOn (1, 62, 1.f), 0);
+    fix.render (router);
+
+    BOOST_REQUIRE_EQUAL (fix.count (0), 0);
+    BOOST_REQUIRE_EQUAL (fix.count (1), 1);
+    BOOST_REQUIRE_EQUAL (fix.count (2), 2);
+    BOOST_REQUIRE_EQUAL (fix.count (3), 0);
+
+    // merged in time order
+    auto iter = fix.buffers[2]->begin();
+    BOOST_REQUIRE_EQUAL ((*iter).samplePosition, 5);
+    BOOST_REQUIRE_EQUAL ((*iter).getMessage().getNoteNumber(), 61);
+}
+
+BOOST_AUTO_TEST_CASE (Filters)
+{
+    MidiRouterNode router (4, 4);
+    RouterFixture fix;
+
+    MatrixState matrix (4, 4);
+    matrix.set (0, 0, true);
+    matrix.set (0, 1, true);
+    router.setMatrixState (matrix);
+
+    MidiRouterNode::RouteFilter filter;
+    filter.channels = 1 << 1; // channel 2
+    filter.lowNote = 48;
+    filter.highNote = 59;
+    filter.types = MidiRouterNode::RouteFilter::noteMessages;
+    router.setRouteFilter (0, 1, filter);
+    BOOST_REQUIRE (router.getRouteFilter (0, 1) == filter);
+    BOOST_REQUIRE (router.getRouteFilter (0, 0).passesAll());
+
+    auto& in = *fix.buffers[0];
+    in.addEvent (MidiMessage::noteOn (2, 50, 1.f), 0);         // passes
+    in.addEvent (MidiMessage::noteOn (2, 70, 1.f), 1);         // out of range
+    in.addEvent (MidiMessage::noteOn (1, 50, 1.f), 2);         // wrong channel
+    in.addEvent (MidiMessage::controllerEvent (2, 1, 64), 3);  // wrong type
+    in.addEvent (MidiMessage::noteOff (2, 50), 4);             // passes
+    fix.render (router);
+
+    BOOST_REQUIRE_EQUAL (fix.count (0), 5);
+    BOOST_REQUIRE_EQUAL (fix.count (1), 2);
+
+    // filters are saved with the state
+    MemoryBlock block;
+    router.getState (block);
+    MidiRouterNode restored (4, 4);
+    restored.setState (block.getData(), (int) block.getSize());
+    BOOST_REQUIRE (restored.getRouteFilter (0, 1) == filter);
+    BOOST_REQUIRE (restored.getMatrixState() == matrix);
+}
+
+BOOST_AUTO_TEST_CASE (KeepsEventsPastCapacity)
+{
+    MidiRouterNode router (4, 4);
+    RouterFixture fix;
+
+    MatrixState matrix (4, 4);
+    matrix.set (0, 0, true);
+    matrix.set (1, 0, true);
+    router.setMatrixState (matrix);
+
+    const int numEvents = MidiEventBuffer::defaultMaxEvents;
+    for (int i = 0; i < numEvents; ++i)
+    {
+        fix.buffers[0]->addEvent (MidiMessage::noteOn (1, 60, 1.f), i % 512);
+        fix.buffers[1]->addEvent (MidiMessage::noteOff (1, 60), i % 512);
+    }
+
+    HeapBlock<uint8> sysex ((size_t) MidiEventBuffer::defaultMaxBytes * 2, true);
+    fix.buffers[1]->addEvent (MidiMessage::createSysExMessage (sysex.get(), MidiEventBuffer::defaultMaxBytes * 2), 511);
+    fix.render (router);
+
+    BOOST_REQUIRE_EQUAL (fix.count (0), numEvents * 2 + 1);
+    BOOST_REQUIRE_EQUAL (fix.count (1), 0);
+
+    int last = 0;
+    for (const auto m : *fix.buffers[0])
+    {
+        BOOST_REQUIRE (m.samplePosition >= last);
+        last = m.samplePosition;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
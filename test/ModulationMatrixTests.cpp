@@ -0,0 +1,149 @@
+#include <boost/test/unit_test.hpp>
+
+#include <element/processor.hpp>
+#include <element/midipipe.hpp>
+
+#include "nodes/modulationmatrix.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+struct MatrixFixture
+{
+    MatrixFixture()
+    {
+        node->refreshPorts();
+        node->prepareToRender (44100.0, 441);
+        audio.setSize (2, 441, false, true, false);
+    }
+
+    void set (int channel, float value)
+    {
+        auto param = node->getParameter (channel, true);
+        dynamic_cast<RangedParameter*> (param.get())->set (value);
+    }
+
+    float lane (int index) const
+    {
+        return node->getParameter (index, false)->getValue();
+    }
+
+    void render (int numBlocks = 1)
+    {
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            MidiBuffer* buffers[] = { &midi };
+            MidiPipe pipe (buffers, 1);
+            node->render (audio, pipe, cv);
+            midi.clear();
+        }
+    }
+
+    ProcessorPtr node { new ModulationMatrixNode() };
+    AudioSampleBuffer audio, cv;
+    MidiBuffer midi;
+};
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (ModulationMatrixTests)
+
+BOOST_AUTO_TEST_CASE (Ports)
+{
+    MatrixFixture fix;
+    BOOST_REQUIRE_EQUAL ((int) fix.node->getNumPorts (PortType::Audio, true), 2);
+    BOOST_REQUIRE_EQUAL ((int) fix.node->getNumPorts (PortType::Midi, true), 1);
+    BOOST_REQUIRE_EQUAL ((int) fix.node->getNumPorts (PortType::Control, false), (int) ModulationMatrixNode::numLanes);
+    BOOST_REQUIRE_EQUAL (fix.node->getParameters().size(),
+                         ModulationMatrixNode::laneOffsetChannel (ModulationMatrixNode::numLanes - 1) + 1);
+
+    auto source = fix.node->getParameter (ModulationMatrixNode::laneSourceChannel (0), true);
+    BOOST_REQUIRE_EQUAL (source->getText (source->getValue(), 32), String ("LFO 1"));
+    BOOST_REQUIRE_EQUAL (source->getNumSteps(), (int) ModulationMatrixNode::numSources);
+}
+
+BOOST_AUTO_TEST_CASE (MidiSources)
+{
+    MatrixFixture fix;
+    fix.set (ModulationMatrixNode::laneSourceChannel (0), (float) ModulationMatrixNode::modWheel);
+    fix.set (ModulationMatrixNode::laneDepthChannel (0), 0.5f);
+    fix.set (ModulationMatrixNode::laneOffsetChannel (0), 0.25f);
+    fix.set (ModulationMatrixNode::laneSourceChannel (1), (float) ModulationMatrixNode::pitchBend);
+    fix.set (ModulationMatrixNode::laneDepthChannel (1), -1.f);
+    fix.set (ModulationMatrixNode::laneOffsetChannel (1), 1.f);
+
+    fix.render();
+    BOOST_REQUIRE_CLOSE (fix.lane (0), 0.25f, 0.001f);
+    BOOST_REQUIRE_CLOSE (fix.lane (1), 0.5f, 0.01f);
+
+    fix.midi.addEvent (MidiMessage::controllerEvent (1, 1, 127), 10);
+    fix.midi.addEvent (MidiMessage::pitchWheel (1, 16383), 20);
+    fix.render();
+    BOOST_REQUIRE_CLOSE (fix.lane (0), 0.75f, 0.001f);
+    BOOST_REQUIRE_EQUAL (fix.lane (1), 0.f);
+}
+
+BOOST_AUTO_TEST_CASE (Envelope)
+{
+    MatrixFixture fix;
+    fix.set (ModulationMatrixNode::laneSourceChannel (0), (float) ModulationMatrixNode::envelope);
+
+    fix.render();
+    BOOST_REQUIRE_EQUAL (fix.lane (0), 0.f);
+
+    // 100 ms of full scale against a 10 ms attack
+    for (int ch = 0; ch < 2; ++ch)
+        FloatVectorOperations::fill (fix.audio.getWritePointer (ch), 1.f, fix.audio.getNumSamples());
+    fix.render (10);
+    BOOST_REQUIRE_GT (fix.lane (0), 0.99f);
+
+    fix.audio.clear();
+    fix.render();
+    const auto released = fix.lane (0);
+    BOOST_REQUIRE_LT (released, 0.99f);
+    BOOST_REQUIRE_GT (released, 0.5f);
+}
+
+BOOST_AUTO_TEST_CASE (Lfo)
+{
+    MatrixFixture fix;
+    fix.set (ModulationMatrixNode::lfoShapeChannel (0), (float) ModulationMatrixNode::saw);
+    fix.set (ModulationMatrixNode::lfoRateChannel (0), 1.f);
+
+    // half a second at 1 Hz
+    fix.render (50);
+    BOOST_REQUIRE_CLOSE (fix.lane (0), 0.5f, 0.1f);
+}
+
+BOOST_AUTO_TEST_CASE (LfoRateFollowsBlockRate)
+{
+    MatrixFixture fix;
+    fix.set (ModulationMatrixNode::lfoShapeChannel (0), (float) ModulationMatrixNode::saw);
+    fix.set (ModulationMatrixNode::lfoRateChannel (0), 20.f);
+
+    // 10 blocks a second allow 2.5 Hz, a quarter cycle per block
+    fix.audio.setSize (2, 4410, false, true, false);
+    fix.render();
+    BOOST_REQUIRE_CLOSE (fix.lane (0), 0.25f, 0.1f);
+    fix.render();
+    BOOST_REQUIRE_CLOSE (fix.lane (0), 0.5f, 0.1f);
+}
+
+BOOST_AUTO_TEST_CASE (State)
+{
+    MatrixFixture fix;
+    fix.set (ModulationMatrixNode::laneSourceChannel (3), (float) ModulationMatrixNode::velocity);
+    fix.set (ModulationMatrixNode::lfoRateChannel (1), 4.f);
+
+    MemoryBlock block;
+    fix.node->getState (block);
+
+    MatrixFixture restored;
+    restored.node->setState (block.getData(), (int) block.getSize());
+    auto source = restored.node->getParameter (ModulationMatrixNode::laneSourceChannel (3), true);
+    auto rate = restored.node->getParameter (ModulationMatrixNode::lfoRateChannel (1), true);
+    BOOST_REQUIRE_CLOSE (dynamic_cast<RangedParameter*> (source.get())->get(), (float) ModulationMatrixNode::velocity, 0.001f);
+    BOOST_REQUIRE_CLOSE (dynamic_cast<RangedParameter*> (rate.get())->get(), 4.f, 0.001f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -17,6 +17,7 @@ BOOST_AUTO_TEST_CASE (Internals)
         EL_NODE_ID_MIDI_MONITOR,
         EL_NODE_ID_MIDI_PROGRAM_MAP,
         EL_NODE_ID_MIDI_ROUTER,
+        EL_NODE_ID_MODULATION_MATRIX,
         // EL_NODE_ID_MIDI_SEQUENCER,
         EL_NODE_ID_OSC_RECEIVER,
         EL_NODE_ID_OSC_SENDER,
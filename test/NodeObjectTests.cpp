@@ -46,6 +46,36 @@ BOOST_AUTO_TEST_CASE (Enablement)
     node = nullptr;
 }
 
+BOOST_AUTO_TEST_CASE (ScheduledBypassAndMute)
+{
+    PreparedGraph fix;
+    ProcessorPtr node = fix.graph.addNode (new TestNode());
+    int bypassChanges = 0, muteChanges = 0;
+    auto bypass = node->bypassChanged.connect ([&] (Processor*) { ++bypassChanges; });
+    auto mute = node->muteChanged.connect ([&] (Processor*) { ++muteChanges; });
+
+    // takes effect at once, listeners hear about it later
+    node->setSuspendedAt (true, 100);
+    node->setMutedAt (true, 200);
+    BOOST_REQUIRE (node->isSuspended());
+    BOOST_REQUIRE (node->isMuted());
+    BOOST_REQUIRE_EQUAL (bypassChanges + muteChanges, 0);
+
+    node->notifyScheduledChanges();
+    node->notifyScheduledChanges();
+    BOOST_REQUIRE_EQUAL (bypassChanges, 1);
+    BOOST_REQUIRE_EQUAL (muteChanges, 1);
+
+    // no change, nothing to tell
+    node->setSuspendedAt (true, 0);
+    node->notifyScheduledChanges();
+    BOOST_REQUIRE_EQUAL (bypassChanges, 1);
+
+    bypass.disconnect();
+    mute.disconnect();
+    node = nullptr;
+}
+
 BOOST_AUTO_TEST_CASE (PortChannelMapping)
 {
     PreparedGraph fix;
@@ -73,4 +73,25 @@ BOOST_AUTO_TEST_CASE (HiddenBlockPorts)
     BOOST_REQUIRE_MESSAGE (! port.isHiddenOnBlock(), "Modified should not be hidden on block");
 }
 
+BOOST_AUTO_TEST_CASE (StateDirectory)
+{
+    auto graph = Node::createDefaultGraph();
+    ValueTree session (types::Session);
+    session.appendChild (graph.data(), nullptr);
+
+    const auto dir = File::getSpecialLocation (File::tempDirectory).getChildFile ("session.state");
+    session.setProperty (tags::stateDirectory, dir.getFullPathName(), nullptr);
+
+    const auto first = graph.getNode (0).getStateDirectory();
+    const auto second = graph.getNode (1).getStateDirectory();
+    BOOST_REQUIRE (first != second);
+    BOOST_REQUIRE (first.isAChildOf (dir));
+    BOOST_REQUIRE (second.isAChildOf (dir));
+    BOOST_REQUIRE_EQUAL (first.getFileName().toStdString(), graph.getNode (0).getUuid().toString().toStdString());
+
+    // never written to the session file
+    Node::sanitizeProperties (session, true);
+    BOOST_REQUIRE (! session.hasProperty (tags::stateDirectory));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,672 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+/*  Headless MIDI latency and render benchmark.
+
+    Plays synthetic event streams in real time into a virtual MidiEngine
+    input, the way a device thread does, while a render thread takes them
+    through the input queues, the MappingEngine and a prepared graph of MIDI
+    nodes at the block rate.  Reports latency percentiles from arrival to
+    the end of the rendered block for MIDI and for mapped controller
+    changes, throughput, render cost per event and any heap allocation made
+    while rendering.  No audio or MIDI devices are opened.
+
+    usage: element-midi-bench [--blocks N] [--block-size N] [--rate HZ]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <element/controller.hpp>
+#include <element/juce.hpp>
+#include <element/midipipe.hpp>
+#include <element/node.hpp>
+
+#include "engine/graphnode.hpp"
+#include "engine/ionode.hpp"
+#include "engine/mappingengine.hpp"
+#include "engine/midiengine.hpp"
+#include "nodes/midichannelsplitter.hpp"
+#include "nodes/midiprogrammap.hpp"
+#include "nodes/midirouter.hpp"
+
+//==============================================================================
+// Allocation counting.  Only allocations made while a thread has counting
+// enabled are recorded, i.e. while the benchmark is rendering.
+namespace {
+thread_local bool countAllocations = false;
+std::atomic<juce::int64> numAllocations { 0 };
+std::atomic<juce::int64> numAllocatedBytes { 0 };
+
+void* allocate (std::size_t size)
+{
+    if (countAllocations)
+    {
+        numAllocations.fetch_add (1, std::memory_order_relaxed);
+        numAllocatedBytes.fetch_add ((juce::int64) size, std::memory_order_relaxed);
+    }
+
+    if (auto* ptr = std::malloc (size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* allocateAligned (std::size_t size, std::align_val_t alignment)
+{
+    if (countAllocations)
+    {
+        numAllocations.fetch_add (1, std::memory_order_relaxed);
+        numAllocatedBytes.fetch_add ((juce::int64) size, std::memory_order_relaxed);
+    }
+
+    const auto align = static_cast<std::size_t> (alignment);
+#if JUCE_WINDOWS
+    if (auto* ptr = _aligned_malloc (size == 0 ? 1 : size, align))
+        return ptr;
+#else
+    // aligned_alloc wants a multiple of the alignment
+    const auto rounded = ((size == 0 ? 1 : size) + align - 1) / align * align;
+    if (auto* ptr = std::aligned_alloc (align, rounded))
+        return ptr;
+#endif
+    throw std::bad_alloc();
+}
+
+void freeAligned (void* ptr) noexcept
+{
+#if JUCE_WINDOWS
+    _aligned_free (ptr);
+#else
+    std::free (ptr);
+#endif
+}
+} // namespace
+
+void* operator new (std::size_t size) { return allocate (size); }
+void* operator new[] (std::size_t size) { return allocate (size); }
+void operator delete (void* ptr) noexcept { std::free (ptr); }
+void operator delete[] (void* ptr) noexcept { std::free (ptr); }
+void operator delete (void* ptr, std::size_t) noexcept { std::free (ptr); }
+void operator delete[] (void* ptr, std::size_t) noexcept { std::free (ptr); }
+
+void* operator new (std::size_t size, std::align_val_t align) { return allocateAligned (size, align); }
+void* operator new[] (std::size_t size, std::align_val_t align) { return allocateAligned (size, align); }
+void operator delete (void* ptr, std::align_val_t) noexcept { freeAligned (ptr); }
+void operator delete[] (void* ptr, std::align_val_t) noexcept { freeAligned (ptr); }
+void operator delete (void* ptr, std::size_t, std::align_val_t) noexcept { freeAligned (ptr); }
+void operator delete[] (void* ptr, std::size_t, std::align_val_t) noexcept { freeAligned (ptr); }
+
+using namespace element;
+using namespace juce;
+
+namespace {
+
+//==============================================================================
+/** Fills one block of input. Called with the block index, block size and
+    sample rate.
+ */
+using StreamGenerator = std::function<void (MidiBuffer&, int64, int, double)>;
+
+struct Scenario
+{
+    String name;
+    StreamGenerator generate;
+};
+
+/** 16 channels of controller sweeps, one message every two samples. */
+void denseControllers (MidiBuffer& midi, int64 block, int numSamples, double sampleRate)
+{
+    ignoreUnused (sampleRate);
+    for (int frame = 0; frame < numSamples; frame += 2)
+    {
+        const int channel = 1 + (frame / 2) % 16;
+        const int value = (int) ((block + frame) % 128);
+        midi.addEvent (MidiMessage::controllerEvent (channel, 1 + (frame % 4), value), frame);
+    }
+}
+
+/** An MPE style flood: per note channels 2-16 with notes, pitch bend and
+    pressure, plus zone wide messages on channel 1.
+ */
+void mpeFlood (MidiBuffer& midi, int64 block, int numSamples, double sampleRate)
+{
+    ignoreUnused (sampleRate);
+    for (int channel = 2; channel <= 16; ++channel)
+    {
+        const int note = 36 + (int) ((block + channel * 5) % 60);
+        const int start = ((channel - 2) * 7) % jmax (1, numSamples / 4);
+
+        midi.addEvent (MidiMessage::noteOn (channel, note, (uint8) 100), start);
+        for (int frame = start + 8; frame < numSamples - 8; frame += 16)
+        {
+            midi.addEvent (MidiMessage::pitchWheel (channel, 8192 + ((frame * 37) % 2048) - 1024), frame);
+            midi.addEvent (MidiMessage::channelPressureChange (channel, (frame / 4) % 128), frame + 1);
+            midi.addEvent (MidiMessage::controllerEvent (channel, 74, (frame / 2) % 128), frame + 2);
+        }
+        midi.addEvent (MidiMessage::noteOff (channel, note), numSamples - 1);
+    }
+
+    midi.addEvent (MidiMessage::controllerEvent (1, 64, block % 2 == 0 ? 127 : 0), 0);
+}
+
+/** 24 ppq clock at 300 BPM with transport messages and program changes. */
+void clockStream (MidiBuffer& midi, int64 block, int numSamples, double sampleRate)
+{
+    // 120 clocks per second on the absolute sample timeline, so blocks
+    // hold a varying number of clocks like they would from a device
+    constexpr double clocksPerSecond = 24.0 * 300.0 / 60.0;
+    const double samplesPerClock = sampleRate / clocksPerSecond;
+    const auto blockStart = block * numSamples;
+    for (auto clock = (int64) std::ceil ((double) blockStart / samplesPerClock);; ++clock)
+    {
+        const auto frame = (int64) std::floor ((double) clock * samplesPerClock) - blockStart;
+        if (frame >= numSamples)
+            break;
+        midi.addEvent (MidiMessage::midiClock(), (int) jmax ((int64) 0, frame));
+    }
+
+    if (block % 64 == 0)
+        midi.addEvent (MidiMessage::midiStart(), 0);
+    if (block % 16 == 0)
+        midi.addEvent (MidiMessage::programChange (1 + (int) (block / 16) % 16, (int) (block / 16) % 128), 1);
+}
+
+/** Large sysex dumps with notes between them. */
+void largeSysex (MidiBuffer& midi, int64 block, int numSamples, double sampleRate)
+{
+    ignoreUnused (sampleRate);
+    static constexpr int dumpSize = 1024;
+    uint8 dump[dumpSize];
+    dump[0] = 0xf0;
+    for (int i = 1; i < dumpSize - 1; ++i)
+        dump[i] = (uint8) ((block + i) & 0x7f);
+    dump[dumpSize - 1] = 0xf7;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const int frame = (i * numSamples) / 4;
+        midi.addEvent (dump, dumpSize, frame);
+        midi.addEvent (MidiMessage::noteOn (1 + i, 60 + i, (uint8) 90), frame + 1);
+        midi.addEvent (MidiMessage::noteOff (1 + i, 60 + i), frame + 2);
+    }
+}
+
+//==============================================================================
+/** Seconds on the clock MIDI device timestamps use. */
+double now() noexcept { return Time::getMillisecondCounterHiRes() * 0.001; }
+
+/** Sleeps, then spins, until a time returned by now(). */
+void waitUntil (double seconds) noexcept
+{
+    for (;;)
+    {
+        const auto remaining = seconds - now();
+        if (remaining <= 0.0)
+            return;
+        if (remaining > 0.002)
+            Thread::sleep (jmax (1, (int) (remaining * 1000.0) - 1));
+        else
+            Thread::yield();
+    }
+}
+
+//==============================================================================
+/** A MIDI thru node with one control for the bench controller to map.
+    Counts the values the mapping engine sets.
+ */
+class MappedNode : public Processor
+{
+public:
+    MappedNode() : Processor (0) { MappedNode::refreshPorts(); }
+
+    /** Returns the number of values set on the control. Any thread. */
+    int64 getNumChanges() const noexcept
+    {
+        return counter != nullptr ? counter->numChanges.load (std::memory_order_acquire) : 0;
+    }
+
+    void prepareToRender (double sampleRate, int blockSize) override { setRenderDetails (sampleRate, blockSize); }
+    void releaseResources() override {}
+    bool wantsMidiPipe() const override { return true; }
+    void getState (MemoryBlock&) override {}
+    void setState (const void*, int) override {}
+
+    void refreshPorts() override
+    {
+        PortList newPorts;
+        newPorts.add (PortType::Midi, 0, 0, "midi_in", "MIDI In", true);
+        newPorts.add (PortType::Midi, 1, 0, "midi_out", "MIDI Out", false);
+        newPorts.addControl (2, 0, "value", "Value", 0.f, 1.f, 0.f, true);
+        setPorts (newPorts);
+    }
+
+protected:
+    ParameterPtr getParameter (const PortDescription& port) override
+    {
+        counter = new CountingParameter (port);
+        return counter;
+    }
+
+private:
+    struct CountingParameter : public RangedParameter
+    {
+        explicit CountingParameter (const PortDescription& port)
+            : RangedParameter (port) {}
+
+        void setValue (float newValue) override
+        {
+            RangedParameter::setValue (newValue);
+            numChanges.fetch_add (1, std::memory_order_release);
+        }
+
+        std::atomic<int64> numChanges { 0 };
+    };
+
+    // owned by the parameter list
+    CountingParameter* counter = nullptr;
+};
+
+//==============================================================================
+/** The graph under test.
+
+    midi in -> mapped node -> program map -> key range filter -> transpose filter -> splitter
+    splitter channels 1-4 -> router (4x4, fan out and filtered routes) -> midi out
+    splitter channels 5-16 -> midi out
+ */
+struct BenchGraph
+{
+    BenchGraph (double sampleRate, int blockSize)
+    {
+        graph.setRenderDetails (sampleRate, blockSize);
+        graph.prepareToRender (sampleRate, blockSize);
+
+        auto* midiIn = graph.addNode (new IONode (IONode::midiInputNode));
+        auto* midiOut = graph.addNode (new IONode (IONode::midiOutputNode));
+
+        mapped = new MappedNode();
+        graph.addNode (mapped);
+
+        auto* programs = new MidiProgramMapNode();
+        for (int i = 0; i < 16; ++i)
+            programs->addProgramEntry ("Program " + String (i + 1), i, 127 - i, i % 3 == 0 ? 0 : 1 + i);
+        graph.addNode (programs);
+
+        // plain MIDI filter chain using the per-node filters
+        auto* keyRange = graph.addNode (new MidiProgramMapNode());
+        keyRange->setKeyRange (24, 108);
+        auto* transpose = graph.addNode (new MidiProgramMapNode());
+        transpose->setTransposeOffset (12);
+        BigInteger channels;
+        channels.setRange (0, 16, true);
+        channels.setBit (7, false);
+        transpose->setMidiChannels (channels);
+
+        auto* splitter = graph.addNode (new MidiChannelSplitterNode());
+
+        auto* router = new MidiRouterNode (4, 4);
+        MatrixState matrix (4, 4);
+        for (int i = 0; i < 4; ++i)
+            matrix.set (i, i, true);
+        matrix.set (0, 3, true);
+        matrix.set (1, 2, true);
+        router->setMatrixState (matrix);
+        MidiRouterNode::RouteFilter notesOnly;
+        notesOnly.types = MidiRouterNode::RouteFilter::noteMessages;
+        router->setRouteFilter (0, 3, notesOnly);
+        graph.addNode (router);
+
+        connect (midiIn, 0, mapped, 0);
+        connect (mapped, 0, programs, 0);
+        connect (programs, 0, keyRange, 0);
+        connect (keyRange, 0, transpose, 0);
+        connect (transpose, 0, splitter, 0);
+        for (int ch = 0; ch < 4; ++ch)
+        {
+            connect (splitter, ch, router, ch);
+            connect (router, ch, midiOut, 0);
+        }
+        for (int ch = 4; ch < 16; ++ch)
+            connect (splitter, ch, midiOut, 0);
+
+        waitForRenderingSequence();
+    }
+
+    ~BenchGraph()
+    {
+        graph.releaseResources();
+        graph.clear();
+    }
+
+    void connect (Processor* src, int srcChannel, Processor* dst, int dstChannel)
+    {
+        const bool connected = graph.addConnection (src->nodeId,
+                                                    src->getPortForChannel (PortType::Midi, srcChannel, false),
+                                                    dst->nodeId,
+                                                    dst->getPortForChannel (PortType::Midi, dstChannel, true));
+        if (! connected)
+            std::fprintf (stderr, "warning: couldn't connect node %u to node %u\n", (unsigned) src->nodeId, (unsigned) dst->nodeId);
+    }
+
+    /** The rendering sequence is built asynchronously on the message thread.
+        Nothing was dispatched while building the graph, so the next sequence
+        built has every node and connection.
+     */
+    void waitForRenderingSequence()
+    {
+        bool built = false;
+        auto connection = graph.renderingSequenceChanged.connect ([&built]() { built = true; });
+        const auto timeout = Time::getMillisecondCounter() + 5000;
+        while (! built && Time::getMillisecondCounter() < timeout)
+            MessageManager::getInstance()->runDispatchLoopUntil (1);
+        connection.disconnect();
+
+        if (! built)
+            std::fprintf (stderr, "warning: the rendering sequence wasn't built\n");
+    }
+
+    GraphNode graph;
+    MappedNode* mapped = nullptr;
+};
+
+//==============================================================================
+/** The MIDI engine and controller mapping the stream is played through, as
+    in the audio engine.  Controller 1 on any channel is mapped to the
+    control of the mapped node.
+ */
+struct BenchInput
+{
+    static constexpr int mappedController = 1;
+
+    explicit BenchInput (Processor& node)
+        : model (types::Node),
+          controller ("Bench"),
+          control ("Controller 1")
+    {
+        callback = midi.addVirtualInput ("element.bench");
+
+        model.data().setProperty (tags::object, &node, nullptr);
+        control.setProperty ("eventType", "controller");
+        control.setProperty ("eventId", mappedController);
+        controller.setProperty (tags::inputDevice, "element.bench");
+        controller.data().appendChild (control.data(), nullptr);
+
+        mapping.capture (false);
+        mapping.addInput (controller, midi);
+        if (! mapping.addHandler (control, model, 0))
+            std::fprintf (stderr, "warning: couldn't map controller %d\n", mappedController);
+        mapping.startMapping();
+    }
+
+    ~BenchInput()
+    {
+        mapping.clear();
+    }
+
+    static bool isMapped (const MidiMessage& message) noexcept
+    {
+        return message.isController() && message.getControllerNumber() == mappedController;
+    }
+
+    MidiEngine midi;
+    MappingEngine mapping;
+    MidiInputCallback* callback = nullptr;
+    Node model;
+    Controller controller;
+    Control control;
+};
+
+/** Renders a scenario to messages timestamped in seconds from the start. */
+std::vector<MidiMessage> createStream (const Scenario& scenario, double sampleRate, int blockSize, int numBlocks)
+{
+    std::vector<MidiMessage> stream;
+    MidiBuffer block;
+    for (int64 i = 0; i < numBlocks; ++i)
+    {
+        block.clear();
+        scenario.generate (block, i, blockSize, sampleRate);
+        for (const auto m : block)
+        {
+            auto message = m.getMessage();
+            message.setTimeStamp ((double) (i * blockSize + m.samplePosition) / sampleRate);
+            stream.push_back (message);
+        }
+    }
+    return stream;
+}
+
+//==============================================================================
+struct Result
+{
+    int64 eventsIn = 0;
+    int64 eventsOut = 0;
+    int64 dropped = 0;
+    int64 blocks = 0;
+    double seconds = 0.0;
+    double worstBlockSeconds = 0.0;
+    int64 allocations = 0;
+    int64 allocatedBytes = 0;
+
+    // seconds from a message arriving to the end of the block it rendered
+    // in, for MIDI input and for mapped controller changes
+    std::vector<double> inputLatency, mappedLatency;
+};
+
+/** Plays a scenario in real time.  A device thread pushes every message at
+    its time into a virtual input, a render thread wakes at the end of every
+    block and renders the input queues, the mapped changes and the graph,
+    and the message thread dispatches until it finishes.
+ */
+Result run (const Scenario& scenario, double sampleRate, int blockSize, int numBlocks)
+{
+    // warm up so buffers reach their working size before measuring
+    const int warmupBlocks = jmax (8, numBlocks / 20);
+    const int totalBlocks = warmupBlocks + numBlocks;
+    const double blockSeconds = (double) blockSize / sampleRate;
+    auto stream = createStream (scenario, sampleRate, blockSize, totalBlocks);
+
+    BenchGraph bench (sampleRate, blockSize);
+    BenchInput input (*bench.mapped);
+    input.midi.prepareInputQueues (sampleRate, blockSize);
+    // start the mapping engine's clock, so changes made before the first
+    // block are queued for it instead of applied on the device thread
+    input.mapping.processEvents (input.midi);
+
+    // arrival times of the messages the input queue accepted, and of mapped
+    // controller messages, in the order the render thread sees them
+    std::vector<double> inputTimes (stream.size()), mappedTimes (stream.size());
+    Result result;
+    result.inputLatency.resize (stream.size());
+    result.mappedLatency.resize (stream.size());
+    size_t numInputLatencies = 0, numMappedLatencies = 0;
+
+    const auto start = now() + 0.1;
+    std::atomic<bool> finished { false };
+
+    std::thread device ([&]() {
+        size_t accepted = 0, mapped = 0;
+        for (auto& message : stream)
+        {
+            waitUntil (start + message.getTimeStamp());
+            const auto arrived = now();
+            const bool isMapped = BenchInput::isMapped (message);
+            inputTimes[accepted] = arrived;
+            if (isMapped)
+                mappedTimes[mapped++] = arrived;
+
+            message.setTimeStamp (arrived);
+            const auto overflows = input.midi.getNumInputOverflows();
+            input.callback->handleIncomingMidiMessage (nullptr, message);
+            if (input.midi.getNumInputOverflows() == overflows)
+                ++accepted;
+            else
+                ++result.dropped;
+        }
+    });
+
+    std::thread render ([&]() {
+        AudioSampleBuffer audio (2, blockSize), cv (1, blockSize);
+        MidiBuffer midi;
+        midi.ensureSize (256 * 1024);
+        MidiBuffer* buffers[1] = { &midi };
+        size_t inputRead = 0;
+        int64 mappedRead = 0;
+
+        for (int block = 0; block < totalBlocks; ++block)
+        {
+            // a device callback arrives once the block's time has passed
+            waitUntil (start + (double) (block + 1) * blockSeconds);
+
+            const bool measuring = block >= warmupBlocks;
+            const auto allocationsBefore = numAllocations.load();
+            const auto bytesBefore = numAllocatedBytes.load();
+
+            countAllocations = measuring;
+            const auto begin = Time::getHighResolutionTicks();
+            midi.clear();
+            input.midi.renderInputQueues (midi, blockSize);
+            const auto numEventsIn = midi.getNumEvents();
+            input.mapping.processEvents (input.midi);
+            const auto numChanges = bench.mapped->getNumChanges();
+            audio.clear();
+            MidiPipe pipe (buffers, 1);
+            bench.graph.render (audio, pipe, cv);
+            const auto end = Time::getHighResolutionTicks();
+            const auto done = now();
+            countAllocations = false;
+
+            const auto inputEnd = inputRead + (size_t) numEventsIn;
+            for (; inputRead < inputEnd; ++inputRead)
+                if (measuring)
+                    result.inputLatency[numInputLatencies++] = done - inputTimes[inputRead];
+            for (; mappedRead < numChanges; ++mappedRead)
+                if (measuring)
+                    result.mappedLatency[numMappedLatencies++] = done - mappedTimes[(size_t) mappedRead];
+
+            if (! measuring)
+                continue;
+
+            const auto elapsed = Time::highResolutionTicksToSeconds (end - begin);
+            result.seconds += elapsed;
+            result.worstBlockSeconds = jmax (result.worstBlockSeconds, elapsed);
+            result.eventsIn += numEventsIn;
+            result.eventsOut += midi.getNumEvents();
+            result.allocations += numAllocations.load() - allocationsBefore;
+            result.allocatedBytes += numAllocatedBytes.load() - bytesBefore;
+            ++result.blocks;
+        }
+
+        finished.store (true);
+    });
+
+    while (! finished.load())
+        MessageManager::getInstance()->runDispatchLoopUntil (10);
+
+    render.join();
+    device.join();
+
+    result.inputLatency.resize (numInputLatencies);
+    result.mappedLatency.resize (numMappedLatencies);
+    std::sort (result.inputLatency.begin(), result.inputLatency.end());
+    std::sort (result.mappedLatency.begin(), result.mappedLatency.end());
+    return result;
+}
+
+/** Returns a percentile of sorted values in milliseconds. */
+double percentileMs (const std::vector<double>& sorted, double percentile)
+{
+    if (sorted.empty())
+        return 0.0;
+    const auto index = (size_t) jlimit (0.0, (double) sorted.size() - 1.0, std::ceil (percentile * 0.01 * (double) sorted.size()) - 1.0);
+    return 1000.0 * sorted[index];
+}
+
+void report (const String& name, const Result& r, double sampleRate, int blockSize)
+{
+    const double eventsPerSecond = r.seconds > 0.0 ? (double) r.eventsIn / r.seconds : 0.0;
+    const double nsPerEvent = r.eventsIn > 0 ? r.seconds * 1.0e9 / (double) r.eventsIn : 0.0;
+    const double usPerBlock = r.blocks > 0 ? r.seconds * 1.0e6 / (double) r.blocks : 0.0;
+    const double budgetUs = 1.0e6 * (double) blockSize / sampleRate;
+
+    std::printf ("%-18s %10.0f ev/block %14.0f ev/s %10.1f ns/ev %9.2f us/block %9.2f us worst (%5.1f%% of budget) %8.0f out/block  allocs %lld (%lld bytes)\n",
+                 name.toRawUTF8(),
+                 r.blocks > 0 ? (double) r.eventsIn / (double) r.blocks : 0.0,
+                 eventsPerSecond,
+                 nsPerEvent,
+                 usPerBlock,
+                 r.worstBlockSeconds * 1.0e6,
+                 budgetUs > 0.0 ? 100.0 * usPerBlock / budgetUs : 0.0,
+                 r.blocks > 0 ? (double) r.eventsOut / (double) r.blocks : 0.0,
+                 (long long) r.allocations,
+                 (long long) r.allocatedBytes);
+
+    std::printf ("%-18s latency ms  midi p50 %6.2f p99 %6.2f max %6.2f (%lld)  mapped p50 %6.2f p99 %6.2f max %6.2f (%lld)  dropped %lld\n",
+                 "",
+                 percentileMs (r.inputLatency, 50.0),
+                 percentileMs (r.inputLatency, 99.0),
+                 percentileMs (r.inputLatency, 100.0),
+                 (long long) r.inputLatency.size(),
+                 percentileMs (r.mappedLatency, 50.0),
+                 percentileMs (r.mappedLatency, 99.0),
+                 percentileMs (r.mappedLatency, 100.0),
+                 (long long) r.mappedLatency.size(),
+                 (long long) r.dropped);
+}
+
+} // namespace
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    ScopedJuceInitialiser_GUI juce;
+
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    int numBlocks = 1000;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const String arg (argv[i]);
+        const String value (i + 1 < argc ? argv[i + 1] : "");
+
+        if (arg == "--blocks" && value.isNotEmpty())
+            numBlocks = jmax (1, value.getIntValue()), ++i;
+        else if (arg == "--block-size" && value.isNotEmpty())
+            blockSize = jlimit (16, 4096, value.getIntValue()), ++i;
+        else if (arg == "--rate" && value.isNotEmpty())
+            sampleRate = jlimit (8000.0, 384000.0, value.getDoubleValue()), ++i;
+        else
+        {
+            std::printf ("usage: %s [--blocks N] [--block-size N] [--rate HZ]\n", argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    const Scenario scenarios[] = {
+        { "dense-cc", denseControllers },
+        { "mpe-flood", mpeFlood },
+        { "clock", clockStream },
+        { "large-sysex", largeSysex }
+    };
+
+    std::printf ("MIDI latency and render benchmark: %d blocks of %d samples at %.0f Hz, in real time\n", numBlocks, blockSize, sampleRate);
+
+    int64 totalAllocations = 0;
+    for (const auto& scenario : scenarios)
+    {
+        const auto result = run (scenario, sampleRate, blockSize, numBlocks);
+        report (scenario.name, result, sampleRate, blockSize);
+        totalAllocations += result.allocations;
+    }
+
+    if (totalAllocations > 0)
+        std::printf ("warning: %lld allocations on the render thread\n", (long long) totalAllocations);
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <boost/test/unit_test.hpp>
+#include "engine/enginestats.hpp"
+
+using namespace element;
+using namespace juce;
+
+BOOST_AUTO_TEST_SUITE (EngineStatsTest)
+
+BOOST_AUTO_TEST_CASE (Basics)
+{
+    EngineStats stats;
+    BOOST_REQUIRE_EQUAL (stats.getNumCallbacks(), 0);
+    BOOST_REQUIRE_EQUAL (stats.getNumXruns(), 0);
+
+    // a large block easily fits its budget
+    stats.begin();
+    stats.end (48000, 48000.0);
+    BOOST_REQUIRE_EQUAL (stats.getNumCallbacks(), 1);
+    BOOST_REQUIRE_EQUAL (stats.getNumXruns(), 0);
+    BOOST_REQUIRE (stats.getLoad() < 1.f);
+    BOOST_REQUIRE_EQUAL (stats.getHistogramBin (0), (uint32) 1);
+}
+
+BOOST_AUTO_TEST_CASE (Xruns)
+{
+    EngineStats stats;
+    stats.begin();
+    Thread::sleep (5);
+    stats.end (32, 48000.0);
+    BOOST_REQUIRE_EQUAL (stats.getNumXruns(), 1);
+    BOOST_REQUIRE (stats.getPeakLoad() > 1.f);
+    BOOST_REQUIRE_EQUAL (stats.getHistogramBin (EngineStats::numHistogramBins - 1), (uint32) 1);
+    BOOST_REQUIRE_EQUAL (stats.getXrunTimes().size(), 1);
+
+    stats.reset();
+    BOOST_REQUIRE_EQUAL (stats.getNumXruns(), 0);
+    BOOST_REQUIRE_EQUAL (stats.getXrunTimes().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE (Gaps)
+{
+    EngineStats stats;
+    stats.begin();
+    stats.end (4800, 48000.0);
+    Thread::sleep (250);
+
+    // a late callback after a restart or without gap detection isn't an xrun
+    stats.begin();
+    stats.end (4800, 48000.0, false);
+    BOOST_REQUIRE_EQUAL (stats.getNumXruns(), 0);
+    stats.restartTiming();
+    stats.begin();
+    stats.end (4800, 48000.0);
+    Thread::sleep (250);
+    stats.begin();
+    stats.end (2400, 48000.0);
+    BOOST_REQUIRE_EQUAL (stats.getNumXruns(), 0);
+
+    Thread::sleep (250);
+    stats.begin();
+    stats.end (2400, 48000.0);
+    BOOST_REQUIRE_EQUAL (stats.getNumXruns(), 1);
+}
+
+BOOST_AUTO_TEST_CASE (PageFaults)
+{
+    EngineStats stats;
+    stats.updatePageFaults (-1);
+    BOOST_REQUIRE_EQUAL (stats.getNumPageFaults(), 0);
+    stats.updatePageFaults (100);
+    stats.updatePageFaults (103);
+    BOOST_REQUIRE_EQUAL (stats.getNumPageFaults(), 3);
+
+    // a new audio thread starts counting from its own total
+    stats.restartPageFaults();
+    stats.updatePageFaults (10);
+    stats.updatePageFaults (12);
+    BOOST_REQUIRE_EQUAL (stats.getNumPageFaults(), 5);
+
+    stats.reset();
+    BOOST_REQUIRE_EQUAL (stats.getNumPageFaults(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
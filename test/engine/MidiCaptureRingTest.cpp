@@ -0,0 +1,89 @@
+#include <boost/test/unit_test.hpp>
+#include "engine/midicapturering.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+void capture (MidiCaptureRing& ring, const MidiMessage& msg, double time = 0.0)
+{
+    ring.capture (time, msg.getRawData(), msg.getRawDataSize());
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (MidiCaptureRingTest)
+
+BOOST_AUTO_TEST_CASE (ReadInOrder)
+{
+    MidiCaptureRing ring (8);
+    BOOST_REQUIRE_EQUAL (ring.getCapacity(), 8);
+
+    uint64 position = ring.getWritePosition();
+    for (int i = 0; i < 5; ++i)
+        capture (ring, MidiMessage::noteOn (1, 60 + i, 1.f), (double) i);
+
+    Array<int> notes;
+    const auto missed = ring.read (position, [&notes] (const MidiCaptureRing::Message& m) {
+        notes.add ((int) m.data[1]);
+    });
+
+    BOOST_REQUIRE_EQUAL (missed, (uint64) 0);
+    BOOST_REQUIRE_EQUAL (notes.size(), 5);
+    BOOST_REQUIRE_EQUAL (notes.getFirst(), 60);
+    BOOST_REQUIRE_EQUAL (notes.getLast(), 64);
+    BOOST_REQUIRE_EQUAL (position, ring.getWritePosition());
+}
+
+BOOST_AUTO_TEST_CASE (OverwritesOldest)
+{
+    MidiCaptureRing ring (8);
+    uint64 position = 0;
+    for (int i = 0; i < 20; ++i)
+        capture (ring, MidiMessage::controllerEvent (1, 7, i));
+
+    Array<int> values;
+    const auto missed = ring.read (position, [&values] (const MidiCaptureRing::Message& m) {
+        values.add ((int) m.data[2]);
+    });
+
+    BOOST_REQUIRE_EQUAL (missed, (uint64) 12);
+    BOOST_REQUIRE_EQUAL (values.size(), 8);
+    BOOST_REQUIRE_EQUAL (values.getFirst(), 12);
+    BOOST_REQUIRE_EQUAL (values.getLast(), 19);
+}
+
+BOOST_AUTO_TEST_CASE (FiltersAndCounts)
+{
+    MidiCaptureRing ring (16);
+    uint64 position = 0;
+
+    // clock is counted but not captured by default
+    for (int i = 0; i < 10; ++i)
+        capture (ring, MidiMessage::midiClock());
+    capture (ring, MidiMessage::programChange (1, 3));
+
+    const uint8 sysex[40] = { 0xf0, 0x7e };
+    capture (ring, MidiMessage::createSysExMessage (sysex + 1, 38));
+
+    int numCaptured = 0, sysexSize = 0;
+    ring.read (position, [&] (const MidiCaptureRing::Message& m) {
+        ++numCaptured;
+        if (m.data[0] == 0xf0)
+            sysexSize = m.size;
+    });
+
+    BOOST_REQUIRE_EQUAL (numCaptured, 2);
+    BOOST_REQUIRE_EQUAL (sysexSize, 40);
+    BOOST_REQUIRE_EQUAL (ring.getCount (MidiCaptureRing::clockType), (uint64) 10);
+    BOOST_REQUIRE_EQUAL (ring.getCount (MidiCaptureRing::programType), (uint64) 1);
+    BOOST_REQUIRE_EQUAL (ring.getTotalCount(), (uint64) 12);
+
+    ring.setTypeMask (1u << MidiCaptureRing::noteType);
+    capture (ring, MidiMessage::programChange (1, 4));
+    capture (ring, MidiMessage::noteOff (1, 60));
+    numCaptured = 0;
+    ring.read (position, [&] (const MidiCaptureRing::Message&) { ++numCaptured; });
+    BOOST_REQUIRE_EQUAL (numCaptured, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
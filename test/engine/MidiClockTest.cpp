@@ -0,0 +1,126 @@
+#include <boost/test/unit_test.hpp>
+#include "engine/midiclock.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+struct ClockListener : MidiClock::Listener
+{
+    void midiClockSignalAcquired() override { ++acquired; }
+    void midiClockSignalDropped() override { ++dropped; }
+    void midiClockTempoChanged (const float bpm) override { tempo = bpm; }
+
+    int acquired = 0, dropped = 0;
+    float tempo = 0.f;
+};
+
+Array<int64> renderPulses (MidiClockMaster& master, int numBlocks, int blockSize, int64 offset = 0)
+{
+    Array<int64> positions;
+    MidiBuffer midi;
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        midi.clear();
+        master.render (midi, blockSize);
+        for (const auto m : midi)
+            positions.add (offset + m.samplePosition);
+        offset += blockSize;
+    }
+    return positions;
+}
+
+void feedTicks (MidiClock& clock, double& time, int numTicks, double tempo, double jitter = 0.0)
+{
+    Random random (1234);
+    const double period = 60.0 / (24.0 * tempo);
+    for (int i = 0; i < numTicks; ++i)
+    {
+        time += period;
+        const auto offset = jitter * (random.nextDouble() * 2.0 - 1.0);
+        clock.process (MidiMessage::midiClock().withTimeStamp (time + offset));
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (MidiClockTest)
+
+BOOST_AUTO_TEST_CASE (MasterSampleAccurate)
+{
+    // 918.75 samples per clock
+    MidiClockMaster master;
+    master.setSampleRate (44100.0);
+    master.setTempo (120.0);
+    BOOST_REQUIRE_EQUAL (master.getSamplesPerClock(), 918.75);
+
+    const auto pulses = renderPulses (master, 200, 512);
+    BOOST_REQUIRE (pulses.size() > 100);
+    for (int k = 0; k < pulses.size(); ++k)
+        BOOST_REQUIRE_EQUAL (pulses[k], (int64) std::ceil (k * 918.75));
+}
+
+BOOST_AUTO_TEST_CASE (MasterTempoChangeKeepsPhase)
+{
+    MidiClockMaster master;
+    master.setSampleRate (44100.0);
+    master.setTempo (120.0);
+
+    auto pulses = renderPulses (master, 1, 512);
+    BOOST_REQUIRE_EQUAL (pulses.size(), 1);
+    BOOST_REQUIRE_EQUAL (master.getSamplesUntilClock(), 406.75);
+
+    // half the tempo, the rest of the interval in progress takes twice as long
+    master.setTempo (60.0);
+    BOOST_REQUIRE_EQUAL (master.getSamplesUntilClock(), 813.5);
+    pulses = renderPulses (master, 1, 1024);
+    BOOST_REQUIRE_EQUAL (pulses.size(), 1);
+    BOOST_REQUIRE_EQUAL (pulses[0], (int64) 814);
+}
+
+BOOST_AUTO_TEST_CASE (SlaveLocks)
+{
+    MidiClock clock;
+    ClockListener listener;
+    clock.reset (44100.0, 512);
+    clock.addListener (&listener);
+
+    double time = 10.0;
+    feedTicks (clock, time, MidiClock::lockTicks, 128.0, 0.0005);
+    BOOST_REQUIRE (clock.isLocked());
+    BOOST_REQUIRE_EQUAL (listener.acquired, 1);
+    BOOST_REQUIRE_CLOSE (listener.tempo, 128.f, 1.0);
+
+    feedTicks (clock, time, MidiClock::lockTicks * 8, 128.0, 0.0005);
+    BOOST_REQUIRE_CLOSE (listener.tempo, 128.f, 0.2);
+
+    // clock stops
+    time += 1.0;
+    feedTicks (clock, time, 1, 128.0);
+    BOOST_REQUIRE (! clock.isLocked());
+    BOOST_REQUIRE_EQUAL (listener.dropped, 1);
+    clock.removeListener (&listener);
+}
+
+BOOST_AUTO_TEST_CASE (Measurement)
+{
+    MidiClock clock;
+    clock.reset (44100.0, 512);
+    clock.setMeasuring (true, 120.0);
+
+    // 100 ppm fast with +/- 1ms of jitter
+    double time = 0.0;
+    feedTicks (clock, time, 24 * 64, 120.0 * 1.0001, 0.001);
+
+    const auto m = clock.getMeasurement();
+    BOOST_REQUIRE (m.enabled);
+    BOOST_REQUIRE (m.numTicks > 24 * 60);
+    BOOST_REQUIRE_CLOSE (m.tempo, 120.012, 0.005);
+    BOOST_REQUIRE (m.driftPpm > 50.0 && m.driftPpm < 150.0);
+    BOOST_REQUIRE (m.jitterRms > 0.1 && m.jitterRms < 1.5);
+    BOOST_REQUIRE (m.jitterPeak >= m.jitterRms && m.jitterPeak < 3.0);
+
+    clock.setMeasuring (false);
+    BOOST_REQUIRE (! clock.getMeasurement().enabled);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
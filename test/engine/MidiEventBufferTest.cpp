@@ -0,0 +1,100 @@
+#include <boost/test/unit_test.hpp>
+#include "engine/midieventbuffer.hpp"
+
+using namespace element;
+using namespace juce;
+
+BOOST_AUTO_TEST_SUITE (MidiEventBufferTest)
+
+BOOST_AUTO_TEST_CASE (Ordering)
+{
+    MidiEventBuffer events (8, 64);
+    events.addEvent (MidiMessage::noteOn (1, 60, 1.f), 10);
+    events.addEvent (MidiMessage::noteOn (1, 61, 1.f), 2);
+    events.addEvent (MidiMessage::noteOn (1, 62, 1.f), 10);
+    events.addEvent (MidiMessage::noteOn (1, 63, 1.f), 0);
+
+    BOOST_REQUIRE_EQUAL (events.getNumEvents(), 4);
+    BOOST_REQUIRE_EQUAL (events.getSampleOffset (0), 0);
+    BOOST_REQUIRE_EQUAL (events.getSampleOffset (1), 2);
+    BOOST_REQUIRE_EQUAL (events.getSampleOffset (3), 10);
+    // equal offsets keep insertion order
+    BOOST_REQUIRE_EQUAL ((int) events.getData (2)[1], 60);
+    BOOST_REQUIRE_EQUAL ((int) events.getData (3)[1], 62);
+    BOOST_REQUIRE_EQUAL (events.getSize (0), 3);
+}
+
+BOOST_AUTO_TEST_CASE (Overflow)
+{
+    MidiEventBuffer events (2, 64);
+    BOOST_REQUIRE (events.addEvent (MidiMessage::noteOn (1, 60, 1.f), 0));
+    BOOST_REQUIRE (events.addEvent (MidiMessage::noteOn (1, 61, 1.f), 0));
+    BOOST_REQUIRE (! events.addEvent (MidiMessage::noteOn (1, 62, 1.f), 0));
+    BOOST_REQUIRE_EQUAL (events.getNumEvents(), 2);
+    BOOST_REQUIRE_EQUAL (events.getNumOverflows(), 1);
+    BOOST_REQUIRE_EQUAL (events.getNumEventsRequired(), 3);
+    BOOST_REQUIRE_EQUAL (events.getNumBytesRequired(), 9);
+
+    MidiEventBuffer small (16, 4);
+    BOOST_REQUIRE (small.addEvent (MidiMessage::noteOn (1, 60, 1.f), 0));
+    BOOST_REQUIRE (! small.addEvent (MidiMessage::noteOff (1, 60), 1));
+    BOOST_REQUIRE (small.hasOverflowed());
+
+    small.clear();
+    BOOST_REQUIRE (small.isEmpty());
+    BOOST_REQUIRE (! small.hasOverflowed());
+    BOOST_REQUIRE_EQUAL (small.getNumBytesRequired(), 0);
+}
+
+BOOST_AUTO_TEST_CASE (CopyToMidiBuffer)
+{
+    MidiBuffer source;
+    source.addEvent (MidiMessage::noteOn (1, 60, 1.f), 4);
+    source.addEvent (MidiMessage::controllerEvent (1, 7, 100), 8);
+    source.addEvent (MidiMessage::noteOff (1, 60), 12);
+
+    MidiEventBuffer events;
+    BOOST_REQUIRE (events.addEvents (source, 0, 10, 1));
+    BOOST_REQUIRE_EQUAL (events.getNumEvents(), 2);
+
+    MidiBuffer dest;
+    dest.ensureSize (MidiEventBuffer::getMidiBufferSize());
+    dest.addEvent (MidiMessage::noteOn (2, 1, 1.f), 0);
+    events.copyTo (dest);
+
+    BOOST_REQUIRE_EQUAL (dest.getNumEvents(), 2);
+    BOOST_REQUIRE_EQUAL (dest.getFirstEventTime(), 5);
+    BOOST_REQUIRE_EQUAL (dest.getLastEventTime(), 9);
+    for (const auto metadata : dest)
+    {
+        const auto msg = metadata.getMessage();
+        BOOST_REQUIRE_EQUAL (msg.getChannel(), 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (CopyToKeepsStorage)
+{
+    MidiEventBuffer large, small;
+    for (int i = 0; i < 512; ++i)
+        BOOST_REQUIRE (large.addEvent (MidiMessage::noteOn (1, i % 128, 1.f), i));
+    BOOST_REQUIRE (small.addEvent (MidiMessage::noteOff (1, 60), 0));
+
+    MidiBuffer dest;
+    dest.ensureSize (MidiEventBuffer::getMidiBufferSize());
+    const auto* storage = dest.data.getRawDataPointer();
+
+    large.copyTo (dest);
+    BOOST_REQUIRE_EQUAL (dest.getNumEvents(), 512);
+    BOOST_REQUIRE (dest.data.getRawDataPointer() == storage);
+
+    // shrinking must not give the allocation back
+    small.copyTo (dest);
+    BOOST_REQUIRE_EQUAL (dest.getNumEvents(), 1);
+    BOOST_REQUIRE (dest.data.getRawDataPointer() == storage);
+
+    large.copyTo (dest);
+    BOOST_REQUIRE_EQUAL (dest.getNumEvents(), 512);
+    BOOST_REQUIRE (dest.data.getRawDataPointer() == storage);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,50 @@
+#include <boost/test/unit_test.hpp>
+#include "engine/midiinputqueue.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+/** Feeds blocks with ideal timestamps, returns the start of the last one. */
+double runBlocks (MidiInputTimer& timer, double start, int numBlocks)
+{
+    double now = start;
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        const int numSamples = (i % 2) == 0 ? 256 : 768;
+        timer.beginBlock (now, numSamples);
+        now += numSamples / 48000.0;
+    }
+    return now;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (MidiInputTimerTest)
+
+BOOST_AUTO_TEST_CASE (VariableBlocks)
+{
+    MidiInputTimer timer;
+    timer.reset (48000.0, 512);
+    const auto next = runBlocks (timer, 100.0, 2000);
+    BOOST_REQUIRE_CLOSE (timer.getEstimatedSampleRate(), 48000.0, 0.1);
+
+    // the last block was 768 samples, events are placed one block late
+    const auto lastStart = next - 768 / 48000.0;
+    const auto previousStart = lastStart - 256 / 48000.0;
+    BOOST_REQUIRE_LE (std::abs (timer.getSampleOffset (previousStart + 100 / 48000.0) - 100), 2);
+}
+
+BOOST_AUTO_TEST_CASE (RestartsAfterGap)
+{
+    MidiInputTimer timer;
+    timer.reset (48000.0, 512);
+    auto next = runBlocks (timer, 100.0, 200);
+
+    // a stalled device, one second without callbacks
+    next = runBlocks (timer, next + 1.0, 2);
+    const auto lastStart = next - 768 / 48000.0;
+    const auto previousStart = lastStart - 256 / 48000.0;
+    BOOST_REQUIRE_LE (std::abs (timer.getSampleOffset (previousStart + 100 / 48000.0) - 100), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
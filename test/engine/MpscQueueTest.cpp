@@ -0,0 +1,65 @@
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include "engine/mpscqueue.hpp"
+
+using namespace element;
+
+BOOST_AUTO_TEST_SUITE (MpscQueueTest)
+
+BOOST_AUTO_TEST_CASE (Basics)
+{
+    MpscQueue<int> queue (3);
+    BOOST_REQUIRE_EQUAL (queue.getCapacity(), 4);
+
+    int value = 0;
+    BOOST_REQUIRE (! queue.pop (value));
+    for (int i = 0; i < 4; ++i)
+        BOOST_REQUIRE (queue.push (i));
+    BOOST_REQUIRE (! queue.push (4));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        BOOST_REQUIRE (queue.pop (value));
+        BOOST_REQUIRE_EQUAL (value, i);
+    }
+    BOOST_REQUIRE (! queue.pop (value));
+    BOOST_REQUIRE (queue.push (5));
+}
+
+BOOST_AUTO_TEST_CASE (ManyProducers)
+{
+    constexpr int numProducers = 4;
+    constexpr int numValues = 20000;
+    MpscQueue<int> queue (256);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back ([&queue] {
+            for (int i = 1; i <= numValues; ++i)
+                while (! queue.push (i))
+                    std::this_thread::yield();
+        });
+    }
+
+    juce::int64 sum = 0;
+    int count = 0, value = 0;
+    while (count < numProducers * numValues)
+    {
+        if (queue.pop (value))
+        {
+            sum += value;
+            ++count;
+        }
+    }
+
+    for (auto& t : producers)
+        t.join();
+
+    BOOST_REQUIRE (! queue.pop (value));
+    BOOST_REQUIRE_EQUAL (sum, (juce::int64) numProducers * numValues * (numValues + 1) / 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
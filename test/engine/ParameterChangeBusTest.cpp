@@ -0,0 +1,146 @@
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include "engine/parameterchangebus.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+ParameterPtr makeParameter (int index)
+{
+    PortDescription port (PortType::Control, index, index, "p" + String (index), "P", true);
+    port.minValue = 0.f;
+    port.maxValue = 1.f;
+    return new RangedParameter (port);
+}
+
+struct CountingListener : public Parameter::AsyncListener
+{
+    void parameterValueChanged (Parameter&, float value) override
+    {
+        ++calls;
+        lastValue = value;
+    }
+
+    int calls = 0;
+    float lastValue = -1.f;
+};
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (ParameterChangeBusTest)
+
+BOOST_AUTO_TEST_CASE (Coalesces)
+{
+    ParameterChangeBus::Owner owner;
+    auto& bus = owner.getBus();
+    auto param = makeParameter (0);
+    auto* ranged = dynamic_cast<RangedParameter*> (param.get());
+    CountingListener listener;
+    param->addAsyncListener (&listener);
+
+    for (int i = 1; i <= 100; ++i)
+        ranged->set ((float) i / 100.f);
+
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 1);
+    BOOST_REQUIRE_EQUAL (listener.calls, 1);
+    BOOST_REQUIRE_EQUAL (listener.lastValue, 1.f);
+
+    ranged->set (0.5f);
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 1);
+    BOOST_REQUIRE_EQUAL (listener.calls, 2);
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 0);
+
+    param->removeAsyncListener (&listener);
+    ranged->set (0.25f);
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 0);
+    BOOST_REQUIRE_EQUAL (listener.calls, 2);
+}
+
+BOOST_AUTO_TEST_CASE (NoBus)
+{
+    auto param = makeParameter (0);
+    auto* ranged = dynamic_cast<RangedParameter*> (param.get());
+    CountingListener listener;
+    param->addAsyncListener (&listener);
+    ranged->set (0.5f);
+
+    // posted once a bus exists
+    ParameterChangeBus::Owner owner;
+    auto& bus = owner.getBus();
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 0);
+    ranged->set (0.25f);
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 1);
+    BOOST_REQUIRE_EQUAL (listener.calls, 1);
+
+    param->removeAsyncListener (&listener);
+}
+
+BOOST_AUTO_TEST_CASE (SharedByOwners)
+{
+    BOOST_REQUIRE (ParameterChangeBus::getCurrent() == nullptr);
+    {
+        ParameterChangeBus::Owner first;
+        {
+            ParameterChangeBus::Owner second;
+            BOOST_REQUIRE (&first.getBus() == &second.getBus());
+        }
+
+        // the last owner keeps it alive
+        BOOST_REQUIRE (ParameterChangeBus::getCurrent() == &first.getBus());
+    }
+    BOOST_REQUIRE (ParameterChangeBus::getCurrent() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE (ReleasesOnDelete)
+{
+    auto param = makeParameter (0);
+    const auto refs = param->getReferenceCount();
+    {
+        ParameterChangeBus bus;
+        BOOST_REQUIRE (bus.post (*param));
+        BOOST_REQUIRE_EQUAL (param->getReferenceCount(), refs + 1);
+    }
+    BOOST_REQUIRE_EQUAL (param->getReferenceCount(), refs);
+}
+
+BOOST_AUTO_TEST_CASE (FullQueue)
+{
+    ParameterChangeBus bus (4);
+    auto param = makeParameter (0);
+    const auto refs = param->getReferenceCount();
+
+    for (int i = 0; i < 4; ++i)
+        BOOST_REQUIRE (bus.post (*param));
+    BOOST_REQUIRE (! bus.post (*param));
+    BOOST_REQUIRE_EQUAL (param->getReferenceCount(), refs + 4);
+
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 4);
+    BOOST_REQUIRE_EQUAL (param->getReferenceCount(), refs);
+    BOOST_REQUIRE (bus.post (*param));
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 1);
+}
+
+BOOST_AUTO_TEST_CASE (ManyProducers)
+{
+    ParameterChangeBus bus (1024);
+    ParameterArray params;
+    for (int i = 0; i < 4 * 200; ++i)
+        params.add (makeParameter (i));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back ([&bus, &params, t]() {
+            for (int i = 0; i < 200; ++i)
+                bus.post (*params.getUnchecked (t * 200 + i));
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    BOOST_REQUIRE_EQUAL (bus.dispatch(), 800);
+    for (auto* param : params)
+        BOOST_REQUIRE_EQUAL (param->getReferenceCount(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
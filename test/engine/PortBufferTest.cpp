@@ -0,0 +1,47 @@
+#include <boost/test/unit_test.hpp>
+#include <lv2/atom/util.h>
+#include "engine/portbuffer.hpp"
+
+using namespace element;
+using namespace juce;
+
+BOOST_AUTO_TEST_SUITE (PortBufferTest)
+
+BOOST_AUTO_TEST_CASE (PrepareEvent)
+{
+    PortBuffer buffer (true, PortType::Atom, 100, 256);
+    const uint8 note[3] = { 0x90, 60, 100 };
+
+    for (int i = 0; i < 4; ++i)
+    {
+        auto* body = buffer.prepareEvent (i * 10, 3, 7);
+        BOOST_REQUIRE (body != nullptr);
+        BOOST_REQUIRE_EQUAL (body->size, (uint32) 3);
+        BOOST_REQUIRE_EQUAL (body->type, (uint32) 7);
+        memcpy (body + 1, note, 3);
+    }
+
+    int count = 0;
+    LV2_ATOM_SEQUENCE_FOREACH ((const LV2_Atom_Sequence*) buffer.getPortData(), ev)
+    {
+        BOOST_REQUIRE_EQUAL (ev->time.frames, (int64) count * 10);
+        BOOST_REQUIRE_EQUAL (memcmp (LV2_ATOM_BODY_CONST (&ev->body), note, 3), 0);
+        ++count;
+    }
+    BOOST_REQUIRE_EQUAL (count, 4);
+}
+
+BOOST_AUTO_TEST_CASE (FullSequence)
+{
+    // header (16) + 3 events of 24 bytes fit in 96 bytes, a fourth doesn't
+    PortBuffer buffer (true, PortType::Atom, 100, 96);
+    for (int i = 0; i < 3; ++i)
+        BOOST_REQUIRE (buffer.prepareEvent (0, 3, 7) != nullptr);
+    BOOST_REQUIRE (buffer.prepareEvent (0, 3, 7) == nullptr);
+    BOOST_REQUIRE (! buffer.addEvent (0, 1, 7, (const uint8*) "x"));
+
+    buffer.reset();
+    BOOST_REQUIRE (buffer.prepareEvent (0, 3, 7) != nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
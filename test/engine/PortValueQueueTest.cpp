@@ -0,0 +1,99 @@
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+#include "engine/portvaluequeue.hpp"
+
+using namespace element;
+using namespace juce;
+
+BOOST_AUTO_TEST_SUITE (PortValueQueueTest)
+
+BOOST_AUTO_TEST_CASE (Coalesces)
+{
+    PortValueQueue queue (8);
+    BOOST_REQUIRE (queue.isEmpty());
+
+    for (int i = 0; i < 100; ++i)
+        BOOST_REQUIRE (queue.push (3, (float) i));
+    BOOST_REQUIRE (queue.push (5, 0.5f));
+    BOOST_REQUIRE (! queue.push (8, 1.f));
+
+    Array<uint32_t> ports;
+    Array<float> values;
+    const auto count = queue.pop ([&] (uint32_t port, float value) {
+        ports.add (port);
+        values.add (value);
+    });
+
+    BOOST_REQUIRE_EQUAL (count, 2);
+    BOOST_REQUIRE_EQUAL (ports[0], (uint32_t) 3);
+    BOOST_REQUIRE_EQUAL (values[0], 99.f);
+    BOOST_REQUIRE_EQUAL (ports[1], (uint32_t) 5);
+    BOOST_REQUIRE_EQUAL (values[1], 0.5f);
+    BOOST_REQUIRE (queue.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE (EveryPortFits)
+{
+    PortValueQueue queue (16);
+    for (int round = 0; round < 3; ++round)
+    {
+        for (uint32_t port = 0; port < 16; ++port)
+        {
+            BOOST_REQUIRE (queue.push (port, (float) round));
+            BOOST_REQUIRE (queue.push (port, (float) round + 1.f));
+        }
+
+        int count = 0;
+        queue.pop ([&] (uint32_t port, float value) {
+            BOOST_REQUIRE_EQUAL (port, (uint32_t) count);
+            BOOST_REQUIRE_EQUAL (value, (float) round + 1.f);
+            ++count;
+        });
+        BOOST_REQUIRE_EQUAL (count, 16);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (TwoProducers)
+{
+    // e.g. the UI and the audio thread writing the same plugin's controls
+    constexpr int numWrites = 50000;
+    PortValueQueue queue (8);
+    float latest[8] = {};
+    auto popAll = [&] {
+        return queue.pop ([&] (uint32_t port, float value) {
+            BOOST_REQUIRE (port < 8);
+            latest[port] = value;
+        });
+    };
+
+    std::thread first ([&queue] {
+        for (int i = 1; i <= numWrites; ++i)
+            queue.push ((uint32_t) (i % 4), (float) i);
+    });
+    std::thread second ([&queue] {
+        for (int i = 1; i <= numWrites; ++i)
+            queue.push ((uint32_t) (4 + i % 4), (float) -i);
+    });
+
+    // pop while both are writing
+    for (int i = 0; i < 1000; ++i)
+    {
+        popAll();
+        std::this_thread::yield();
+    }
+
+    first.join();
+    second.join();
+    while (popAll() > 0)
+        continue;
+
+    BOOST_REQUIRE (queue.isEmpty());
+    for (int port = 0; port < 4; ++port)
+    {
+        BOOST_REQUIRE_EQUAL (latest[port], (float) (numWrites - (numWrites - port) % 4));
+        BOOST_REQUIRE_EQUAL (latest[port + 4], -(float) (numWrites - (numWrites - port) % 4));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,30 @@
+#include <boost/test/unit_test.hpp>
+#include "engine/threadscheduler.hpp"
+
+using namespace element;
+using namespace juce;
+
+BOOST_AUTO_TEST_SUITE (ThreadSchedulerTest)
+
+BOOST_AUTO_TEST_CASE (CpuLists)
+{
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::parseCpuList (""), (uint64) 0);
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::parseCpuList ("0"), (uint64) 1);
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::parseCpuList ("2,3"), (uint64) 0x0c);
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::parseCpuList ("0-1, 4"), (uint64) 0x13);
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::toCpuList (0x13), String ("0-1,4"));
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::toCpuList (0), String());
+}
+
+BOOST_AUTO_TEST_CASE (Policies)
+{
+    ThreadScheduler::Policy policy;
+    policy.affinity = 0x0c;
+    ThreadScheduler::setPolicy (ThreadScheduler::Disk, policy);
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::getPolicy (ThreadScheduler::Disk).affinity, (uint64) 0x0c);
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::getPolicy (ThreadScheduler::Disk).priority, 0);
+    ThreadScheduler::setPolicy (ThreadScheduler::Disk, {});
+    BOOST_REQUIRE_EQUAL (ThreadScheduler::getPolicy (ThreadScheduler::Disk).affinity, (uint64) 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()